@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <fstream>
+#include <iostream>
 #include <stdio.h>
 
 #include "device/device.h"
@@ -54,6 +56,7 @@ struct Options {
   bool quiet;
   bool show_help, interactive, pause;
   string output_path;
+  string batch_path;
 } options;
 
 static void session_print(const string &str)
@@ -178,6 +181,180 @@ static void session_exit()
   }
 }
 
+/* Batch Rendering
+ *
+ * Renders a queue of scenes with a single session, so the device and its kernels are only
+ * initialized once. The OSL shading system and its texture cache are kept alive as well, by
+ * creating the scene of the next job before freeing the previous one.
+ *
+ * Jobs are read one per line as "scene.xml [output image]" from a text file, or from stdin if
+ * the path is "-". Lines are rendered as they come in, so the process can be kept running on a
+ * render node and be fed jobs. If the path is a directory, all XML files in it are rendered. */
+
+struct BatchJob {
+  string filepath;
+  string output_path;
+};
+
+static string batch_output_path(const string &filepath, const string &output_dir)
+{
+  /* Default to a PNG image named after the scene. */
+  string filename = path_filename(filepath);
+  size_t extension = filename.rfind('.');
+  if (extension != string::npos) {
+    filename = filename.substr(0, extension);
+  }
+
+  string dir = (output_dir.empty()) ? path_dirname(filepath) : output_dir;
+  return path_join(dir, filename + ".png");
+}
+
+static bool batch_parse_job(const string &line, const string &output_dir, BatchJob &job)
+{
+  vector<string> tokens;
+  string_split(tokens, line);
+
+  /* Skip empty lines and comments. */
+  if (tokens.empty() || string_startswith(tokens[0], "#")) {
+    return false;
+  }
+
+  job.filepath = tokens[0];
+  job.output_path = (tokens.size() > 1) ? tokens[1] : batch_output_path(job.filepath, output_dir);
+  return true;
+}
+
+static bool batch_render_job(const BatchJob &job, int width, int height)
+{
+  Session *session = options.session;
+
+  if (!path_exists(job.filepath)) {
+    fprintf(stderr, "Scene file not found: %s\n", job.filepath.c_str());
+    return false;
+  }
+
+  double start_time = time_dt();
+  session->stats.mem_peak = session->stats.mem_used;
+
+  options.filepath = job.filepath;
+  options.output_path = job.output_path;
+  options.width = width;
+  options.height = height;
+
+  /* Create the new scene before freeing the previous one, so shared resources that are
+   * reference counted by scenes stay alive between jobs. */
+  Scene *previous_scene = session->scene;
+  scene_init();
+  session->scene = options.scene;
+  delete previous_scene;
+
+  double load_time = time_dt();
+
+  session->progress.reset();
+  session->reset(session_buffer_params(), options.session_params.samples);
+  session->start();
+  session->wait();
+
+  double render_time = time_dt();
+
+  if (session->progress.get_error()) {
+    fprintf(stderr,
+            "\nFailed to render %s: %s\n",
+            job.filepath.c_str(),
+            session->progress.get_error_message().c_str());
+    return false;
+  }
+
+  session->write_render();
+
+  if (!options.quiet) {
+    printf("\n");
+  }
+  printf("Rendered %s to %s: load %.2fs, render %.2fs, memory %s (peak %s)\n",
+         job.filepath.c_str(),
+         job.output_path.c_str(),
+         load_time - start_time,
+         render_time - load_time,
+         string_human_readable_size(session->stats.mem_used).c_str(),
+         string_human_readable_size(session->stats.mem_peak).c_str());
+  fflush(stdout);
+
+  return true;
+}
+
+static bool batch_run()
+{
+  /* Command line overrides, the options are modified for every job. */
+  const int width = options.width;
+  const int height = options.height;
+  const string output_dir = options.output_path;
+
+  options.session_params.write_render_cb = write_render;
+  options.session = new Session(options.session_params);
+
+  if (!options.quiet) {
+    options.session->progress.set_update_callback(function_bind(&session_print_status));
+  }
+
+  double start_time = time_dt();
+  int num_jobs = 0, num_failed = 0;
+
+  if (path_is_directory(options.batch_path)) {
+    foreach (const string &filepath, path_list_files(options.batch_path)) {
+      if (!string_endswith(filepath, ".xml")) {
+        continue;
+      }
+
+      BatchJob job;
+      job.filepath = filepath;
+      job.output_path = batch_output_path(filepath, output_dir);
+
+      num_jobs++;
+      if (!batch_render_job(job, width, height)) {
+        num_failed++;
+      }
+    }
+  }
+  else {
+    std::ifstream file;
+    std::istream *in = &std::cin;
+
+    if (options.batch_path != "-") {
+      file.open(options.batch_path.c_str());
+      if (!file.is_open()) {
+        fprintf(stderr, "Failed to open job list: %s\n", options.batch_path.c_str());
+        exit(EXIT_FAILURE);
+      }
+      in = &file;
+    }
+
+    string line;
+    while (std::getline(*in, line)) {
+      BatchJob job;
+      if (!batch_parse_job(line, output_dir, job)) {
+        continue;
+      }
+
+      num_jobs++;
+      if (!batch_render_job(job, width, height)) {
+        num_failed++;
+      }
+    }
+  }
+
+  /* Results were already written after every job. */
+  options.session->params.write_render_cb = NULL;
+  delete options.session;
+  options.session = NULL;
+
+  printf("Rendered %d of %d jobs in %.2fs\n",
+         num_jobs - num_failed,
+         num_jobs,
+         time_dt() - start_time);
+
+  return (num_failed == 0);
+}
+
 #ifdef WITH_CYCLES_STANDALONE_GUI
 static void display_info(Progress &progress)
 {
@@ -416,7 +593,11 @@ static void options_parse(int argc, const char **argv)
              "Number of samples to render",
              "--output %s",
              &options.output_path,
-             "File path to write output image",
+             "File path to write output image, or directory for batch rendering",
+             "--batch %s",
+             &options.batch_path,
+             "Render the scenes listed in a file, one \"scene.xml [output]\" per line, read "
+             "from stdin if \"-\", or all scenes in a directory, reusing the device",
              "--threads %d",
              &options.session_params.threads,
              "CPU Rendering Threads",
@@ -479,7 +660,7 @@ static void options_parse(int argc, const char **argv)
     printf("%s\n", CYCLES_VERSION_STRING);
     exit(EXIT_SUCCESS);
   }
-  else if (help || options.filepath == "") {
+  else if (help || (options.filepath == "" && options.batch_path == "")) {
     ap.usage();
     exit(EXIT_SUCCESS);
   }
@@ -493,6 +674,11 @@ static void options_parse(int argc, const char **argv)
   options.session_params.background = true;
 #endif
 
+  /* Batch rendering has no user interface. */
+  if (options.batch_path != "") {
+    options.session_params.background = true;
+  }
+
   /* Use progressive rendering */
   options.session_params.progressive = true;
 
@@ -526,7 +712,7 @@ static void options_parse(int argc, const char **argv)
     fprintf(stderr, "Invalid number of samples: %d\n", options.session_params.samples);
     exit(EXIT_FAILURE);
   }
-  else if (options.filepath == "") {
+  else if (options.filepath == "" && options.batch_path == "") {
     fprintf(stderr, "No file path specified\n");
     exit(EXIT_FAILURE);
   }
@@ -545,6 +731,10 @@ int main(int argc, const char **argv)
   path_init();
   options_parse(argc, argv);
 
+  if (options.batch_path != "") {
+    return (batch_run()) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
 #ifdef WITH_CYCLES_STANDALONE_GUI
   if (options.session_params.background) {
 #endif
@@ -349,6 +349,12 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         min=0.0, max=1.0,
         default=0.01,
     )
+    use_light_tree: BoolProperty(
+        name="Light Tree",
+        description="Sample lights using a spatial tree, picking lights by their estimated contribution "
+        "to the shading point (faster convergence in scenes with many lights)",
+        default=False,
+    )
 
     use_adaptive_sampling: BoolProperty(
         name="Use Adaptive Sampling",
@@ -644,6 +650,12 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         description="Use special type BVH optimized for hair (uses more ram but renders faster)",
         default=True,
     )
+    debug_use_compressed_bvh: BoolProperty(
+        name="Use Compressed BVH",
+        description="Store BVH node bounds with reduced precision, using less memory and "
+        "bandwidth at the cost of more intersection tests (CPU with AVX2 only)",
+        default=False,
+    )
     debug_bvh_time_steps: IntProperty(
         name="BVH Time Steps",
         description="Split BVH primitives by this number of time steps to speed up render time in cost of memory",
@@ -757,6 +769,29 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         items=enum_texture_limit
     )
 
+    use_texture_cache: BoolProperty(
+        name="Texture Cache",
+        description="Read image textures on demand in tiles, with mip levels chosen based on "
+        "distance, instead of fully loading them into memory (CPU only)",
+        default=False,
+    )
+
+    texture_cache_size: IntProperty(
+        name="Cache Size",
+        description="Maximum memory used by the texture cache, in megabytes",
+        default=4096,
+        min=64, soft_max=65536,
+        subtype='UNSIGNED',
+    )
+
+    use_profiling: BoolProperty(
+        name="Profiling",
+        description="Sample where render time is spent and store the kernel, shader and object "
+        "timings as JSON in the render result metadata, as cycles.<view layer>.profiling "
+        "(CPU background renders only)",
+        default=False,
+    )
+
     ao_bounces: IntProperty(
         name="AO Bounces",
         default=0,
@@ -76,6 +76,7 @@ Geometry *BlenderSync::sync_geometry(BL::Depsgraph &b_depsgraph,
   /* Test if we need to sync. */
   Geometry *geom = geometry_map.find(key);
   bool sync = true;
+  bool is_new = (geom == NULL);
   if (geom == NULL) {
     /* Add new geometry if it did not exist yet. */
     if (geom_type == Geometry::HAIR) {
@@ -91,6 +92,20 @@ Geometry *BlenderSync::sync_geometry(BL::Depsgraph &b_depsgraph,
     sync = geometry_map.update(geom, b_key_id);
   }
 
+  /* Even if not tagged for recalc, we may need to sync anyway
+   * because the shader needs different geometry attributes. */
+  bool attribute_recalc = false;
+
+  foreach (Shader *shader, geom->used_shaders) {
+    if (shader->need_update_geometry) {
+      attribute_recalc = true;
+    }
+  }
+
+  /* Geometry which was only tagged for recalc may evaluate to the same data as before, in
+   * that case the mesh export is skipped. */
+  bool check_data_hash = false;
+
   if (!sync) {
     /* If transform was applied to geometry, need full update. */
     if (object_updated && geom->transform_applied) {
@@ -101,22 +116,14 @@ Geometry *BlenderSync::sync_geometry(BL::Depsgraph &b_depsgraph,
     else if (geom->used_shaders != used_shaders) {
       ;
     }
-    else {
-      /* Even if not tagged for recalc, we may need to sync anyway
-       * because the shader needs different geometry attributes. */
-      bool attribute_recalc = false;
-
-      foreach (Shader *shader, geom->used_shaders) {
-        if (shader->need_update_geometry) {
-          attribute_recalc = true;
-        }
-      }
-
-      if (!attribute_recalc) {
-        return geom;
-      }
+    else if (!attribute_recalc) {
+      return geom;
     }
   }
+  else if (!is_new) {
+    check_data_hash = !geom->transform_applied && geom->used_shaders == used_shaders &&
+                      !attribute_recalc;
+  }
 
   /* Ensure we only sync instanced geometry once. */
   if (geometry_synced.find(geom) != geometry_synced.end()) {
@@ -142,7 +149,7 @@ Geometry *BlenderSync::sync_geometry(BL::Depsgraph &b_depsgraph,
   }
   else {
     Mesh *mesh = static_cast<Mesh *>(geom);
-    sync_mesh(b_depsgraph, b_ob, mesh, used_shaders);
+    sync_mesh(b_depsgraph, b_ob, mesh, used_shaders, check_data_hash);
   }
 
   return geom;
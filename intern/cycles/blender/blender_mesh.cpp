@@ -33,11 +33,42 @@
 #include "util/util_hash.h"
 #include "util/util_logging.h"
 #include "util/util_math.h"
+#include "util/util_murmurhash.h"
+#include "util/util_task.h"
 
 #include "mikktspace.h"
 
+#include "DNA_meshdata_types.h"
+
 CCL_NAMESPACE_BEGIN
 
+/* Evaluated Mesh Arrays
+ *
+ * Elements of the RNA collections point into the arrays of the evaluated mesh, which allows
+ * to read them directly instead of going through RNA for every element. This is also safe to
+ * do from multiple threads, as long as the mesh is not modified. */
+
+template<typename T, typename Collection> static const T *mesh_array(Collection &collection)
+{
+  return (collection.length() > 0) ? static_cast<const T *>(collection[0].ptr.data) : NULL;
+}
+
+static inline float3 mvert_co(const MVert &mvert)
+{
+  return make_float3(mvert.co[0], mvert.co[1], mvert.co[2]);
+}
+
+static inline float3 mvert_normal(const MVert &mvert)
+{
+  /* Same conversion as RNA. */
+  return make_float3(mvert.no[0], mvert.no[1], mvert.no[2]) * (1.0f / 32767.0f);
+}
+
+static inline float4 mloopcol_color(const MLoopCol &mloopcol)
+{
+  return make_float4(mloopcol.r, mloopcol.g, mloopcol.b, mloopcol.a) * (1.0f / 255.0f);
+}
+
 /* Tangent Space */
 
 struct MikkUserData {
@@ -304,13 +335,15 @@ static void attr_create_vertex_color(Scene *scene, Mesh *mesh, BL::Mesh &b_mesh,
         vcol_attr = mesh->subd_attributes.add(vcol_name, TypeRGBA, ATTR_ELEMENT_CORNER_BYTE);
       }
 
-      BL::Mesh::polygons_iterator p;
+      const MLoopCol *cols = mesh_array<MLoopCol>(l->data);
+      const MPoly *polys = mesh_array<MPoly>(b_mesh.polygons);
+      const int numpolys = b_mesh.polygons.length();
       uchar4 *cdata = vcol_attr->data_uchar4();
 
-      for (b_mesh.polygons.begin(p); p != b_mesh.polygons.end(); ++p) {
-        int n = p->loop_total();
-        for (int i = 0; i < n; i++) {
-          float4 color = get_float4(l->data[p->loop_start() + i].color());
+      for (int i = 0; i < numpolys; i++) {
+        const MPoly &p = polys[i];
+        for (int j = 0; j < p.totloop; j++) {
+          float4 color = mloopcol_color(cols[p.loopstart + j]);
           /* Compress/encode vertex color using the sRGB curve. */
           *(cdata++) = color_float4_to_uchar4(color_srgb_to_linear_v4(color));
         }
@@ -339,14 +372,16 @@ static void attr_create_vertex_color(Scene *scene, Mesh *mesh, BL::Mesh &b_mesh,
         vcol_attr = mesh->attributes.add(vcol_name, TypeRGBA, ATTR_ELEMENT_CORNER_BYTE);
       }
 
-      BL::Mesh::loop_triangles_iterator t;
+      const MLoopCol *cols = mesh_array<MLoopCol>(l->data);
+      const MLoopTri *looptris = mesh_array<MLoopTri>(b_mesh.loop_triangles);
+      const int numtris = b_mesh.loop_triangles.length();
       uchar4 *cdata = vcol_attr->data_uchar4();
 
-      for (b_mesh.loop_triangles.begin(t); t != b_mesh.loop_triangles.end(); ++t) {
-        int3 li = get_int3(t->loops());
-        float4 c1 = get_float4(l->data[li[0]].color());
-        float4 c2 = get_float4(l->data[li[1]].color());
-        float4 c3 = get_float4(l->data[li[2]].color());
+      for (int i = 0; i < numtris; i++) {
+        const MLoopTri &lt = looptris[i];
+        float4 c1 = mloopcol_color(cols[lt.tri[0]]);
+        float4 c2 = mloopcol_color(cols[lt.tri[1]]);
+        float4 c3 = mloopcol_color(cols[lt.tri[2]]);
 
         /* Compress/encode vertex color using the sRGB curve. */
         cdata[0] = color_float4_to_uchar4(color_srgb_to_linear_v4(c1));
@@ -391,14 +426,16 @@ static void attr_create_uv_map(Scene *scene, Mesh *mesh, BL::Mesh &b_mesh)
           uv_attr = mesh->attributes.add(uv_name, TypeFloat2, ATTR_ELEMENT_CORNER);
         }
 
-        BL::Mesh::loop_triangles_iterator t;
+        const MLoopUV *uvs = mesh_array<MLoopUV>(l->data);
+        const MLoopTri *looptris = mesh_array<MLoopTri>(b_mesh.loop_triangles);
+        const int numtris = b_mesh.loop_triangles.length();
         float2 *fdata = uv_attr->data_float2();
 
-        for (b_mesh.loop_triangles.begin(t); t != b_mesh.loop_triangles.end(); ++t) {
-          int3 li = get_int3(t->loops());
-          fdata[0] = get_float2(l->data[li[0]].uv());
-          fdata[1] = get_float2(l->data[li[1]].uv());
-          fdata[2] = get_float2(l->data[li[2]].uv());
+        for (int i = 0; i < numtris; i++) {
+          const MLoopTri &lt = looptris[i];
+          fdata[0] = make_float2(uvs[lt.tri[0]].uv[0], uvs[lt.tri[0]].uv[1]);
+          fdata[1] = make_float2(uvs[lt.tri[1]].uv[0], uvs[lt.tri[1]].uv[1]);
+          fdata[2] = make_float2(uvs[lt.tri[2]].uv[0], uvs[lt.tri[2]].uv[1]);
           fdata += 3;
         }
       }
@@ -459,13 +496,16 @@ static void attr_create_subd_uv_map(Scene *scene, Mesh *mesh, BL::Mesh &b_mesh,
           uv_attr->flags |= ATTR_SUBDIVIDED;
         }
 
-        BL::Mesh::polygons_iterator p;
+        const MLoopUV *uvs = mesh_array<MLoopUV>(l->data);
+        const MPoly *polys = mesh_array<MPoly>(b_mesh.polygons);
+        const int numpolys = b_mesh.polygons.length();
         float2 *fdata = uv_attr->data_float2();
 
-        for (b_mesh.polygons.begin(p); p != b_mesh.polygons.end(); ++p) {
-          int n = p->loop_total();
-          for (int j = 0; j < n; j++) {
-            *(fdata++) = get_float2(l->data[p->loop_start() + j].uv());
+        for (int i = 0; i < numpolys; i++) {
+          const MPoly &p = polys[i];
+          for (int j = 0; j < p.totloop; j++) {
+            const MLoopUV &uv = uvs[p.loopstart + j];
+            *(fdata++) = make_float2(uv.uv[0], uv.uv[1]);
           }
         }
       }
@@ -578,10 +618,11 @@ static void attr_create_pointiness(Scene *scene, Mesh *mesh, BL::Mesh &b_mesh, b
   /* STEP 2: Calculate vertex normals taking into account their possible
    *         duplicates which gets "welded" together.
    */
+  const MVert *verts = mesh_array<MVert>(b_mesh.vertices);
   vector<float3> vert_normal(num_verts, make_float3(0.0f, 0.0f, 0.0f));
   /* First we accumulate all vertex normals in the original index. */
   for (int vert_index = 0; vert_index < num_verts; ++vert_index) {
-    const float3 normal = get_float3(b_mesh.vertices[vert_index].normal());
+    const float3 normal = mvert_normal(verts[vert_index]);
     const int orig_index = vert_orig_index[vert_index];
     vert_normal[orig_index] += normal;
   }
@@ -596,18 +637,18 @@ static void attr_create_pointiness(Scene *scene, Mesh *mesh, BL::Mesh &b_mesh, b
   vector<int> counter(num_verts, 0);
   vector<float> raw_data(num_verts, 0.0f);
   vector<float3> edge_accum(num_verts, make_float3(0.0f, 0.0f, 0.0f));
-  BL::Mesh::edges_iterator e;
+  const MEdge *edges = mesh_array<MEdge>(b_mesh.edges);
+  const int num_edges = b_mesh.edges.length();
   EdgeMap visited_edges;
-  int edge_index = 0;
   memset(&counter[0], 0, sizeof(int) * counter.size());
-  for (b_mesh.edges.begin(e); e != b_mesh.edges.end(); ++e, ++edge_index) {
-    const int v0 = vert_orig_index[b_mesh.edges[edge_index].vertices()[0]],
-              v1 = vert_orig_index[b_mesh.edges[edge_index].vertices()[1]];
+  for (int edge_index = 0; edge_index < num_edges; ++edge_index) {
+    const int v0 = vert_orig_index[edges[edge_index].v1],
+              v1 = vert_orig_index[edges[edge_index].v2];
     if (visited_edges.exists(v0, v1)) {
       continue;
     }
     visited_edges.insert(v0, v1);
-    float3 co0 = get_float3(b_mesh.vertices[v0].co()), co1 = get_float3(b_mesh.vertices[v1].co());
+    float3 co0 = mvert_co(verts[v0]), co1 = mvert_co(verts[v1]);
     float3 edge = normalize(co1 - co0);
     edge_accum[v0] += edge;
     edge_accum[v1] += -edge;
@@ -635,11 +676,10 @@ static void attr_create_pointiness(Scene *scene, Mesh *mesh, BL::Mesh &b_mesh, b
   float *data = attr->data_float();
   memcpy(data, &raw_data[0], sizeof(float) * raw_data.size());
   memset(&counter[0], 0, sizeof(int) * counter.size());
-  edge_index = 0;
   visited_edges.clear();
-  for (b_mesh.edges.begin(e); e != b_mesh.edges.end(); ++e, ++edge_index) {
-    const int v0 = vert_orig_index[b_mesh.edges[edge_index].vertices()[0]],
-              v1 = vert_orig_index[b_mesh.edges[edge_index].vertices()[1]];
+  for (int edge_index = 0; edge_index < num_edges; ++edge_index) {
+    const int v0 = vert_orig_index[edges[edge_index].v1],
+              v1 = vert_orig_index[edges[edge_index].v2];
     if (visited_edges.exists(v0, v1)) {
       continue;
     }
@@ -685,25 +725,29 @@ static void attr_create_random_per_island(Scene *scene,
 
   DisjointSet vertices_sets(number_of_vertices);
 
-  BL::Mesh::edges_iterator e;
-  for (b_mesh.edges.begin(e); e != b_mesh.edges.end(); ++e) {
-    vertices_sets.join(e->vertices()[0], e->vertices()[1]);
+  const MEdge *edges = mesh_array<MEdge>(b_mesh.edges);
+  const int num_edges = b_mesh.edges.length();
+  for (int i = 0; i < num_edges; i++) {
+    vertices_sets.join(edges[i].v1, edges[i].v2);
   }
 
   AttributeSet &attributes = (subdivision) ? mesh->subd_attributes : mesh->attributes;
   Attribute *attribute = attributes.add(ATTR_STD_RANDOM_PER_ISLAND);
   float *data = attribute->data_float();
+  const MLoop *loops = mesh_array<MLoop>(b_mesh.loops);
 
   if (!subdivision) {
-    BL::Mesh::loop_triangles_iterator t;
-    for (b_mesh.loop_triangles.begin(t); t != b_mesh.loop_triangles.end(); ++t) {
-      data[t->index()] = hash_uint_to_float(vertices_sets.find(t->vertices()[0]));
+    const MLoopTri *looptris = mesh_array<MLoopTri>(b_mesh.loop_triangles);
+    const int num_tris = b_mesh.loop_triangles.length();
+    for (int i = 0; i < num_tris; i++) {
+      data[i] = hash_uint_to_float(vertices_sets.find(loops[looptris[i].tri[0]].v));
     }
   }
   else {
-    BL::Mesh::polygons_iterator p;
-    for (b_mesh.polygons.begin(p); p != b_mesh.polygons.end(); ++p) {
-      data[p->index()] = hash_uint_to_float(vertices_sets.find(p->vertices()[0]));
+    const MPoly *polys = mesh_array<MPoly>(b_mesh.polygons);
+    const int num_polys = b_mesh.polygons.length();
+    for (int i = 0; i < num_polys; i++) {
+      data[i] = hash_uint_to_float(vertices_sets.find(loops[polys[i].loopstart].v));
     }
   }
 }
@@ -731,14 +775,17 @@ static void create_mesh(Scene *scene,
     return;
   }
 
+  const MVert *verts = mesh_array<MVert>(b_mesh.vertices);
+  const MPoly *polys = mesh_array<MPoly>(b_mesh.polygons);
+  const MLoop *loops = mesh_array<MLoop>(b_mesh.loops);
+
   if (!subdivision) {
     numtris = numfaces;
   }
   else {
-    BL::Mesh::polygons_iterator p;
-    for (b_mesh.polygons.begin(p); p != b_mesh.polygons.end(); ++p) {
-      numngons += (p->loop_total() == 4) ? 0 : 1;
-      numcorners += p->loop_total();
+    for (int i = 0; i < numfaces; i++) {
+      numngons += (polys[i].totloop == 4) ? 0 : 1;
+      numcorners += polys[i].totloop;
     }
   }
 
@@ -747,17 +794,15 @@ static void create_mesh(Scene *scene,
   mesh->reserve_subd_faces(numfaces, numngons, numcorners);
 
   /* create vertex coordinates and normals */
-  BL::Mesh::vertices_iterator v;
-  for (b_mesh.vertices.begin(v); v != b_mesh.vertices.end(); ++v)
-    mesh->add_vertex(get_float3(v->co()));
+  for (int i = 0; i < numverts; i++)
+    mesh->add_vertex(mvert_co(verts[i]));
 
   AttributeSet &attributes = (subdivision) ? mesh->subd_attributes : mesh->attributes;
   Attribute *attr_N = attributes.add(ATTR_STD_VERTEX_NORMAL);
   float3 *N = attr_N->data_float3();
 
-  for (b_mesh.vertices.begin(v); v != b_mesh.vertices.end(); ++v, ++N)
-    *N = get_float3(v->normal());
-  N = attr_N->data_float3();
+  for (int i = 0; i < numverts; i++)
+    N[i] = mvert_normal(verts[i]);
 
   /* create generated coordinates from undeformed coordinates */
   const bool need_default_tangent = (subdivision == false) && (b_mesh.uv_layers.length() == 0) &&
@@ -772,6 +817,8 @@ static void create_mesh(Scene *scene,
     float3 *generated = attr->data_float3();
     size_t i = 0;
 
+    /* Undeformed coordinates are not stored in the vertex array. */
+    BL::Mesh::vertices_iterator v;
     for (b_mesh.vertices.begin(v); v != b_mesh.vertices.end(); ++v) {
       generated[i++] = get_float3(v->undeformed_co()) * size - loc;
     }
@@ -779,17 +826,19 @@ static void create_mesh(Scene *scene,
 
   /* create faces */
   if (!subdivision) {
-    BL::Mesh::loop_triangles_iterator t;
+    const MLoopTri *looptris = mesh_array<MLoopTri>(b_mesh.loop_triangles);
 
-    for (b_mesh.loop_triangles.begin(t); t != b_mesh.loop_triangles.end(); ++t) {
-      BL::MeshPolygon p = b_mesh.polygons[t->polygon_index()];
-      int3 vi = get_int3(t->vertices());
+    for (int t = 0; t < numtris; t++) {
+      const MLoopTri &lt = looptris[t];
+      const MPoly &p = polys[lt.poly];
+      int3 vi = make_int3(loops[lt.tri[0]].v, loops[lt.tri[1]].v, loops[lt.tri[2]].v);
 
-      int shader = clamp(p.material_index(), 0, used_shaders.size() - 1);
-      bool smooth = p.use_smooth() || use_loop_normals;
+      int shader = clamp(p.mat_nr, 0, used_shaders.size() - 1);
+      bool smooth = (p.flag & ME_SMOOTH) || use_loop_normals;
 
       if (use_loop_normals) {
-        BL::Array<float, 9> loop_normals = t->split_normals();
+        /* Split normals are only available through RNA. */
+        BL::Array<float, 9> loop_normals = b_mesh.loop_triangles[t].split_normals();
         for (int i = 0; i < 3; i++) {
           N[vi[i]] = make_float3(
               loop_normals[i * 3], loop_normals[i * 3 + 1], loop_normals[i * 3 + 2]);
@@ -804,18 +853,18 @@ static void create_mesh(Scene *scene,
     }
   }
   else {
-    BL::Mesh::polygons_iterator p;
     vector<int> vi;
 
-    for (b_mesh.polygons.begin(p); p != b_mesh.polygons.end(); ++p) {
-      int n = p->loop_total();
-      int shader = clamp(p->material_index(), 0, used_shaders.size() - 1);
-      bool smooth = p->use_smooth() || use_loop_normals;
+    for (int i = 0; i < numfaces; i++) {
+      const MPoly &p = polys[i];
+      int n = p.totloop;
+      int shader = clamp(p.mat_nr, 0, used_shaders.size() - 1);
+      bool smooth = (p.flag & ME_SMOOTH) || use_loop_normals;
 
       vi.resize(n);
-      for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) {
         /* NOTE: Autosmooth is already taken care about. */
-        vi[i] = b_mesh.loops[p->loop_start() + i].vertex_index();
+        vi[j] = loops[p.loopstart + j].v;
       }
 
       /* create subd faces */
@@ -865,11 +914,12 @@ static void create_subd_mesh(Scene *scene,
   create_mesh(scene, mesh, b_mesh, used_shaders, true, subdivide_uvs);
 
   /* export creases */
+  const MEdge *edges = mesh_array<MEdge>(b_mesh.edges);
+  const int num_edges = b_mesh.edges.length();
   size_t num_creases = 0;
-  BL::Mesh::edges_iterator e;
 
-  for (b_mesh.edges.begin(e); e != b_mesh.edges.end(); ++e) {
-    if (e->crease() != 0.0f) {
+  for (int i = 0; i < num_edges; i++) {
+    if (edges[i].crease != 0) {
       num_creases++;
     }
   }
@@ -877,11 +927,12 @@ static void create_subd_mesh(Scene *scene,
   mesh->subd_creases.resize(num_creases);
 
   Mesh::SubdEdgeCrease *crease = mesh->subd_creases.data();
-  for (b_mesh.edges.begin(e); e != b_mesh.edges.end(); ++e) {
-    if (e->crease() != 0.0f) {
-      crease->v[0] = e->vertices()[0];
-      crease->v[1] = e->vertices()[1];
-      crease->crease = e->crease();
+  for (int i = 0; i < num_edges; i++) {
+    if (edges[i].crease != 0) {
+      crease->v[0] = edges[i].v1;
+      crease->v[1] = edges[i].v2;
+      /* Same conversion as RNA. */
+      crease->crease = edges[i].crease / 255.0f;
 
       crease++;
     }
@@ -941,11 +992,146 @@ static void sync_mesh_fluid_motion(BL::Object &b_ob, Scene *scene, Mesh *mesh)
   }
 }
 
+/* Hash of the evaluated mesh data read by create_mesh(), used to skip the export of meshes
+ * which were tagged for update but evaluate to the same data as before. */
+static uint mesh_data_hash(Scene *scene, Mesh *mesh, BL::Mesh &b_mesh)
+{
+  const int sizes[6] = {b_mesh.vertices.length(),
+                        b_mesh.edges.length(),
+                        b_mesh.polygons.length(),
+                        b_mesh.loops.length(),
+                        b_mesh.loop_triangles.length(),
+                        b_mesh.use_auto_smooth()};
+  uint hash = util_murmur_hash3(sizes, sizeof(sizes), 0);
+
+  hash = util_murmur_hash3(mesh_array<MVert>(b_mesh.vertices), sizeof(MVert) * sizes[0], hash);
+  hash = util_murmur_hash3(mesh_array<MEdge>(b_mesh.edges), sizeof(MEdge) * sizes[1], hash);
+  hash = util_murmur_hash3(mesh_array<MPoly>(b_mesh.polygons), sizeof(MPoly) * sizes[2], hash);
+  hash = util_murmur_hash3(mesh_array<MLoop>(b_mesh.loops), sizeof(MLoop) * sizes[3], hash);
+  hash = util_murmur_hash3(
+      mesh_array<MLoopTri>(b_mesh.loop_triangles), sizeof(MLoopTri) * sizes[4], hash);
+
+  BL::Mesh::uv_layers_iterator uv_layer;
+  for (b_mesh.uv_layers.begin(uv_layer); uv_layer != b_mesh.uv_layers.end(); ++uv_layer) {
+    const string name = uv_layer->name() + (uv_layer->active_render() ? "+" : "-");
+    hash = util_murmur_hash3(name.c_str(), name.size(), hash);
+    hash = util_murmur_hash3(
+        mesh_array<MLoopUV>(uv_layer->data), sizeof(MLoopUV) * sizes[3], hash);
+  }
+
+  BL::Mesh::vertex_colors_iterator vcol_layer;
+  for (b_mesh.vertex_colors.begin(vcol_layer); vcol_layer != b_mesh.vertex_colors.end();
+       ++vcol_layer) {
+    const string name = vcol_layer->name() + (vcol_layer->active_render() ? "+" : "-");
+    hash = util_murmur_hash3(name.c_str(), name.size(), hash);
+    hash = util_murmur_hash3(
+        mesh_array<MLoopCol>(vcol_layer->data), sizeof(MLoopCol) * sizes[3], hash);
+  }
+
+  /* Data which is only available through RNA. */
+  if (b_mesh.use_auto_smooth()) {
+    BL::Mesh::loop_triangles_iterator t;
+    for (b_mesh.loop_triangles.begin(t); t != b_mesh.loop_triangles.end(); ++t) {
+      BL::Array<float, 9> loop_normals = t->split_normals();
+      hash = util_murmur_hash3(loop_normals.data, sizeof(loop_normals.data), hash);
+    }
+  }
+
+  if (mesh->need_attribute(scene, ATTR_STD_GENERATED) ||
+      mesh->need_attribute(scene, ATTR_STD_UV_TANGENT) ||
+      mesh->need_attribute(scene, ATTR_STD_GENERATED_TRANSFORM)) {
+    float3 loc, size;
+    mesh_texture_space(b_mesh, loc, size);
+    const float texspace[6] = {loc.x, loc.y, loc.z, size.x, size.y, size.z};
+    hash = util_murmur_hash3(texspace, sizeof(texspace), hash);
+
+    BL::Mesh::vertices_iterator v;
+    for (b_mesh.vertices.begin(v); v != b_mesh.vertices.end(); ++v) {
+      BL::Array<float, 3> undeformed_co = v->undeformed_co();
+      hash = util_murmur_hash3(undeformed_co.data, sizeof(undeformed_co.data), hash);
+    }
+  }
+
+  return hash;
+}
+
+/* Number of evaluated mesh vertices queued for conversion before the queue is converted,
+ * bounds the memory used by evaluated meshes that are held until their conversion. */
+#define MESH_SYNC_MAX_BATCH_VERTS (1 << 22)
+
 void BlenderSync::sync_mesh(BL::Depsgraph b_depsgraph,
                             BL::Object b_ob,
                             Mesh *mesh,
-                            const vector<Shader *> &used_shaders)
+                            const vector<Shader *> &used_shaders,
+                            bool check_data_hash)
 {
+  MeshSyncTask task(b_ob, mesh, used_shaders);
+
+  if (view_layer.use_surfaces) {
+    /* Adaptive subdivision setup. Not for baking since that requires
+     * exact mapping to the Blender mesh. */
+    if (!scene->bake_manager->get_baking()) {
+      task.subdivision_type = object_subdivision_type(b_ob, preview, experimental);
+    }
+
+    /* For some reason, meshes do not need this... */
+    mesh->used_shaders = used_shaders;
+    bool need_undeformed = mesh->need_attribute(scene, ATTR_STD_GENERATED);
+
+    /* Evaluated mesh is acquired here, since this may allocate or modify Blender data. */
+    task.b_mesh = object_to_mesh(
+        b_data, b_ob, b_depsgraph, need_undeformed, task.subdivision_type);
+  }
+
+  /* Adaptive subdivision and motion depend on more than the evaluated mesh. */
+  task.use_data_hash = task.b_mesh && task.subdivision_type == Mesh::SUBDIVISION_NONE &&
+                       scene->need_motion() == Scene::MOTION_NONE;
+  task.check_data_hash = task.use_data_hash && check_data_hash;
+
+  if (task.check_data_hash) {
+    geometry_hash_checked.insert(mesh);
+  }
+
+  if (task.subdivision_type == Mesh::SUBDIVISION_NONE && !object_fluid_liquid_domain_find(b_ob)) {
+    /* Converted in parallel with other meshes, in batches so that only a bounded number of
+     * evaluated meshes is held at once. */
+    if (task.b_mesh) {
+      mesh_sync_queue_verts += task.b_mesh.vertices.length();
+    }
+    mesh_sync_queue.push_back(task);
+
+    if (mesh_sync_queue_verts >= MESH_SYNC_MAX_BATCH_VERTS) {
+      sync_mesh_queue();
+    }
+  }
+  else {
+    /* Subdivision settings are read through RNA which may create ID properties, and fluid
+     * motion must be exported before the object sync changes motion steps. */
+    sync_mesh_convert(&task);
+    sync_mesh_finish(task);
+  }
+}
+
+void BlenderSync::sync_mesh_convert(MeshSyncTask *task)
+{
+  Mesh *mesh = task->mesh;
+
+  if (progress.get_cancel()) {
+    task->use_data_hash = false;
+    return;
+  }
+
+  if (task->use_data_hash) {
+    task->data_hash = mesh_data_hash(scene, mesh, task->b_mesh);
+
+    if (task->check_data_hash) {
+      map<Mesh *, uint>::const_iterator it = mesh_data_hashes.find(mesh);
+      if (it != mesh_data_hashes.end() && it->second == task->data_hash) {
+        return;
+      }
+    }
+  }
+
   array<int> oldtriangles;
   array<Mesh::SubdFace> oldsubd_faces;
   array<int> oldsubd_face_corners;
@@ -954,42 +1140,87 @@ void BlenderSync::sync_mesh(BL::Depsgraph b_depsgraph,
   oldsubd_face_corners.steal_data(mesh->subd_face_corners);
 
   mesh->clear();
-  mesh->used_shaders = used_shaders;
+  mesh->used_shaders = task->used_shaders;
+  mesh->subdivision_type = task->subdivision_type;
+
+  if (task->b_mesh) {
+    /* Sync mesh itself. */
+    if (mesh->subdivision_type != Mesh::SUBDIVISION_NONE)
+      create_subd_mesh(scene,
+                       mesh,
+                       task->b_ob,
+                       task->b_mesh,
+                       mesh->used_shaders,
+                       dicing_rate,
+                       max_subdivisions);
+    else
+      create_mesh(scene, mesh, task->b_mesh, mesh->used_shaders, false);
+  }
+
+  task->updated = true;
+  task->rebuild = (oldtriangles != mesh->triangles) || (oldsubd_faces != mesh->subd_faces) ||
+                  (oldsubd_face_corners != mesh->subd_face_corners);
+}
 
-  mesh->subdivision_type = Mesh::SUBDIVISION_NONE;
+void BlenderSync::sync_mesh_finish(MeshSyncTask &task)
+{
+  if (task.b_mesh) {
+    free_object_to_mesh(b_data, task.b_ob, task.b_mesh);
+  }
 
-  if (view_layer.use_surfaces) {
-    /* Adaptive subdivision setup. Not for baking since that requires
-     * exact mapping to the Blender mesh. */
-    if (!scene->bake_manager->get_baking()) {
-      mesh->subdivision_type = object_subdivision_type(b_ob, preview, experimental);
-    }
+  if (task.use_data_hash) {
+    mesh_data_hashes[task.mesh] = task.data_hash;
+  }
+  else {
+    mesh_data_hashes.erase(task.mesh);
+  }
 
-    /* For some reason, meshes do not need this... */
-    bool need_undeformed = mesh->need_attribute(scene, ATTR_STD_GENERATED);
-    BL::Mesh b_mesh = object_to_mesh(
-        b_data, b_ob, b_depsgraph, need_undeformed, mesh->subdivision_type);
-
-    if (b_mesh) {
-      /* Sync mesh itself. */
-      if (mesh->subdivision_type != Mesh::SUBDIVISION_NONE)
-        create_subd_mesh(
-            scene, mesh, b_ob, b_mesh, mesh->used_shaders, dicing_rate, max_subdivisions);
-      else
-        create_mesh(scene, mesh, b_mesh, mesh->used_shaders, false);
-
-      free_object_to_mesh(b_data, b_ob, b_mesh);
-    }
+  if (!task.updated) {
+    VLOG(2) << "Evaluated mesh data unchanged for object " << task.b_ob.name();
+    return;
   }
 
   /* mesh fluid motion mantaflow */
-  sync_mesh_fluid_motion(b_ob, scene, mesh);
+  sync_mesh_fluid_motion(task.b_ob, scene, task.mesh);
 
   /* tag update */
-  bool rebuild = (oldtriangles != mesh->triangles) || (oldsubd_faces != mesh->subd_faces) ||
-                 (oldsubd_face_corners != mesh->subd_face_corners);
+  task.mesh->tag_update(scene, task.rebuild);
+}
+
+void BlenderSync::sync_mesh_queue()
+{
+  if (mesh_sync_queue.empty()) {
+    return;
+  }
 
-  mesh->tag_update(scene, rebuild);
+  /* Meshes are independent, only reading the evaluated data and writing their own. */
+  TaskPool pool;
+  foreach (MeshSyncTask &task, mesh_sync_queue) {
+    pool.push(function_bind(&BlenderSync::sync_mesh_convert, this, &task));
+  }
+  pool.wait_work();
+
+  /* Freeing evaluated meshes and tagging the scene is not thread safe. */
+  set<Geometry *> hash_checked_updated;
+  foreach (MeshSyncTask &task, mesh_sync_queue) {
+    sync_mesh_finish(task);
+
+    if (task.updated && task.check_data_hash) {
+      hash_checked_updated.insert(task.mesh);
+    }
+  }
+
+  mesh_sync_queue.clear();
+  mesh_sync_queue_verts = 0;
+
+  /* Objects synced before the conversion did not know yet if their mesh changed. */
+  if (!hash_checked_updated.empty()) {
+    foreach (Object *object, scene->objects) {
+      if (hash_checked_updated.find(object->geometry) != hash_checked_updated.end()) {
+        object->tag_update(scene);
+      }
+    }
+  }
 }
 
 void BlenderSync::sync_mesh_motion(BL::Depsgraph b_depsgraph,
@@ -1039,12 +1270,12 @@ void BlenderSync::sync_mesh_motion(BL::Depsgraph b_depsgraph,
     /* NOTE: We don't copy more that existing amount of vertices to prevent
      * possible memory corruption.
      */
-    BL::Mesh::vertices_iterator v;
-    int i = 0;
-    for (b_mesh.vertices.begin(v); v != b_mesh.vertices.end() && i < numverts; ++v, ++i) {
-      mP[i] = get_float3(v->co());
+    const MVert *verts = mesh_array<MVert>(b_mesh.vertices);
+    const size_t num_b_verts = min((size_t)b_mesh.vertices.length(), numverts);
+    for (size_t i = 0; i < num_b_verts; i++) {
+      mP[i] = mvert_co(verts[i]);
       if (mN)
-        mN[i] = get_float3(v->normal());
+        mN[i] = mvert_normal(verts[i]);
     }
     if (new_attribute) {
       /* In case of new attribute, we verify if there really was any motion. */
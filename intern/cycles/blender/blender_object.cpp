@@ -261,11 +261,19 @@ Object *BlenderSync::sync_object(BL::Depsgraph &b_depsgraph,
     object_updated = true;
   }
 
+  /* Geometry whose export may be skipped by its data hash is only tagged once it is known
+   * to have changed, objects using it are then tagged by sync_mesh_queue(). */
+  const bool geometry_updated = object->geometry &&
+                                (object->geometry->need_update ||
+                                 (geometry_synced.find(object->geometry) !=
+                                      geometry_synced.end() &&
+                                  geometry_hash_checked.find(object->geometry) ==
+                                      geometry_hash_checked.end()));
+
   /* object sync
    * transform comparison should not be needed, but duplis don't work perfect
    * in the depsgraph and may not signal changes, so this is a workaround */
-  if (object_updated || (object->geometry && object->geometry->need_update) ||
-      tfm != object->tfm) {
+  if (object_updated || geometry_updated || tfm != object->tfm) {
     object->name = b_ob.name().c_str();
     object->pass_id = b_ob.pass_index();
     object->color = get_float3(b_ob.color());
@@ -403,6 +411,9 @@ void BlenderSync::sync_objects(BL::Depsgraph &b_depsgraph,
     cancel = progress.get_cancel();
   }
 
+  /* Convert meshes queued by the object loop. */
+  sync_mesh_queue();
+
   progress.set_sync_status("");
 
   if (!cancel && !motion) {
@@ -413,6 +424,24 @@ void BlenderSync::sync_objects(BL::Depsgraph &b_depsgraph,
       scene->light_manager->tag_update(scene);
     if (geometry_map.post_sync())
       scene->geometry_manager->tag_update(scene);
+
+    /* Forget hashes of deleted meshes, a new mesh may be allocated at the same address. */
+    set<Geometry *> geometry_set(scene->geometry.begin(), scene->geometry.end());
+    for (map<Mesh *, uint>::iterator it = mesh_data_hashes.begin();
+         it != mesh_data_hashes.end();) {
+      if (geometry_set.find(it->first) == geometry_set.end()) {
+        mesh_data_hashes.erase(it++);
+      }
+      else {
+        it++;
+      }
+    }
+
+    /* With persistent data, geometry which was not exported again is reused from the previous
+     * frame or view layer. */
+    VLOG(1) << "Reused " << scene->geometry.size() - geometry_synced.size() << " of "
+            << scene->geometry.size() << " geometries.";
+
     if (object_map.post_sync())
       scene->object_manager->tag_update(scene);
     if (particle_system_map.post_sync())
@@ -222,7 +222,6 @@ void BlenderSession::reset_session(BL::BlendData &b_data, BL::Depsgraph &b_depsg
   }
 
   session->progress.reset();
-  scene->reset();
 
   session->tile_manager.set_tile_order(session_params.tile_order);
 
@@ -231,14 +230,24 @@ void BlenderSession::reset_session(BL::BlendData &b_data, BL::Depsgraph &b_depsg
    */
   session->stats.mem_peak = session->stats.mem_used;
 
-  /* There is no single depsgraph to use for the entire render.
-   * See note on create_session().
-   */
-  /* sync object should be re-created */
-  sync = new BlenderSync(b_engine, b_data, b_scene, scene, !background, session->progress);
-
   BL::SpaceView3D b_null_space_view3d(PointerRNA_NULL);
   BL::RegionView3D b_null_region_view3d(PointerRNA_NULL);
+
+  /* With persistent data Blender keeps the render depsgraph alive across frames and view
+   * layers, so evaluated datablocks which did not change keep their pointers and the synced
+   * data can be reused. Only what the depsgraph tagged since the previous render is updated.
+   */
+  if (b_render.use_motion_blur()) {
+    /* Motion steps are exported for every frame, start from scratch. */
+    scene->reset();
+
+    delete sync;
+    sync = new BlenderSync(b_engine, b_data, b_scene, scene, !background, session->progress);
+  }
+  else {
+    sync->sync_recalc(b_depsgraph, b_null_space_view3d);
+  }
+
   BufferParams buffer_params = BlenderSync::get_buffer_params(
       b_scene, b_render, b_null_space_view3d, b_null_region_view3d, scene->camera, width, height);
   session->reset(buffer_params, session_params.samples);
@@ -457,6 +466,16 @@ void BlenderSession::stamp_view_layer_metadata(Scene *scene, const string &view_
                             time_human_readable_from_seconds(render_time).c_str());
   b_rr.stamp_data_add_field((prefix + "synchronization_time").c_str(),
                             time_human_readable_from_seconds(total_time - render_time).c_str());
+
+  /* Store kernel, shader and object profiling, so scripts can find expensive shaders. */
+  if (session->params.use_profiling) {
+    RenderStats stats;
+    session->collect_statistics(&stats);
+    if (stats.has_profiling) {
+      b_rr.stamp_data_add_field((prefix + "profiling").c_str(),
+                                stats.profiling_json_report().c_str());
+    }
+  }
 }
 
 void BlenderSession::render(BL::Depsgraph &b_depsgraph_)
@@ -539,7 +558,11 @@ void BlenderSession::render(BL::Depsgraph &b_depsgraph_)
     sync->sync_camera(b_render, b_camera_override, width, height, b_rview_name.c_str());
     sync->sync_data(
         b_render, b_depsgraph, b_v3d, b_camera_override, width, height, &python_thread_state);
-    builtin_images_load();
+    {
+      scoped_timer timer;
+      builtin_images_load();
+      sync->sync_stats.add_entry(NamedTimeEntry("Builtin Images", timer.get_time()));
+    }
 
     /* Attempt to free all data which is held by Blender side, since at this
      * point we know that we've got everything to render current view layer.
@@ -582,6 +605,7 @@ void BlenderSession::render(BL::Depsgraph &b_depsgraph_)
     if (!b_engine.is_preview() && background && print_render_stats) {
       RenderStats stats;
       session->collect_statistics(&stats);
+      stats.sync.host = sync->sync_stats;
       printf("Render statistics:\n%s\n", stats.full_report().c_str());
     }
 
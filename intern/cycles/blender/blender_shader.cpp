@@ -30,6 +30,7 @@
 
 #include "util/util_debug.h"
 #include "util/util_foreach.h"
+#include "util/util_logging.h"
 #include "util/util_set.h"
 #include "util/util_string.h"
 #include "util/util_task.h"
@@ -1220,6 +1221,7 @@ void BlenderSync::sync_materials(BL::Depsgraph &b_depsgraph, bool update_all)
 
   TaskPool pool;
   set<Shader *> updated_shaders;
+  int num_materials = 0, num_synced = 0;
 
   BL::Depsgraph::ids_iterator b_id;
   for (b_depsgraph.ids.begin(b_id); b_id != b_depsgraph.ids.end(); ++b_id) {
@@ -1229,10 +1231,12 @@ void BlenderSync::sync_materials(BL::Depsgraph &b_depsgraph, bool update_all)
 
     BL::Material b_mat(*b_id);
     Shader *shader;
+    num_materials++;
 
     /* test if we need to sync */
     if (shader_map.add_or_update(&shader, b_mat) || update_all) {
       ShaderGraph *graph = new ShaderGraph();
+      num_synced++;
 
       shader->name = b_mat.name().c_str();
       shader->pass_id = b_mat.pass_index();
@@ -1294,6 +1298,10 @@ void BlenderSync::sync_materials(BL::Depsgraph &b_depsgraph, bool update_all)
   foreach (Shader *shader, updated_shaders) {
     shader->tag_update(scene);
   }
+
+  /* With persistent data, materials which were not synced again keep their compiled shader from
+   * the previous frame or view layer. */
+  VLOG(1) << "Synced " << num_synced << " of " << num_materials << " materials.";
 }
 
 /* Sync World */
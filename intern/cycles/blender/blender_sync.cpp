@@ -26,6 +26,7 @@
 #include "render/object.h"
 #include "render/scene.h"
 #include "render/shader.h"
+#include "render/stats.h"
 
 #include "device/device.h"
 
@@ -37,7 +38,9 @@
 #include "util/util_debug.h"
 #include "util/util_foreach.h"
 #include "util/util_hash.h"
+#include "util/util_logging.h"
 #include "util/util_opengl.h"
+#include "util/util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -59,6 +62,7 @@ BlenderSync::BlenderSync(BL::RenderEngine &b_engine,
       geometry_map(&scene->geometry),
       light_map(&scene->lights),
       particle_system_map(&scene->particle_systems),
+      mesh_sync_queue_verts(0),
       world_map(NULL),
       world_recalc(false),
       scene(scene),
@@ -207,28 +211,52 @@ void BlenderSync::sync_data(BL::RenderSettings &b_render,
 {
   BL::ViewLayer b_view_layer = b_depsgraph.view_layer_eval();
 
+  /* Timings are reset for every frame, so they can be compared between frames. */
+  sync_stats.clear();
+  double time_start = time_dt();
+
   sync_view_layer(b_v3d, b_view_layer);
   sync_integrator();
   sync_film(b_v3d);
+  add_sync_time("Settings", time_start);
+
   sync_shaders(b_depsgraph, b_v3d);
+  add_sync_time("Shaders", time_start);
+
   sync_images();
   sync_curve_settings();
+  add_sync_time("Images", time_start);
 
   geometry_synced.clear(); /* use for objects and motion sync */
+  geometry_hash_checked.clear();
 
   if (scene->need_motion() == Scene::MOTION_PASS || scene->need_motion() == Scene::MOTION_NONE ||
       scene->camera->motion_position == Camera::MOTION_POSITION_CENTER) {
     sync_objects(b_depsgraph, b_v3d);
   }
+  add_sync_time("Objects", time_start);
+
   sync_motion(b_render, b_depsgraph, b_v3d, b_override, width, height, python_thread_state);
+  add_sync_time("Motion", time_start);
 
   geometry_synced.clear();
+  geometry_hash_checked.clear();
 
   /* Shader sync done at the end, since object sync uses it.
    * false = don't delete unused shaders, not supported. */
   shader_map.post_sync(false);
 
   free_data_after_sync(b_depsgraph);
+  add_sync_time("Cleanup", time_start);
+
+  VLOG(1) << "Synchronization statistics:\n" << sync_stats.full_report(1);
+}
+
+void BlenderSync::add_sync_time(const char *name, double &time_start)
+{
+  const double time = time_dt();
+  sync_stats.add_entry(NamedTimeEntry(name, time - time_start));
+  time_start = time;
 }
 
 /* Integrator */
@@ -346,6 +374,11 @@ void BlenderSync::sync_integrator()
     integrator->ao_bounces = 0;
   }
 
+  integrator->use_light_tree = get_boolean(cscene, "use_light_tree");
+  if (integrator->use_light_tree_sampling() != previntegrator.use_light_tree_sampling()) {
+    scene->light_manager->tag_update(scene);
+  }
+
   if (integrator->modified(previntegrator))
     integrator->tag_update(scene);
 }
@@ -723,20 +756,23 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene, bool background)
   else if (shadingsystem == 1)
     params.shadingsystem = SHADINGSYSTEM_OSL;
 
-  if (background || DebugFlags().viewport_static_bvh)
+  if (background && params.shadingsystem != SHADINGSYSTEM_OSL)
+    params.persistent_data = r.use_persistent_data();
+  else
+    params.persistent_data = false;
+
+  /* With persistent data the render depsgraph and synced scene are kept between frames, use a
+   * two-level BVH so that geometry BVHs are kept as well, and refit when only deformed. */
+  if ((background && !params.persistent_data) || DebugFlags().viewport_static_bvh)
     params.bvh_type = SceneParams::BVH_STATIC;
   else
     params.bvh_type = SceneParams::BVH_DYNAMIC;
 
   params.use_bvh_spatial_split = RNA_boolean_get(&cscene, "debug_use_spatial_splits");
   params.use_bvh_unaligned_nodes = RNA_boolean_get(&cscene, "debug_use_hair_bvh");
+  params.use_bvh_quantized_nodes = RNA_boolean_get(&cscene, "debug_use_compressed_bvh");
   params.num_bvh_time_steps = RNA_int_get(&cscene, "debug_bvh_time_steps");
 
-  if (background && params.shadingsystem != SHADINGSYSTEM_OSL)
-    params.persistent_data = r.use_persistent_data();
-  else
-    params.persistent_data = false;
-
   int texture_limit;
   if (background) {
     texture_limit = RNA_enum_get(&cscene, "texture_limit_render");
@@ -751,6 +787,13 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene, bool background)
     params.texture_limit = 0;
   }
 
+  if (RNA_boolean_get(&cscene, "use_texture_cache")) {
+    params.texture_cache_size = RNA_int_get(&cscene, "texture_cache_size");
+  }
+  else {
+    params.texture_cache_size = 0;
+  }
+
   /* TODO(sergey): Once OSL supports per-microarchitecture optimization get
    * rid of this.
    */
@@ -877,6 +920,10 @@ SessionParams BlenderSync::get_session_params(BL::RenderEngine &b_engine,
   if (b_r.use_save_buffers())
     params.progressive_refine = false;
 
+  /* Save buffers write tiles to an OpenEXR file with the same tiling as the render result,
+   * so tiles can not be split. */
+  params.use_tile_splitting = !b_r.use_save_buffers();
+
   if (background) {
     if (params.progressive_refine)
       params.progressive = true;
@@ -908,7 +955,8 @@ SessionParams BlenderSync::get_session_params(BL::RenderEngine &b_engine,
   }
 
   params.use_profiling = params.device.has_profiling && !b_engine.is_preview() && background &&
-                         BlenderSession::print_render_stats;
+                         (BlenderSession::print_render_stats ||
+                          get_boolean(cscene, "use_profiling"));
 
   params.adaptive_sampling = RNA_boolean_get(&cscene, "use_adaptive_sampling");
 
@@ -25,8 +25,10 @@
 #include "blender/blender_id_map.h"
 #include "blender/blender_viewport.h"
 
+#include "render/mesh.h"
 #include "render/scene.h"
 #include "render/session.h"
+#include "render/stats.h"
 
 #include "util/util_map.h"
 #include "util/util_set.h"
@@ -110,8 +112,12 @@ class BlenderSync {
   static PassType get_pass_type(BL::RenderPass &b_pass);
   static int get_denoising_pass(BL::RenderPass &b_pass);
 
+  /* Time spent in each step of the last sync_data(). */
+  NamedTimeStats sync_stats;
+
  private:
   /* sync */
+  void add_sync_time(const char *name, double &time_start);
   void sync_lights(BL::Depsgraph &b_depsgraph, bool update_all);
   void sync_materials(BL::Depsgraph &b_depsgraph, bool update_all);
   void sync_objects(BL::Depsgraph &b_depsgraph, BL::SpaceView3D &b_v3d, float motion_time = 0.0f);
@@ -144,10 +150,45 @@ class BlenderSync {
   void sync_volume(BL::Object &b_ob, Mesh *mesh, const vector<Shader *> &used_shaders);
 
   /* Mesh */
+  struct MeshSyncTask {
+    MeshSyncTask(BL::Object &b_ob, Mesh *mesh, const vector<Shader *> &used_shaders)
+        : b_ob(b_ob),
+          b_mesh(PointerRNA_NULL),
+          mesh(mesh),
+          used_shaders(used_shaders),
+          subdivision_type(Mesh::SUBDIVISION_NONE),
+          use_data_hash(false),
+          check_data_hash(false),
+          data_hash(0),
+          updated(false),
+          rebuild(false)
+    {
+    }
+
+    BL::Object b_ob;
+    BL::Mesh b_mesh;
+    Mesh *mesh;
+    vector<Shader *> used_shaders;
+    Mesh::SubdivisionType subdivision_type;
+
+    /* Compute hash of the evaluated data, and skip the export if it matches the last one. */
+    bool use_data_hash;
+    bool check_data_hash;
+    uint data_hash;
+
+    /* Result of the conversion. */
+    bool updated;
+    bool rebuild;
+  };
+
   void sync_mesh(BL::Depsgraph b_depsgraph,
                  BL::Object b_ob,
                  Mesh *mesh,
-                 const vector<Shader *> &used_shaders);
+                 const vector<Shader *> &used_shaders,
+                 bool check_data_hash);
+  void sync_mesh_convert(MeshSyncTask *task);
+  void sync_mesh_finish(MeshSyncTask &task);
+  void sync_mesh_queue();
   void sync_mesh_motion(BL::Depsgraph b_depsgraph, BL::Object b_ob, Mesh *mesh, int motion_step);
 
   /* Hair */
@@ -220,6 +261,10 @@ class BlenderSync {
   id_map<ParticleSystemKey, ParticleSystem> particle_system_map;
   set<Geometry *> geometry_synced;
   set<Geometry *> geometry_motion_synced;
+  set<Geometry *> geometry_hash_checked;
+  vector<MeshSyncTask> mesh_sync_queue;
+  size_t mesh_sync_queue_verts;
+  map<Mesh *, uint> mesh_data_hashes;
   set<float> motion_times;
   void *world_map;
   bool world_recalc;
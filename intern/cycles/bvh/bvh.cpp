@@ -37,6 +37,7 @@
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
 #include "util/util_progress.h"
+#include "util/util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -153,6 +154,7 @@ void BVH::build(Progress &progress, Stats *)
                      params,
                      progress);
   BVHNode *bvh2_root = bvh_build.run();
+  build_stats = bvh_build.stats;
 
   if (progress.get_cancel()) {
     if (bvh2_root != NULL) {
@@ -161,6 +163,8 @@ void BVH::build(Progress &progress, Stats *)
     return;
   }
 
+  double pack_start_time = time_dt();
+
   /* BVH builder returns tree in a binary mode (with two children per inner
    * node. Need to adopt that for a wider BVH implementations. */
   BVHNode *root = widen_children_nodes(bvh2_root);
@@ -190,6 +194,8 @@ void BVH::build(Progress &progress, Stats *)
 
   /* free build nodes */
   root->deleteSubtree();
+
+  build_stats.pack_time = time_dt() - pack_start_time;
 }
 
 /* Refitting */
@@ -517,8 +523,9 @@ void BVH::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
         }
         else {
           if (use_obvh) {
-            nsize = BVH_ONODE_SIZE;
-            nsize_bbox = BVH_ONODE_SIZE - 1;
+            nsize = (bvh_nodes[i].x & PATH_RAY_NODE_QUANTIZED) ? BVH_QUANTIZED_ONODE_SIZE :
+                                                                 BVH_ONODE_SIZE;
+            nsize_bbox = nsize - 1;
           }
           else {
             nsize = (use_qbvh) ? BVH_QNODE_SIZE : BVH_NODE_SIZE;
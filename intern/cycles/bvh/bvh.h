@@ -87,6 +87,9 @@ class BVH {
   vector<Geometry *> geometry;
   vector<Object *> objects;
 
+  /* Statistics of the last build. */
+  BVHBuildStats build_stats;
+
   static BVH *create(const BVHParams &params,
                      const vector<Geometry *> &geometry,
                      const vector<Object *> &objects);
@@ -188,8 +188,14 @@ void BVH8::pack_aligned_inner(const BVHStackEntry &e, const BVHStackEntry *en, i
     bounds[i] = en[i].node->bounds;
     child[i] = en[i].encodeIdx();
   }
-  pack_aligned_node(
-      e.idx, bounds, child, e.node->visibility, e.node->time_from, e.node->time_to, num);
+  if (params.use_quantized_nodes) {
+    pack_quantized_node(
+        e.idx, bounds, child, e.node->visibility, e.node->time_from, e.node->time_to, num);
+  }
+  else {
+    pack_aligned_node(
+        e.idx, bounds, child, e.node->visibility, e.node->time_from, e.node->time_to, num);
+  }
 }
 
 void BVH8::pack_aligned_node(int idx,
@@ -203,7 +209,7 @@ void BVH8::pack_aligned_node(int idx,
   float8 data[8];
   memset(data, 0, sizeof(data));
 
-  data[0].a = __uint_as_float(visibility & ~PATH_RAY_NODE_UNALIGNED);
+  data[0].a = __uint_as_float(visibility & ~(PATH_RAY_NODE_UNALIGNED | PATH_RAY_NODE_QUANTIZED));
   data[0].b = time_from;
   data[0].c = time_to;
 
@@ -240,6 +246,87 @@ void BVH8::pack_aligned_node(int idx,
   memcpy(&pack.nodes[idx], data, sizeof(float4) * BVH_ONODE_SIZE);
 }
 
+/* Bounds beyond this are clamped, so the quantization scale stays finite. */
+#define BVH_QUANTIZED_BOUND_MAX (FLT_MAX * 0.25f)
+
+void BVH8::pack_quantized_node(int idx,
+                               const BoundBox *bounds,
+                               const int *child,
+                               const uint visibility,
+                               const float time_from,
+                               const float time_to,
+                               const int num)
+{
+  float4 data[BVH_QUANTIZED_ONODE_SIZE];
+  memset(data, 0, sizeof(data));
+
+  data[0].x = __uint_as_float((visibility & ~PATH_RAY_NODE_UNALIGNED) | PATH_RAY_NODE_QUANTIZED);
+  data[0].y = time_from;
+  data[0].z = time_to;
+
+  /* Clamped child bounds and the bounds of the node itself. */
+  const float3 bound_max = make_float3(BVH_QUANTIZED_BOUND_MAX);
+  float3 child_min[8], child_max[8];
+  float3 node_min = bound_max, node_max = -bound_max;
+  for (int i = 0; i < num; i++) {
+    child_min[i] = clamp(bounds[i].min, -bound_max, bound_max);
+    child_max[i] = clamp(bounds[i].max, -bound_max, bound_max);
+    node_min = min(node_min, child_min[i]);
+    node_max = max(node_max, child_max[i]);
+  }
+
+  /* Children are stored as 8 bit offsets from the node origin, which the kernel decodes as
+   * fmaf(q, scale, origin). Rounding is checked with the same operation, so that the decoded
+   * child bounds always enclose the actual ones. */
+  uchar *quantized = (uchar *)&data[3];
+
+  for (int axis = 0; axis < 3; axis++) {
+    const float origin = (num > 0) ? node_min[axis] : 0.0f;
+    const float upper_max = (num > 0) ? node_max[axis] : 0.0f;
+
+    /* Keep the scale non-zero, empty child slots rely on lower bounds above upper bounds. */
+    float scale = max((upper_max - origin) / 255.0f, max(fabsf(origin), 1.0f) * 1e-6f);
+    while (fmaf(255.0f, scale, origin) < upper_max) {
+      scale = nextafterf(scale, FLT_MAX);
+    }
+
+    data[1][axis] = origin;
+    data[2][axis] = scale;
+
+    uchar *q_lower = quantized + (2 * axis) * 8;
+    uchar *q_upper = quantized + (2 * axis + 1) * 8;
+    const float inv_scale = 1.0f / scale;
+
+    for (int i = 0; i < num; i++) {
+      int lower = (int)clamp(floorf((child_min[i][axis] - origin) * inv_scale), 0.0f, 255.0f);
+      while (lower > 0 && fmaf((float)lower, scale, origin) > child_min[i][axis]) {
+        lower--;
+      }
+
+      int upper = (int)clamp(ceilf((child_max[i][axis] - origin) * inv_scale), 0.0f, 255.0f);
+      while (upper < 255 && fmaf((float)upper, scale, origin) < child_max[i][axis]) {
+        upper++;
+      }
+
+      q_lower[i] = (uchar)lower;
+      q_upper[i] = (uchar)upper;
+    }
+
+    for (int i = num; i < 8; i++) {
+      /* Lower bound above the upper one, so the kernel never records an intersection. */
+      q_lower[i] = 255;
+      q_upper[i] = 0;
+    }
+  }
+
+  int *data_child = (int *)&data[BVH_QUANTIZED_ONODE_SIZE - 2];
+  for (int i = 0; i < 8; i++) {
+    data_child[i] = (i < num) ? child[i] : 0;
+  }
+
+  memcpy(&pack.nodes[idx], data, sizeof(float4) * BVH_QUANTIZED_ONODE_SIZE);
+}
+
 void BVH8::pack_unaligned_inner(const BVHStackEntry &e, const BVHStackEntry *en, int num)
 {
   Transform aligned_space[8];
@@ -272,7 +359,8 @@ void BVH8::pack_unaligned_node(int idx,
   float8 data[BVH_UNALIGNED_ONODE_SIZE];
   memset(data, 0, sizeof(data));
 
-  data[0].a = __uint_as_float(visibility | PATH_RAY_NODE_UNALIGNED);
+  data[0].a = __uint_as_float((visibility & ~PATH_RAY_NODE_QUANTIZED) |
+                              PATH_RAY_NODE_UNALIGNED);
   data[0].b = time_from;
   data[0].c = time_to;
 
@@ -338,10 +426,10 @@ void BVH8::pack_nodes(const BVHNode *root)
   if (params.use_unaligned_nodes) {
     const size_t num_unaligned_nodes = root->getSubtreeSize(BVH_STAT_UNALIGNED_INNER_COUNT);
     node_size = (num_unaligned_nodes * BVH_UNALIGNED_ONODE_SIZE) +
-                (num_inner_nodes - num_unaligned_nodes) * BVH_ONODE_SIZE;
+                (num_inner_nodes - num_unaligned_nodes) * aligned_node_size();
   }
   else {
-    node_size = num_inner_nodes * BVH_ONODE_SIZE;
+    node_size = num_inner_nodes * aligned_node_size();
   }
   /* Resize arrays. */
   pack.nodes.clear();
@@ -364,7 +452,7 @@ void BVH8::pack_nodes(const BVHNode *root)
   }
   else {
     stack.push_back(BVHStackEntry(root, nextNodeIdx));
-    nextNodeIdx += root->has_unaligned() ? BVH_UNALIGNED_ONODE_SIZE : BVH_ONODE_SIZE;
+    nextNodeIdx += root->has_unaligned() ? BVH_UNALIGNED_ONODE_SIZE : aligned_node_size();
   }
 
   while (stack.size()) {
@@ -390,7 +478,8 @@ void BVH8::pack_nodes(const BVHNode *root)
         }
         else {
           idx = nextNodeIdx;
-          nextNodeIdx += children[i]->has_unaligned() ? BVH_UNALIGNED_ONODE_SIZE : BVH_ONODE_SIZE;
+          nextNodeIdx += children[i]->has_unaligned() ? BVH_UNALIGNED_ONODE_SIZE :
+                                                        aligned_node_size();
         }
         stack.push_back(BVHStackEntry(children[i], idx));
       }
@@ -493,6 +582,7 @@ void BVH8::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
   else {
     float8 *data = (float8 *)&pack.nodes[idx];
     bool is_unaligned = (__float_as_uint(data[0].a) & PATH_RAY_NODE_UNALIGNED) != 0;
+    bool is_quantized = (__float_as_uint(data[0].a) & PATH_RAY_NODE_QUANTIZED) != 0;
     /* Refit inner node, set bbox from children. */
     BoundBox child_bbox[8] = {BoundBox::empty,
                               BoundBox::empty,
@@ -507,7 +597,7 @@ void BVH8::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     int num_nodes = 0;
 
     for (int i = 0; i < 8; ++i) {
-      child[i] = __float_as_int(data[(is_unaligned) ? 13 : 7][i]);
+      child[i] = __float_as_int(data[(is_unaligned) ? 13 : (is_quantized) ? 3 : 7][i]);
 
       if (child[i] != 0) {
         refit_node((child[i] < 0) ? -child[i] - 1 : child[i],
@@ -532,6 +622,9 @@ void BVH8::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
       pack_unaligned_node(
           idx, aligned_space, child_bbox, child, visibility, 0.0f, 1.0f, num_nodes);
     }
+    else if (is_quantized) {
+      pack_quantized_node(idx, child_bbox, child, visibility, 0.0f, 1.0f, num_nodes);
+    }
     else {
       pack_aligned_node(idx, child_bbox, child, visibility, 0.0f, 1.0f, num_nodes);
     }
@@ -48,6 +48,7 @@ class Progress;
 #define BVH_ONODE_SIZE 16
 #define BVH_ONODE_LEAF_SIZE 1
 #define BVH_UNALIGNED_ONODE_SIZE 28
+#define BVH_QUANTIZED_ONODE_SIZE 8
 
 /* BVH8
  *
@@ -78,6 +79,13 @@ class BVH8 : public BVH {
                          const float time_from,
                          const float time_to,
                          const int num);
+  void pack_quantized_node(int idx,
+                           const BoundBox *bounds,
+                           const int *child,
+                           const uint visibility,
+                           const float time_from,
+                           const float time_to,
+                           const int num);
 
   void pack_unaligned_inner(const BVHStackEntry &e, const BVHStackEntry *en, int num);
   void pack_unaligned_node(int idx,
@@ -89,6 +97,11 @@ class BVH8 : public BVH {
                            const float time_to,
                            const int num);
 
+  int aligned_node_size() const
+  {
+    return (params.use_quantized_nodes) ? BVH_QUANTIZED_ONODE_SIZE : BVH_ONODE_SIZE;
+  }
+
   /* refit */
   void refit_nodes() override;
   void refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility);
@@ -23,6 +23,8 @@
 
 #include "util/util_algorithm.h"
 #include "util/util_boundbox.h"
+#include "util/util_foreach.h"
+#include "util/util_task.h"
 #include "util/util_types.h"
 
 CCL_NAMESPACE_BEGIN
@@ -96,75 +98,40 @@ BVHObjectBinning::BVHObjectBinning(const BVHRange &job,
   num_bins = min(size_t(MAX_BINS), size_t(4.0f + 0.05f * size()));
   scale = rcp(cent_bounds_.size()) * make_float3((float)num_bins);
 
-  /* initialize binning counter and bounds */
-  BoundBox bin_bounds[MAX_BINS][4]; /* bounds for every bin in every dimension */
-  int4 bin_count[MAX_BINS];         /* number of primitives mapped to bin */
+  /* map geometry to bins */
+  Bins bins;
+  const int num_chunks = num_parallel_chunks();
 
-  for (size_t i = 0; i < num_bins; i++) {
-    bin_count[i] = make_int4(0);
-    bin_bounds[i][0] = bin_bounds[i][1] = bin_bounds[i][2] = BoundBox::empty;
+  if (num_chunks == 1) {
+    bin_chunk(prims, 0, size(), &bins);
   }
-
-  /* map geometry to bins, unrolled once */
-  {
-    ssize_t i;
-
-    for (i = 0; i < ssize_t(size()) - 1; i += 2) {
-      prefetch_L2(&prims[start() + i + 8]);
-
-      /* map even and odd primitive to bin */
-      const BVHReference &prim0 = prims[start() + i + 0];
-      const BVHReference &prim1 = prims[start() + i + 1];
-
-      BoundBox bounds0 = get_prim_bounds(prim0);
-      BoundBox bounds1 = get_prim_bounds(prim1);
-
-      int4 bin0 = get_bin(bounds0);
-      int4 bin1 = get_bin(bounds1);
-
-      /* increase bounds for bins for even primitive */
-      int b00 = (int)extract<0>(bin0);
-      bin_count[b00][0]++;
-      bin_bounds[b00][0].grow(bounds0);
-      int b01 = (int)extract<1>(bin0);
-      bin_count[b01][1]++;
-      bin_bounds[b01][1].grow(bounds0);
-      int b02 = (int)extract<2>(bin0);
-      bin_count[b02][2]++;
-      bin_bounds[b02][2].grow(bounds0);
-
-      /* increase bounds of bins for odd primitive */
-      int b10 = (int)extract<0>(bin1);
-      bin_count[b10][0]++;
-      bin_bounds[b10][0].grow(bounds1);
-      int b11 = (int)extract<1>(bin1);
-      bin_count[b11][1]++;
-      bin_bounds[b11][1].grow(bounds1);
-      int b12 = (int)extract<2>(bin1);
-      bin_count[b12][2]++;
-      bin_bounds[b12][2].grow(bounds1);
+  else {
+    /* bin chunks of references in parallel, and merge them afterwards */
+    vector<Bins> chunk_bins(num_chunks);
+    TaskPool pool;
+
+    for (int i = 0; i < num_chunks; i++) {
+      const size_t begin = (size() * i) / num_chunks;
+      const size_t end = (size() * (i + 1)) / num_chunks;
+      pool.push(function_bind(
+          &BVHObjectBinning::bin_chunk, this, prims, begin, end, &chunk_bins[i]));
     }
-
-    /* for uneven number of primitives */
-    if (i < ssize_t(size())) {
-      /* map primitive to bin */
-      const BVHReference &prim0 = prims[start() + i];
-      BoundBox bounds0 = get_prim_bounds(prim0);
-      int4 bin0 = get_bin(bounds0);
-
-      /* increase bounds of bins */
-      int b00 = (int)extract<0>(bin0);
-      bin_count[b00][0]++;
-      bin_bounds[b00][0].grow(bounds0);
-      int b01 = (int)extract<1>(bin0);
-      bin_count[b01][1]++;
-      bin_bounds[b01][1].grow(bounds0);
-      int b02 = (int)extract<2>(bin0);
-      bin_count[b02][2]++;
-      bin_bounds[b02][2].grow(bounds0);
+    pool.wait_work();
+
+    bins = chunk_bins[0];
+    for (int i = 1; i < num_chunks; i++) {
+      for (size_t j = 0; j < num_bins; j++) {
+        bins.count[j] = bins.count[j] + chunk_bins[i].count[j];
+        bins.bounds[j][0].grow(chunk_bins[i].bounds[j][0]);
+        bins.bounds[j][1].grow(chunk_bins[i].bounds[j][1]);
+        bins.bounds[j][2].grow(chunk_bins[i].bounds[j][2]);
+      }
     }
   }
 
+  BoundBox(*bin_bounds)[4] = bins.bounds;
+  int4 *bin_count = bins.count;
+
   /* sweep from right to left and compute parallel prefix of merged bounds */
   float4 r_area[MAX_BINS];  /* area of bounds of primitives on the right */
   float4 r_count[MAX_BINS]; /* number of primitives on the right */
@@ -226,6 +193,224 @@ BVHObjectBinning::BVHObjectBinning(const BVHRange &job,
   leafSAH = bounds_.half_area() * blocks(size());
 }
 
+int BVHObjectBinning::num_parallel_chunks() const
+{
+  if (size() < PARALLEL_MIN_SIZE) {
+    return 1;
+  }
+  /* The thread waiting for the pool is working on chunks as well. */
+  const size_t num_threads = TaskScheduler::num_threads() + 1;
+  return (int)min(num_threads, size_t(size() / PARALLEL_CHUNK_SIZE));
+}
+
+void BVHObjectBinning::bin_chunk(const BVHReference *prims,
+                                 size_t begin,
+                                 size_t end,
+                                 Bins *bins) const
+{
+  BoundBox(*bin_bounds)[4] = bins->bounds;
+  int4 *bin_count = bins->count;
+
+  /* initialize binning counter and bounds */
+  for (size_t i = 0; i < num_bins; i++) {
+    bin_count[i] = make_int4(0);
+    bin_bounds[i][0] = bin_bounds[i][1] = bin_bounds[i][2] = BoundBox::empty;
+  }
+
+  /* map geometry to bins, unrolled once */
+  ssize_t i;
+
+  for (i = begin; i < ssize_t(end) - 1; i += 2) {
+    prefetch_L2(&prims[start() + i + 8]);
+
+    /* map even and odd primitive to bin */
+    const BVHReference &prim0 = prims[start() + i + 0];
+    const BVHReference &prim1 = prims[start() + i + 1];
+
+    BoundBox bounds0 = get_prim_bounds(prim0);
+    BoundBox bounds1 = get_prim_bounds(prim1);
+
+    int4 bin0 = get_bin(bounds0);
+    int4 bin1 = get_bin(bounds1);
+
+    /* increase bounds for bins for even primitive */
+    int b00 = (int)extract<0>(bin0);
+    bin_count[b00][0]++;
+    bin_bounds[b00][0].grow(bounds0);
+    int b01 = (int)extract<1>(bin0);
+    bin_count[b01][1]++;
+    bin_bounds[b01][1].grow(bounds0);
+    int b02 = (int)extract<2>(bin0);
+    bin_count[b02][2]++;
+    bin_bounds[b02][2].grow(bounds0);
+
+    /* increase bounds of bins for odd primitive */
+    int b10 = (int)extract<0>(bin1);
+    bin_count[b10][0]++;
+    bin_bounds[b10][0].grow(bounds1);
+    int b11 = (int)extract<1>(bin1);
+    bin_count[b11][1]++;
+    bin_bounds[b11][1].grow(bounds1);
+    int b12 = (int)extract<2>(bin1);
+    bin_count[b12][2]++;
+    bin_bounds[b12][2].grow(bounds1);
+  }
+
+  /* for uneven number of primitives */
+  if (i < ssize_t(end)) {
+    /* map primitive to bin */
+    const BVHReference &prim0 = prims[start() + i];
+    BoundBox bounds0 = get_prim_bounds(prim0);
+    int4 bin0 = get_bin(bounds0);
+
+    /* increase bounds of bins */
+    int b00 = (int)extract<0>(bin0);
+    bin_count[b00][0]++;
+    bin_bounds[b00][0].grow(bounds0);
+    int b01 = (int)extract<1>(bin0);
+    bin_count[b01][1]++;
+    bin_bounds[b01][1].grow(bounds0);
+    int b02 = (int)extract<2>(bin0);
+    bin_count[b02][2]++;
+    bin_bounds[b02][2].grow(bounds0);
+  }
+}
+
+void BVHObjectBinning::classify_chunk(const BVHReference *prims,
+                                      size_t begin,
+                                      size_t end,
+                                      uint8_t *left_flags,
+                                      SplitChunk *chunk) const
+{
+  chunk->lgeom_bounds = BoundBox::empty;
+  chunk->rgeom_bounds = BoundBox::empty;
+  chunk->lcent_bounds = BoundBox::empty;
+  chunk->rcent_bounds = BoundBox::empty;
+  chunk->num_left = 0;
+
+  for (size_t i = begin; i < end; i++) {
+    const BVHReference &prim = prims[start() + i];
+    float3 center = prim.bounds().center2();
+
+    if (is_left(prim)) {
+      chunk->lgeom_bounds.grow(prim.bounds());
+      chunk->lcent_bounds.grow(center);
+      chunk->num_left++;
+      left_flags[i] = 1;
+    }
+    else {
+      chunk->rgeom_bounds.grow(prim.bounds());
+      chunk->rcent_bounds.grow(center);
+      left_flags[i] = 0;
+    }
+  }
+}
+
+static void gather_misplaced_chunk(const uint8_t *left_flags,
+                                   size_t begin,
+                                   size_t end,
+                                   size_t num_left,
+                                   vector<int> *misplaced_left,
+                                   vector<int> *misplaced_right)
+{
+  for (size_t i = begin; i < min(end, num_left); i++) {
+    if (!left_flags[i]) {
+      misplaced_left->push_back((int)i);
+    }
+  }
+  for (size_t i = max(begin, num_left); i < end; i++) {
+    if (left_flags[i]) {
+      misplaced_right->push_back((int)i);
+    }
+  }
+}
+
+static void swap_misplaced_chunk(BVHReference *prims,
+                                 const int *misplaced_left,
+                                 const int *misplaced_right,
+                                 size_t begin,
+                                 size_t end)
+{
+  for (size_t i = begin; i < end; i++) {
+    swap(prims[misplaced_left[i]], prims[misplaced_right[i]]);
+  }
+}
+
+/* Partition references in place using multiple threads. References are first
+ * classified in chunks, which gives the partition point. Then every reference
+ * on the wrong side of it is swapped with one from the other side. */
+void BVHObjectBinning::split_parallel(BVHReference *prims, SplitChunk *result) const
+{
+  const size_t N = size();
+  const int num_chunks = num_parallel_chunks();
+
+  vector<uint8_t> left_flags(N);
+  vector<SplitChunk> chunks(num_chunks);
+  TaskPool pool;
+
+  for (int i = 0; i < num_chunks; i++) {
+    const size_t begin = (N * i) / num_chunks;
+    const size_t end = (N * (i + 1)) / num_chunks;
+    pool.push(function_bind(
+        &BVHObjectBinning::classify_chunk, this, prims, begin, end, &left_flags[0], &chunks[i]));
+  }
+  pool.wait_work();
+
+  result->lgeom_bounds = BoundBox::empty;
+  result->rgeom_bounds = BoundBox::empty;
+  result->lcent_bounds = BoundBox::empty;
+  result->rcent_bounds = BoundBox::empty;
+  result->num_left = 0;
+  foreach (const SplitChunk &chunk, chunks) {
+    result->lgeom_bounds.grow(chunk.lgeom_bounds);
+    result->rgeom_bounds.grow(chunk.rgeom_bounds);
+    result->lcent_bounds.grow(chunk.lcent_bounds);
+    result->rcent_bounds.grow(chunk.rcent_bounds);
+    result->num_left += chunk.num_left;
+  }
+
+  for (int i = 0; i < num_chunks; i++) {
+    const size_t begin = (N * i) / num_chunks;
+    const size_t end = (N * (i + 1)) / num_chunks;
+    pool.push(function_bind(&gather_misplaced_chunk,
+                            &left_flags[0],
+                            begin,
+                            end,
+                            result->num_left,
+                            &chunks[i].misplaced_left,
+                            &chunks[i].misplaced_right));
+  }
+  pool.wait_work();
+
+  /* Both lists are ordered by chunk, so any pairing of their entries is a
+   * valid swap. */
+  foreach (const SplitChunk &chunk, chunks) {
+    result->misplaced_left.insert(
+        result->misplaced_left.end(), chunk.misplaced_left.begin(), chunk.misplaced_left.end());
+    result->misplaced_right.insert(result->misplaced_right.end(),
+                                   chunk.misplaced_right.begin(),
+                                   chunk.misplaced_right.end());
+  }
+
+  const size_t num_misplaced = result->misplaced_left.size();
+  assert(num_misplaced == result->misplaced_right.size());
+  if (num_misplaced == 0) {
+    return;
+  }
+
+  for (int i = 0; i < num_chunks; i++) {
+    const size_t begin = (num_misplaced * i) / num_chunks;
+    const size_t end = (num_misplaced * (i + 1)) / num_chunks;
+    pool.push(function_bind(&swap_misplaced_chunk,
+                            prims + start(),
+                            &result->misplaced_left[0],
+                            &result->misplaced_right[0],
+                            begin,
+                            end));
+  }
+  pool.wait_work();
+}
+
 void BVHObjectBinning::split(BVHReference *prims,
                              BVHObjectBinning &left_o,
                              BVHObjectBinning &right_o) const
@@ -239,25 +424,36 @@ void BVHObjectBinning::split(BVHReference *prims,
 
   ssize_t l = 0, r = N - 1;
 
-  while (l <= r) {
-    prefetch_L2(&prims[start() + l + 8]);
-    prefetch_L2(&prims[start() + r - 8]);
-
-    BVHReference prim = prims[start() + l];
-    BoundBox unaligned_bounds = get_prim_bounds(prim);
-    float3 unaligned_center = unaligned_bounds.center2();
-    float3 center = prim.bounds().center2();
+  if (num_parallel_chunks() > 1) {
+    SplitChunk result;
+    split_parallel(prims, &result);
 
-    if (get_bin(unaligned_center)[dim] < pos) {
-      lgeom_bounds.grow(prim.bounds());
-      lcent_bounds.grow(center);
-      l++;
-    }
-    else {
-      rgeom_bounds.grow(prim.bounds());
-      rcent_bounds.grow(center);
-      swap(prims[start() + l], prims[start() + r]);
-      r--;
+    lgeom_bounds = result.lgeom_bounds;
+    rgeom_bounds = result.rgeom_bounds;
+    lcent_bounds = result.lcent_bounds;
+    rcent_bounds = result.rcent_bounds;
+    l = result.num_left;
+    r = l - 1;
+  }
+  else {
+    while (l <= r) {
+      prefetch_L2(&prims[start() + l + 8]);
+      prefetch_L2(&prims[start() + r - 8]);
+
+      BVHReference prim = prims[start() + l];
+      float3 center = prim.bounds().center2();
+
+      if (is_left(prim)) {
+        lgeom_bounds.grow(prim.bounds());
+        lcent_bounds.grow(center);
+        l++;
+      }
+      else {
+        rgeom_bounds.grow(prim.bounds());
+        rcent_bounds.grow(center);
+        swap(prims[start() + l], prims[start() + r]);
+        r--;
+      }
     }
   }
   /* finish */
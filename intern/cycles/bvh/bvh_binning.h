@@ -22,17 +22,22 @@
 #include "bvh/bvh_unaligned.h"
 
 #include "util/util_types.h"
+#include "util/util_vector.h"
 
 CCL_NAMESPACE_BEGIN
 
 class BVHBuild;
 
-/* Single threaded object binner. Finds the split with the best SAH heuristic
- * by testing for each dimension multiple partitionings for regular spaced
- * partition locations. A partitioning for a partition location is computed,
- * by putting primitives whose centroid is on the left and right of the split
- * location to different sets. The SAH is evaluated by computing the number of
- * blocks occupied by the primitives in the partitions. */
+/* Object binner. Finds the split with the best SAH heuristic by testing for
+ * each dimension multiple partitionings for regular spaced partition locations.
+ * A partitioning for a partition location is computed, by putting primitives
+ * whose centroid is on the left and right of the split location to different
+ * sets. The SAH is evaluated by computing the number of blocks occupied by the
+ * primitives in the partitions.
+ *
+ * Large ranges are binned and partitioned by multiple threads, each working on
+ * a chunk of the references. This keeps all threads busy at the top levels of
+ * the tree, where there are not yet enough subtrees to build in parallel. */
 
 class BVHObjectBinning : public BVHRange {
  public:
@@ -71,6 +76,45 @@ class BVHObjectBinning : public BVHRange {
   enum { MAX_BINS = 32 };
   enum { LOG_BLOCK_SIZE = 2 };
 
+  /* Ranges with at least this many references are binned and partitioned in
+   * parallel, in chunks of at least PARALLEL_CHUNK_SIZE references. */
+  enum { PARALLEL_MIN_SIZE = 65536 };
+  enum { PARALLEL_CHUNK_SIZE = 16384 };
+
+  /* Bin counters and bounds accumulated over a chunk of references. */
+  struct Bins {
+    BoundBox bounds[MAX_BINS][4]; /* bounds for every bin in every dimension */
+    int4 count[MAX_BINS];         /* number of primitives mapped to bin */
+  };
+
+  /* Result of classifying a chunk of references against the split plane. */
+  struct SplitChunk {
+    BoundBox lgeom_bounds, rgeom_bounds;
+    BoundBox lcent_bounds, rcent_bounds;
+    size_t num_left;
+
+    /* References on the wrong side of the partition point, which are to be
+     * swapped with each other. */
+    vector<int> misplaced_left;
+    vector<int> misplaced_right;
+  };
+
+  int num_parallel_chunks() const;
+
+  void bin_chunk(const BVHReference *prims, size_t begin, size_t end, Bins *bins) const;
+  void classify_chunk(const BVHReference *prims,
+                      size_t begin,
+                      size_t end,
+                      uint8_t *left_flags,
+                      SplitChunk *chunk) const;
+  void split_parallel(BVHReference *prims, SplitChunk *result) const;
+
+  /* test whether primitive goes to the left side of the best split. */
+  __forceinline bool is_left(const BVHReference &prim) const
+  {
+    return get_bin(get_prim_bounds(prim).center2())[dim] < pos;
+  }
+
   /* computes the bin numbers for each dimension for a box. */
   __forceinline int4 get_bin(const BoundBox &box) const
   {
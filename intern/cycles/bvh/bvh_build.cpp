@@ -407,7 +407,9 @@ BVHNode *BVHBuild::run()
   BVHRange root;
 
   /* add references */
+  double references_start_time = time_dt();
   add_references(root);
+  stats.references_time = time_dt() - references_start_time;
 
   if (progress.get_cancel())
     return NULL;
@@ -488,16 +490,20 @@ BVHNode *BVHBuild::run()
       rootnode->update_time();
     }
     if (rootnode != NULL) {
+      stats.build_time = time_dt() - build_start_time;
+      stats.num_references = references.size();
+      stats.num_nodes = rootnode->getSubtreeSize(BVH_STAT_NODE_COUNT);
+      stats.num_leaf_nodes = rootnode->getSubtreeSize(BVH_STAT_LEAF_COUNT);
+
       VLOG(1) << "BVH build statistics:\n"
-              << "  Build time: " << time_dt() - build_start_time << "\n"
-              << "  Total number of nodes: "
-              << string_human_readable_number(rootnode->getSubtreeSize(BVH_STAT_NODE_COUNT))
+              << "  References time: " << stats.references_time << "\n"
+              << "  Build time: " << stats.build_time << "\n"
+              << "  Total number of nodes: " << string_human_readable_number(stats.num_nodes)
               << "\n"
               << "  Number of inner nodes: "
               << string_human_readable_number(rootnode->getSubtreeSize(BVH_STAT_INNER_COUNT))
               << "\n"
-              << "  Number of leaf nodes: "
-              << string_human_readable_number(rootnode->getSubtreeSize(BVH_STAT_LEAF_COUNT))
+              << "  Number of leaf nodes: " << string_human_readable_number(stats.num_leaf_nodes)
               << "\n"
               << "  Number of unaligned nodes: "
               << string_human_readable_number(rootnode->getSubtreeSize(BVH_STAT_UNALIGNED_COUNT))
@@ -836,6 +842,17 @@ BVHNode *BVHBuild::create_object_leaf_nodes(const BVHReference *ref, int start,
   }
 }
 
+static bool curve_reference_order(const BVHReference &a, const BVHReference &b)
+{
+  if (a.prim_object() != b.prim_object()) {
+    return a.prim_object() < b.prim_object();
+  }
+  if (a.prim_index() != b.prim_index()) {
+    return a.prim_index() < b.prim_index();
+  }
+  return PRIMITIVE_UNPACK_SEGMENT(a.prim_type()) < PRIMITIVE_UNPACK_SEGMENT(b.prim_type());
+}
+
 BVHNode *BVHBuild::create_leaf_node(const BVHRange &range, const vector<BVHReference> &references)
 {
   /* This is a bit overallocating here (considering leaf size into account),
@@ -878,10 +895,6 @@ BVHNode *BVHBuild::create_leaf_node(const BVHRange &range, const vector<BVHRefer
     if (ref.prim_index() != -1) {
       int type_index = bitscan(ref.prim_type() & PRIMITIVE_ALL);
       p_ref[type_index].push_back(ref);
-      p_type[type_index].push_back(ref.prim_type());
-      p_index[type_index].push_back(ref.prim_index());
-      p_object[type_index].push_back(ref.prim_object());
-      p_time[type_index].push_back(make_float2(ref.time_from(), ref.time_to()));
 
       bounds[type_index].grow(ref.bounds());
       visibility[type_index] |= objects[ref.prim_object()]->visibility_for_tracing();
@@ -892,6 +905,19 @@ BVHNode *BVHBuild::create_leaf_node(const BVHRange &range, const vector<BVHRefer
       ++ob_num;
     }
   }
+  for (int i = 0; i < PRIMITIVE_NUM_TOTAL; ++i) {
+    /* Keep segments of the same strand next to each other, so the kernel reads their keys
+     * from the same cache lines when testing the segments of a leaf together. */
+    if ((1 << i) & PRIMITIVE_ALL_CURVE) {
+      std::sort(p_ref[i].begin(), p_ref[i].end(), curve_reference_order);
+    }
+    foreach (const BVHReference &ref, p_ref[i]) {
+      p_type[i].push_back(ref.prim_type());
+      p_index[i].push_back(ref.prim_index());
+      p_object[i].push_back(ref.prim_object());
+      p_time[i].push_back(make_float2(ref.time_from(), ref.time_to()));
+    }
+  }
 
   /* Create leaf nodes for every existing primitive.
    *
@@ -928,9 +954,10 @@ BVHNode *BVHBuild::create_leaf_node(const BVHRange &range, const vector<BVHRefer
         if (need_prim_time) {
           local_prim_time[index] = p_time[i][j];
         }
-        if (params.use_unaligned_nodes && !alignment_found) {
-          alignment_found = unaligned_heuristic.compute_aligned_space(p_ref[i][j], &aligned_space);
-        }
+      }
+      if (params.use_unaligned_nodes) {
+        alignment_found = unaligned_heuristic.compute_aligned_space(
+            &p_ref[i][0], num, &aligned_space);
       }
       LeafNode *leaf_node = new LeafNode(bounds[i], visibility[i], start_index, start_index + num);
       if (true) {
@@ -74,6 +74,11 @@ class BVHParams {
    */
   bool use_unaligned_nodes;
 
+  /* Store child bounds of aligned nodes quantized to 8 bits relative to the parent bounds.
+   * Only used for BVH8.
+   */
+  bool use_quantized_nodes;
+
   /* Split time range to this number of steps and create leaf node for each
    * of this time steps.
    *
@@ -116,6 +121,7 @@ class BVHParams {
     top_level = false;
     bvh_layout = BVH_LAYOUT_BVH2;
     use_unaligned_nodes = false;
+    use_quantized_nodes = false;
 
     num_motion_curve_steps = 0;
     num_motion_triangle_steps = 0;
@@ -311,6 +317,39 @@ struct BVHSpatialStorage {
   vector<BVHReference> new_references;
 };
 
+/* BVH Build Statistics
+ *
+ * Timing and size of a single BVH build, gathered by the builder and reported
+ * as part of the render statistics.
+ */
+struct BVHBuildStats {
+  /* Time spent on creating primitive references. */
+  double references_time;
+  /* Time spent on building the binary tree. */
+  double build_time;
+  /* Time spent on packing the tree for the device. */
+  double pack_time;
+
+  size_t num_references;
+  size_t num_nodes;
+  size_t num_leaf_nodes;
+
+  BVHBuildStats()
+      : references_time(0.0),
+        build_time(0.0),
+        pack_time(0.0),
+        num_references(0),
+        num_nodes(0),
+        num_leaf_nodes(0)
+  {
+  }
+
+  double total_time() const
+  {
+    return references_time + build_time + pack_time;
+  }
+};
+
 CCL_NAMESPACE_END
 
 #endif /* __BVH_PARAMS_H__ */
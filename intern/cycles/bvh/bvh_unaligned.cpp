@@ -34,55 +34,87 @@ BVHUnaligned::BVHUnaligned(const vector<Object *> &objects) : objects_(objects)
 Transform BVHUnaligned::compute_aligned_space(const BVHObjectBinning &range,
                                               const BVHReference *references) const
 {
-  for (int i = range.start(); i < range.end(); ++i) {
-    const BVHReference &ref = references[i];
-    Transform aligned_space;
-    /* Use first primitive which defines correct direction to define
-     * the orientation space.
-     */
-    if (compute_aligned_space(ref, &aligned_space)) {
-      return aligned_space;
-    }
-  }
-  return transform_identity();
+  Transform aligned_space;
+  compute_aligned_space(references + range.start(), range.size(), &aligned_space);
+  return aligned_space;
 }
 
 Transform BVHUnaligned::compute_aligned_space(const BVHRange &range,
                                               const BVHReference *references) const
 {
-  for (int i = range.start(); i < range.end(); ++i) {
-    const BVHReference &ref = references[i];
-    Transform aligned_space;
-    /* Use first primitive which defines correct direction to define
-     * the orientation space.
-     */
-    if (compute_aligned_space(ref, &aligned_space)) {
-      return aligned_space;
+  Transform aligned_space;
+  compute_aligned_space(references + range.start(), range.size(), &aligned_space);
+  return aligned_space;
+}
+
+bool BVHUnaligned::compute_aligned_space(const BVHReference &ref, Transform *aligned_space) const
+{
+  float3 axis;
+  float length;
+  if (compute_segment_axis(ref, &axis, &length)) {
+    *aligned_space = make_transform_frame(axis);
+    return true;
+  }
+  *aligned_space = transform_identity();
+  return false;
+}
+
+bool BVHUnaligned::compute_aligned_space(const BVHReference *references,
+                                         int num,
+                                         Transform *aligned_space) const
+{
+  /* Align with the length weighted average direction of the curve segments, which gives
+   * tighter bounds than the direction of a single segment for bent strands and groups of
+   * strands. Segments pointing away from the first one are flipped, so that segments along
+   * the same line do not cancel out. */
+  float3 first_axis = make_float3(0.0f, 0.0f, 0.0f);
+  float3 sum_axis = make_float3(0.0f, 0.0f, 0.0f);
+  float sum_length = 0.0f;
+  bool found = false;
+  for (int i = 0; i < num; ++i) {
+    float3 axis;
+    float length;
+    if (!compute_segment_axis(references[i], &axis, &length)) {
+      continue;
+    }
+    if (!found) {
+      first_axis = axis;
+      found = true;
     }
+    sum_axis += (dot(axis, first_axis) < 0.0f) ? -length * axis : length * axis;
+    sum_length += length;
+  }
+
+  if (!found) {
+    *aligned_space = transform_identity();
+    return false;
   }
-  return transform_identity();
+
+  float sum_axis_length;
+  const float3 axis = normalize_len(sum_axis, &sum_axis_length);
+  /* Fall back to the first segment when directions are spread too evenly to average. */
+  *aligned_space = make_transform_frame((sum_axis_length > 1e-3f * sum_length) ? axis :
+                                                                                  first_axis);
+  return true;
 }
 
-bool BVHUnaligned::compute_aligned_space(const BVHReference &ref, Transform *aligned_space) const
+bool BVHUnaligned::compute_segment_axis(const BVHReference &ref,
+                                        float3 *axis,
+                                        float *length) const
 {
-  const Object *object = objects_[ref.prim_object()];
   const int packed_type = ref.prim_type();
   const int type = (packed_type & PRIMITIVE_ALL);
   if (type & PRIMITIVE_CURVE) {
+    const Object *object = objects_[ref.prim_object()];
     const int curve_index = ref.prim_index();
     const int segment = PRIMITIVE_UNPACK_SEGMENT(packed_type);
     const Hair *hair = static_cast<const Hair *>(object->geometry);
     const Hair::Curve &curve = hair->get_curve(curve_index);
     const int key = curve.first_key + segment;
     const float3 v1 = hair->curve_keys[key], v2 = hair->curve_keys[key + 1];
-    float length;
-    const float3 axis = normalize_len(v2 - v1, &length);
-    if (length > 1e-6f) {
-      *aligned_space = make_transform_frame(axis);
-      return true;
-    }
+    *axis = normalize_len(v2 - v1, length);
+    return (*length > 1e-6f);
   }
-  *aligned_space = transform_identity();
   return false;
 }
 
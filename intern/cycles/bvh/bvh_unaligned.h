@@ -17,6 +17,7 @@
 #ifndef __BVH_UNALIGNED_H__
 #define __BVH_UNALIGNED_H__
 
+#include "util/util_types.h"
 #include "util/util_vector.h"
 
 CCL_NAMESPACE_BEGIN
@@ -44,6 +45,14 @@ class BVHUnaligned {
    */
   bool compute_aligned_space(const BVHReference &ref, Transform *aligned_space) const;
 
+  /* Calculate alignment for the oriented node for an array of references.
+   *
+   * Return true when space was calculated successfully.
+   */
+  bool compute_aligned_space(const BVHReference *references,
+                             int num,
+                             Transform *aligned_space) const;
+
   /* Calculate primitive's bounding box in given space. */
   BoundBox compute_aligned_prim_boundbox(const BVHReference &prim,
                                          const Transform &aligned_space) const;
@@ -64,6 +73,12 @@ class BVHUnaligned {
   static Transform compute_node_transform(const BoundBox &bounds, const Transform &aligned_space);
 
  protected:
+  /* Calculate direction and length of a curve segment reference.
+   *
+   * Return false for other primitives and degenerate segments.
+   */
+  bool compute_segment_axis(const BVHReference &ref, float3 *axis, float *length) const;
+
   /* List of objects BVH is being created for. */
   const vector<Object *> &objects_;
 };
@@ -68,6 +68,7 @@ DenoisingTask::~DenoisingTask()
   storage.rank.free();
   buffer.mem.free();
   buffer.temporary_mem.free();
+  buffer.temporary_color.free();
   tile_info_mem.free();
 }
 
@@ -135,8 +136,10 @@ void DenoisingTask::setup_denoising_buffer()
   else {
     num_layers = 3;
   }
-  /* Allocate two layers per shift as well as one for the weight accumulation. */
-  buffer.temporary_mem.alloc_to_device(num_layers * buffer.pass_stride);
+  /* Allocate two layers per shift as well as one for the weight accumulation.
+   * The same task is used for all tiles of a device thread, so only grow the buffers and keep
+   * them around instead of reallocating for every tile size. */
+  buffer.temporary_mem.alloc_to_device(num_layers * buffer.pass_stride, false);
 }
 
 void DenoisingTask::prefilter_shadowing()
@@ -213,7 +216,7 @@ void DenoisingTask::prefilter_color()
   int variance_to[] = {11, 12, 13};
   int num_color_passes = 3;
 
-  device_only_memory<float> temporary_color(device, "denoising temporary color");
+  device_only_memory<float> &temporary_color = buffer.temporary_color;
   temporary_color.alloc_to_device(6 * buffer.pass_stride, false);
 
   for (int pass = 0; pass < num_color_passes; pass++) {
@@ -165,13 +165,17 @@ class DenoisingTask {
     int frame_stride;
     device_only_memory<float> mem;
     device_only_memory<float> temporary_mem;
+    /* Unfiltered color passes, kept across tiles like the other buffers. */
+    device_only_memory<float> temporary_color;
     bool use_time;
     bool use_intensity;
 
     bool gpu_temporary_mem;
 
     DenoiseBuffers(Device *device)
-        : mem(device, "denoising pixel buffer"), temporary_mem(device, "denoising temporary mem")
+        : mem(device, "denoising pixel buffer"),
+          temporary_mem(device, "denoising temporary mem"),
+          temporary_color(device, "denoising temporary color")
     {
     }
   } buffer;
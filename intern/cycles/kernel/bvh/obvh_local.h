@@ -122,7 +122,8 @@ ccl_device bool BVH_FUNCTION_FULL_NAME(OBVH)(KernelGlobals *kg,
           else
 #endif
           {
-            cnodes = kernel_tex_fetch_avxf(__bvh_nodes, node_addr + 14);
+            const bool is_quantized = (__float_as_uint(inodes.x) & PATH_RAY_NODE_QUANTIZED) != 0;
+            cnodes = kernel_tex_fetch_avxf(__bvh_nodes, node_addr + (is_quantized ? 6 : 14));
           }
 
           /* One child is hit, continue with that child. */
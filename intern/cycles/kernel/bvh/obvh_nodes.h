@@ -230,6 +230,63 @@ ccl_device_inline void obvh_stack_sort(OBVHStackItem *ccl_restrict s1,
   }
 }
 
+/* Quantized axis-aligned nodes intersection
+ *
+ * Child bounds are stored as 8 bit offsets from the node origin, one plane of 8 children
+ * per 8 bytes starting at node_addr + 3, in the same plane order as regular aligned nodes.
+ */
+
+#ifdef __KERNEL_AVX2__
+ccl_device_inline avxf obvh_quantized_node_plane(KernelGlobals *ccl_restrict kg,
+                                                 const int node_addr,
+                                                 const int plane,
+                                                 const float origin,
+                                                 const float scale)
+{
+  const uchar *data = (const uchar *)&kernel_tex_fetch(__bvh_nodes, node_addr + 3) + plane * 8;
+  const __m256i q = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)data));
+  return madd(avxf(_mm256_cvtepi32_ps(q)), avxf(scale), avxf(origin));
+}
+
+ccl_device_inline int obvh_quantized_node_intersect(KernelGlobals *ccl_restrict kg,
+                                                    const avxf &isect_near,
+                                                    const avxf &isect_far,
+                                                    const avx3f &org_idir,
+                                                    const avx3f &idir,
+                                                    const int near_x,
+                                                    const int near_y,
+                                                    const int near_z,
+                                                    const int far_x,
+                                                    const int far_y,
+                                                    const int far_z,
+                                                    const int node_addr,
+                                                    avxf *ccl_restrict dist)
+{
+  const float4 origin = kernel_tex_fetch(__bvh_nodes, node_addr + 1);
+  const float4 scale = kernel_tex_fetch(__bvh_nodes, node_addr + 2);
+
+  const avxf tnear_x = msub(
+      obvh_quantized_node_plane(kg, node_addr, near_x, origin.x, scale.x), idir.x, org_idir.x);
+  const avxf tnear_y = msub(
+      obvh_quantized_node_plane(kg, node_addr, near_y, origin.y, scale.y), idir.y, org_idir.y);
+  const avxf tnear_z = msub(
+      obvh_quantized_node_plane(kg, node_addr, near_z, origin.z, scale.z), idir.z, org_idir.z);
+  const avxf tfar_x = msub(
+      obvh_quantized_node_plane(kg, node_addr, far_x, origin.x, scale.x), idir.x, org_idir.x);
+  const avxf tfar_y = msub(
+      obvh_quantized_node_plane(kg, node_addr, far_y, origin.y, scale.y), idir.y, org_idir.y);
+  const avxf tfar_z = msub(
+      obvh_quantized_node_plane(kg, node_addr, far_z, origin.z, scale.z), idir.z, org_idir.z);
+
+  const avxf tnear = max4(tnear_x, tnear_y, tnear_z, isect_near);
+  const avxf tfar = min4(tfar_x, tfar_y, tfar_z, isect_far);
+  const avxb vmask = tnear <= tfar;
+  int mask = (int)movemask(vmask);
+  *dist = tnear;
+  return mask;
+}
+#endif
+
 /* Axis-aligned nodes intersection */
 
 ccl_device_inline int obvh_aligned_node_intersect(KernelGlobals *ccl_restrict kg,
@@ -252,6 +309,22 @@ ccl_device_inline int obvh_aligned_node_intersect(KernelGlobals *ccl_restrict kg
 {
   const int offset = node_addr + 2;
 #ifdef __KERNEL_AVX2__
+  if (__float_as_uint(kernel_tex_fetch(__bvh_nodes, node_addr).x) & PATH_RAY_NODE_QUANTIZED) {
+    return obvh_quantized_node_intersect(kg,
+                                         isect_near,
+                                         isect_far,
+                                         org_idir,
+                                         idir,
+                                         near_x,
+                                         near_y,
+                                         near_z,
+                                         far_x,
+                                         far_y,
+                                         far_z,
+                                         node_addr,
+                                         dist);
+  }
+
   const avxf tnear_x = msub(
       kernel_tex_fetch_avxf(__bvh_nodes, offset + near_x * 2), idir.x, org_idir.x);
   const avxf tnear_y = msub(
@@ -316,8 +316,14 @@ ccl_device bool BVH_FUNCTION_FULL_NAME(QBVH)(KernelGlobals *kg,
 #if BVH_FEATURE(BVH_HAIR)
             case PRIMITIVE_CURVE:
             case PRIMITIVE_MOTION_CURVE: {
+              const int prim_start = prim_addr;
+              int segments_mask = 0;
               for (; prim_addr < prim_addr2; prim_addr++) {
                 BVH_DEBUG_NEXT_INTERSECTION();
+                if (curve_intersect_segment_culled(
+                        kg, P, dir, isect->t, prim_start, prim_addr, prim_addr2, &segments_mask)) {
+                  continue;
+                }
                 const uint curve_type = kernel_tex_fetch(__prim_type, prim_addr);
                 kernel_assert((curve_type & PRIMITIVE_ALL) == (type & PRIMITIVE_ALL));
                 bool hit;
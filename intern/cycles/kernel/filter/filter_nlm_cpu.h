@@ -18,6 +18,10 @@ CCL_NAMESPACE_BEGIN
 
 #define load4_a(buf, ofs) (*((float4 *)((buf) + (ofs))))
 #define load4_u(buf, ofs) load_float4((buf) + (ofs))
+#ifdef __KERNEL_AVX__
+#  define load8_u(buf, ofs) avxf(_mm256_loadu_ps((buf) + (ofs)))
+#  define store8_u(buf, ofs, val) _mm256_storeu_ps((buf) + (ofs), (val).m256)
+#endif
 
 ccl_device_inline void kernel_filter_nlm_calc_difference(int dx,
                                                          int dy,
@@ -36,13 +40,42 @@ ccl_device_inline void kernel_filter_nlm_calc_difference(int dx,
   kernel_assert((stride % 4) == 0 && (channel_offset % 4) == 0);
 
   int aligned_lowx = rect.x & (~3);
+  int aligned_highx = round_up(rect.z, 4);
   const int numChannels = (channel_offset > 0) ? 3 : 1;
   const float4 channel_fac = make_float4(1.0f / numChannels);
 
   for (int y = rect.y; y < rect.w; y++) {
+    int x = aligned_lowx;
     int idx_p = y * stride + aligned_lowx;
     int idx_q = (y + dy) * stride + aligned_lowx + dx + frame_offset;
-    for (int x = aligned_lowx; x < rect.z; x += 4, idx_p += 4, idx_q += 4) {
+#ifdef __KERNEL_AVX__
+    /* Process eight pixels at once, the remainder is handled by the SSE loop below.
+     * Neither pointer is guaranteed to be 32 byte aligned, so use unaligned loads. */
+    const avxf channel_fac8 = avxf(1.0f / numChannels);
+    for (; x + 8 <= aligned_highx; x += 8, idx_p += 8, idx_q += 8) {
+      avxf diff = avxf(0.0f);
+      avxf scale_fac;
+      if (scale_image) {
+        scale_fac = min(max(load8_u(scale_image, idx_p) / load8_u(scale_image, idx_q),
+                            avxf(0.25f)),
+                        avxf(4.0f));
+      }
+      else {
+        scale_fac = avxf(1.0f);
+      }
+      for (int c = 0, chan_ofs = 0; c < numChannels; c++, chan_ofs += channel_offset) {
+        avxf color_p = load8_u(weight_image, idx_p + chan_ofs);
+        avxf color_q = scale_fac * load8_u(weight_image, idx_q + chan_ofs);
+        avxf cdiff = color_p - color_q;
+        avxf var_p = load8_u(variance_image, idx_p + chan_ofs);
+        avxf var_q = scale_fac * scale_fac * load8_u(variance_image, idx_q + chan_ofs);
+        diff = diff + (cdiff * cdiff - a * (var_p + min(var_p, var_q))) /
+                          (avxf(1e-8f) + k_2 * (var_p + var_q));
+      }
+      store8_u(difference_image, idx_p, diff * channel_fac8);
+    }
+#endif
+    for (; x < rect.z; x += 4, idx_p += 4, idx_q += 4) {
       float4 diff = make_float4(0.0f);
       float4 scale_fac;
       if (scale_image) {
@@ -72,6 +105,9 @@ ccl_device_inline void kernel_filter_nlm_blur(
     const float *ccl_restrict difference_image, float *out_image, int4 rect, int stride, int f)
 {
   int aligned_lowx = round_down(rect.x, 4);
+#ifdef __KERNEL_AVX__
+  int aligned_highx = round_up(rect.z, 4);
+#endif
   for (int y = rect.y; y < rect.w; y++) {
     const int low = max(rect.y, y - f);
     const int high = min(rect.w, y + f + 1);
@@ -79,7 +115,15 @@ ccl_device_inline void kernel_filter_nlm_blur(
       load4_a(out_image, y * stride + x) = make_float4(0.0f);
     }
     for (int y1 = low; y1 < high; y1++) {
-      for (int x = aligned_lowx; x < rect.z; x += 4) {
+      int x = aligned_lowx;
+#ifdef __KERNEL_AVX__
+      for (; x + 8 <= aligned_highx; x += 8) {
+        store8_u(out_image,
+                 y * stride + x,
+                 load8_u(out_image, y * stride + x) + load8_u(difference_image, y1 * stride + x));
+      }
+#endif
+      for (; x < rect.z; x += 4) {
         load4_a(out_image, y * stride + x) += load4_a(difference_image, y1 * stride + x);
       }
     }
@@ -158,11 +202,30 @@ ccl_device_inline void kernel_filter_nlm_update_output(int dx,
   int aligned_lowx = round_down(rect.x, 4);
   for (int y = rect.y; y < rect.w; y++) {
     for (int x = aligned_lowx; x < rect.z; x += 4) {
+      int idx_p = y * stride + x, idx_q = (y + dy) * stride + (x + dx);
+
+#ifdef __KERNEL_AVX__
+      /* Blocks of eight pixels that are fully inside the rect don't need masking. */
+      if (x >= rect.x && x + 8 <= rect.z) {
+        avxf weight = load8_u(temp_image, idx_p);
+        store8_u(accum_image, idx_p, load8_u(accum_image, idx_p) + weight);
+
+        avxf val = load8_u(image, idx_q);
+        if (channel_offset) {
+          val = val + load8_u(image, idx_q + channel_offset);
+          val = val + load8_u(image, idx_q + 2 * channel_offset);
+          val = val * (1.0f / 3.0f);
+        }
+
+        store8_u(out_image, idx_p, load8_u(out_image, idx_p) + weight * val);
+        x += 4;
+        continue;
+      }
+#endif
+
       int4 x4 = make_int4(x) + make_int4(0, 1, 2, 3);
       int4 active = (x4 >= make_int4(rect.x)) & (x4 < make_int4(rect.z));
 
-      int idx_p = y * stride + x, idx_q = (y + dy) * stride + (x + dx);
-
       float4 weight = load4_a(temp_image, idx_p);
       load4_a(accum_image, idx_p) += mask(active, weight);
 
@@ -250,5 +313,9 @@ ccl_device_inline void kernel_filter_nlm_normalize(float *out_image,
 
 #undef load4_a
 #undef load4_u
+#ifdef __KERNEL_AVX__
+#  undef load8_u
+#  undef store8_u
+#endif
 
 CCL_NAMESPACE_END
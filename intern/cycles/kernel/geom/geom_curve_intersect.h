@@ -23,8 +23,144 @@ ccl_device_inline ssef transform_point_T3(const ssef t[3], const ssef &a)
 {
   return madd(shuffle<0>(a), t[0], madd(shuffle<1>(a), t[1], shuffle<2>(a) * t[2]));
 }
+
+/* Number of curve segments of a BVH leaf that are culled together. */
+#    define CURVE_SEGMENTS_MASK_SIZE 4
+
+/* Conservative test of up to four curve segments at once, one segment per SIMD lane.
+ *
+ * Returns a bit mask of the segments that may be hit. Segments missing from the mask are
+ * rejected by the early tests of cardinal_curve_intersect() and curve_intersect() as well,
+ * so these only need to run for the remaining ones. Cardinal curves are tested with the
+ * bounds of their Bezier control points in ray space, line segments with the same bounding
+ * sphere as curve_intersect(). */
+ccl_device_forceinline int curve_intersect_segments_mask(KernelGlobals *kg,
+                                                         const float3 ccl_ref P,
+                                                         const float3 ccl_ref dir,
+                                                         float tmax,
+                                                         int prim_addr,
+                                                         int num_segments)
+{
+  const int segments_mask = (1 << num_segments) - 1;
+
+  /* Motion blurred keys are not known without interpolation, leave them to the full test. */
+  if (num_segments == 1 || !(kernel_tex_fetch(__prim_type, prim_addr) & PRIMITIVE_CURVE)) {
+    return segments_mask;
+  }
+
+  const bool is_cardinal = (kernel_data.curve.curveflags & CURVE_KN_INTERPOLATE);
+
+  /* Control points of the segments, the outer ones are only used for cardinal curves.
+   * Unused lanes repeat the first segment. */
+  ssef keys[4][CURVE_SEGMENTS_MASK_SIZE];
+  for (int i = 0; i < CURVE_SEGMENTS_MASK_SIZE; i++) {
+    const int curve_addr = prim_addr + ((i < num_segments) ? i : 0);
+    const int type = kernel_tex_fetch(__prim_type, curve_addr);
+    const int prim = kernel_tex_fetch(__prim_index, curve_addr);
+    const float4 v00 = kernel_tex_fetch(__curves, prim);
+    const int first_key = __float_as_int(v00.x);
+    const int k0 = first_key + PRIMITIVE_UNPACK_SEGMENT(type);
+    const int k1 = k0 + 1;
+
+    keys[1][i] = load4f(&kg->__curve_keys.data[k0].x);
+    keys[2][i] = load4f(&kg->__curve_keys.data[k1].x);
+    if (is_cardinal) {
+      const int ka = max(k0 - 1, first_key);
+      const int kb = min(k1 + 1, first_key + __float_as_int(v00.y) - 1);
+      keys[0][i] = load4f(&kg->__curve_keys.data[ka].x);
+      keys[3][i] = load4f(&kg->__curve_keys.data[kb].x);
+    }
+  }
+
+  /* Transpose to one coordinate of all segments per vector, relative to the ray origin. */
+  ssef x[4], y[4], z[4], r[4];
+  const ssef Px(P.x), Py(P.y), Pz(P.z);
+  for (int j = is_cardinal ? 0 : 1; j < (is_cardinal ? 4 : 3); j++) {
+    transpose(keys[j][0], keys[j][1], keys[j][2], keys[j][3], x[j], y[j], z[j], r[j]);
+    x[j] = x[j] - Px;
+    y[j] = y[j] - Py;
+    z[j] = z[j] - Pz;
+  }
+
+  /* Slightly enlarged radius, so rounding differences with the full test do not cull hits. */
+  const ssef radius = max(r[1], r[2]) * ssef(1.0f + 1e-4f);
+  const ssef Dx(dir.x), Dy(dir.y), Dz(dir.z);
+  sseb reject;
+
+  if (is_cardinal) {
+    /* Same ray space transform as cardinal_curve_intersect(). */
+    const float d = sqrtf(dir.x * dir.x + dir.z * dir.z);
+    const ssef h00(dir.z / d), h02(-dir.x / d);
+    const ssef h10(-dir.x * dir.y / d), h11(d), h12(-dir.y * dir.z / d);
+
+    ssef qx[4], qy[4], qz[4];
+    for (int j = 0; j < 4; j++) {
+      qx[j] = madd(h00, x[j], h02 * z[j]);
+      qy[j] = madd(h10, x[j], madd(h11, y[j], h12 * z[j]));
+      qz[j] = madd(Dx, x[j], madd(Dy, y[j], Dz * z[j]));
+    }
+
+    /* The curve is contained in the convex hull of its Bezier control points. */
+    const ssef fc(0.71f / 3.0f);
+    const ssef bx1 = madd(fc, qx[2] - qx[0], qx[1]), bx2 = nmadd(fc, qx[3] - qx[1], qx[2]);
+    const ssef by1 = madd(fc, qy[2] - qy[0], qy[1]), by2 = nmadd(fc, qy[3] - qy[1], qy[2]);
+    const ssef bz1 = madd(fc, qz[2] - qz[0], qz[1]), bz2 = nmadd(fc, qz[3] - qz[1], qz[2]);
+
+    const ssef xmin = min(min(qx[1], qx[2]), min(bx1, bx2));
+    const ssef xmax = max(max(qx[1], qx[2]), max(bx1, bx2));
+    const ssef ymin = min(min(qy[1], qy[2]), min(by1, by2));
+    const ssef ymax = max(max(qy[1], qy[2]), max(by1, by2));
+    const ssef zmin = min(min(qz[1], qz[2]), min(bz1, bz2));
+    const ssef zmax = max(max(qz[1], qz[2]), max(bz1, bz2));
+
+    reject = (xmin > radius) | (xmax < -radius) | (ymin > radius) | (ymax < -radius) |
+             (zmin - radius > ssef(tmax)) | (zmax + radius < ssef(0.0f));
+  }
+  else {
+    /* Bounding sphere around the segment midpoint, ignoring the ray extent. */
+    const ssef cx = (x[1] + x[2]) * ssef(-0.5f);
+    const ssef cy = (y[1] + y[2]) * ssef(-0.5f);
+    const ssef cz = (z[1] + z[2]) * ssef(-0.5f);
+    const ssef b_tmp = madd(Dx, cx, madd(Dy, cy, Dz * cz));
+    const ssef dx = nmadd(b_tmp, Dx, cx), dy = nmadd(b_tmp, Dy, cy), dz = nmadd(b_tmp, Dz, cz);
+    const ssef b = madd(Dx, dx, madd(Dy, dy, Dz * dz));
+
+    const ssef lx = x[2] - x[1], ly = y[2] - y[1], lz = z[2] - z[1];
+    const ssef l = mm_sqrt(madd(lx, lx, madd(ly, ly, lz * lz)));
+    const ssef sp_r = madd(ssef(0.5f + 1e-4f), l, radius);
+
+    const ssef sdisc = madd(b, b, msub(sp_r, sp_r, madd(dx, dx, madd(dy, dy, dz * dz))));
+    reject = (sdisc < ssef(0.0f));
+  }
+
+  return segments_mask & ~(int)movemask(reject);
+}
 #  endif
 
+/* Whether the curve segment at prim_addr, in the leaf starting at prim_start and ending
+ * before prim_end, is culled by testing the segments together. The result for a group of
+ * segments is computed when the first one is reached and kept in segments_mask. */
+ccl_device_forceinline bool curve_intersect_segment_culled(KernelGlobals *kg,
+                                                           const float3 ccl_ref P,
+                                                           const float3 ccl_ref dir,
+                                                           float tmax,
+                                                           int prim_start,
+                                                           int prim_addr,
+                                                           int prim_end,
+                                                           int *segments_mask)
+{
+#  ifdef __KERNEL_SSE2__
+  const int i = (prim_addr - prim_start) & (CURVE_SEGMENTS_MASK_SIZE - 1);
+  if (i == 0) {
+    *segments_mask = curve_intersect_segments_mask(
+        kg, P, dir, tmax, prim_addr, min(prim_end - prim_addr, CURVE_SEGMENTS_MASK_SIZE));
+  }
+  return !(*segments_mask & (1 << i));
+#  else
+  return false;
+#  endif
+}
+
 /* On CPU pass P and dir by reference to aligned vector. */
 ccl_device_forceinline bool cardinal_curve_intersect(KernelGlobals *kg,
                                                      Intersection *isect,
@@ -222,6 +222,9 @@ ccl_device_noinline_cpu float3 indirect_primitive_emission(
     /* multiple importance sampling, get triangle light pdf,
      * and compute weight with respect to BSDF pdf */
     float pdf = triangle_light_pdf(kg, sd, t);
+    if (kernel_data.integrator.use_light_tree) {
+      pdf *= light_tree_triangle_pdf_scale(kg, sd->object, sd->prim, sd->P + sd->I * t);
+    }
     float mis_weight = power_heuristic(bsdf_pdf, pdf);
 
     return L * mis_weight;
@@ -275,6 +278,9 @@ ccl_device_noinline_cpu void indirect_lamp_emission(KernelGlobals *kg,
     if (!(state->flag & PATH_RAY_MIS_SKIP)) {
       /* multiple importance sampling, get regular light pdf,
        * and compute weight with respect to BSDF pdf */
+      if (kernel_data.integrator.use_light_tree) {
+        ls.pdf *= light_tree_lamp_pdf_scale(kg, lamp, ray->P);
+      }
       float mis_weight = power_heuristic(state->ray_pdf, ls.pdf);
       lamp_L *= mis_weight;
     }
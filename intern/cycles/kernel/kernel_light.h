@@ -1110,6 +1110,176 @@ ccl_device int light_distribution_sample(KernelGlobals *kg, float *randu)
   return index;
 }
 
+/* Light Tree */
+
+/* Importance of a light tree node for shading point P, following "Importance Sampling of Many
+ * Lights with Adaptive Tree Splitting" by Conty Estevez and Kulla. The receiver normal is not
+ * taken into account, so the same importance can be evaluated from the ray origin for multiple
+ * importance sampling. */
+ccl_device float light_tree_node_importance(KernelGlobals *kg, int node_index, float3 P)
+{
+  const ccl_global KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes, node_index);
+  if (knode->energy == 0.0f) {
+    return 0.0f;
+  }
+
+  const float3 bbox_min = make_float3(knode->bbox_min[0], knode->bbox_min[1], knode->bbox_min[2]);
+  const float3 bbox_max = make_float3(knode->bbox_max[0], knode->bbox_max[1], knode->bbox_max[2]);
+  const float3 axis = make_float3(knode->axis[0], knode->axis[1], knode->axis[2]);
+  const float3 centroid = 0.5f * (bbox_min + bbox_max);
+  const float radius_squared = 0.25f * len_squared(bbox_max - bbox_min);
+
+  const float3 to_point = P - centroid;
+  const float distance_squared = len_squared(to_point);
+  const float distance = sqrtf(distance_squared);
+
+  /* Angle between the node axis and direction to the shading point, reduced by the angular
+   * extent of the node bounds and the spread of emitter normals. */
+  float theta_u = M_PI_F;
+  if (distance_squared > radius_squared) {
+    theta_u = safe_asinf(sqrtf(radius_squared) / distance);
+  }
+  const float theta = (distance > 0.0f) ? safe_acosf(dot(axis, to_point) / distance) : 0.0f;
+  const float theta_prime = max(theta - knode->theta_o - theta_u, 0.0f);
+  if (theta_prime >= knode->theta_e) {
+    return 0.0f;
+  }
+
+  /* Clamp distance to the node size, to avoid singularity close to or inside of the node. */
+  return knode->energy * cosf(theta_prime) /
+         max(distance_squared, max(radius_squared, 1e-8f));
+}
+
+/* Pick an emitter by traversing the light tree. Returns light distribution index of the emitter,
+ * randu is rescaled for reuse, and pdf_scale is the ratio of the emitter selection probability
+ * to the probability of the flat light distribution, which the individual light sampling
+ * functions assume. */
+ccl_device int light_tree_sample(KernelGlobals *kg, float3 P, float *randu, float *pdf_scale)
+{
+  const int num_emitters = kernel_data.integrator.num_light_tree_emitters;
+  const float tree_pdf = kernel_data.integrator.light_tree_pdf;
+  float r = *randu;
+
+  if (r >= tree_pdf) {
+    /* Distant and background lights are picked uniformly, with the same probability as in the
+     * flat distribution. */
+    const int num_distant = kernel_data.integrator.num_light_tree_distant;
+    r = (r - tree_pdf) / (1.0f - tree_pdf) * num_distant;
+    const int distant = min((int)r, num_distant - 1);
+    *randu = r - distant;
+    *pdf_scale = 1.0f;
+    return kernel_tex_fetch(__light_tree_emitters, num_emitters + distant).distribution_index;
+  }
+
+  r /= tree_pdf;
+  float pdf = tree_pdf;
+
+  int node_index = 0;
+  const ccl_global KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes, node_index);
+  while (knode->num_emitters == 0) {
+    const int left_index = node_index + 1;
+    const int right_index = knode->child_index;
+    const float importance_left = light_tree_node_importance(kg, left_index, P);
+    const float importance_right = light_tree_node_importance(kg, right_index, P);
+    const float importance_total = importance_left + importance_right;
+    if (importance_total == 0.0f) {
+      return -1;
+    }
+
+    const float p_left = importance_left / importance_total;
+    if (r < p_left) {
+      node_index = left_index;
+      r = r / p_left;
+      pdf *= p_left;
+    }
+    else {
+      node_index = right_index;
+      r = (r - p_left) / (1.0f - p_left);
+      pdf *= importance_right / importance_total;
+    }
+    knode = &kernel_tex_fetch(__light_tree_nodes, node_index);
+  }
+
+  /* Pick emitter within the leaf proportional to energy. */
+  int emitter_index = knode->first_emitter;
+  if (knode->num_emitters > 1) {
+    float cdf = 0.0f;
+    for (int i = 0; i < knode->num_emitters; i++) {
+      emitter_index = knode->first_emitter + i;
+      const float p = (knode->energy > 0.0f) ?
+                          kernel_tex_fetch(__light_tree_emitters, emitter_index).energy /
+                              knode->energy :
+                          1.0f / knode->num_emitters;
+      if (r < cdf + p || i == knode->num_emitters - 1) {
+        r = (p > 0.0f) ? (r - cdf) / p : 0.0f;
+        pdf *= p;
+        break;
+      }
+      cdf += p;
+    }
+  }
+
+  const ccl_global KernelLightTreeEmitter *kemitter = &kernel_tex_fetch(__light_tree_emitters,
+                                                                        emitter_index);
+  *randu = r;
+  *pdf_scale = pdf / kemitter->pdf_flat;
+  return kemitter->distribution_index;
+}
+
+/* Same as the pdf_scale of light_tree_sample(), for the given emitter. */
+ccl_device float light_tree_emitter_pdf_scale(KernelGlobals *kg, int emitter_index, float3 P)
+{
+  const ccl_global KernelLightTreeEmitter *kemitter = &kernel_tex_fetch(__light_tree_emitters,
+                                                                        emitter_index);
+  int node_index = kemitter->node_index;
+  const ccl_global KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes, node_index);
+
+  float pdf = 1.0f;
+  if (knode->num_emitters > 1) {
+    pdf = (knode->energy > 0.0f) ? kemitter->energy / knode->energy : 1.0f / knode->num_emitters;
+  }
+
+  while (knode->parent_index != -1) {
+    const int parent_index = knode->parent_index;
+    const ccl_global KernelLightTreeNode *kparent = &kernel_tex_fetch(__light_tree_nodes,
+                                                                      parent_index);
+    const int left_index = parent_index + 1;
+    const int right_index = kparent->child_index;
+    const float importance_left = light_tree_node_importance(kg, left_index, P);
+    const float importance_right = light_tree_node_importance(kg, right_index, P);
+    const float importance_total = importance_left + importance_right;
+    if (importance_total == 0.0f) {
+      return 0.0f;
+    }
+
+    pdf *= ((node_index == left_index) ? importance_left : importance_right) / importance_total;
+    node_index = parent_index;
+    knode = kparent;
+  }
+
+  return pdf * kernel_data.integrator.light_tree_pdf / kemitter->pdf_flat;
+}
+
+ccl_device float light_tree_lamp_pdf_scale(KernelGlobals *kg, int lamp, float3 P)
+{
+  /* Distant and background lights are not in the tree and keep their regular pdf. */
+  const int emitter_index = kernel_tex_fetch(__light_tree_lookup, lamp);
+  return (emitter_index != -1) ? light_tree_emitter_pdf_scale(kg, emitter_index, P) : 1.0f;
+}
+
+ccl_device float light_tree_triangle_pdf_scale(KernelGlobals *kg, int object, int prim, float3 P)
+{
+  const int object_lookup = kernel_data.integrator.num_all_lights + 2 * object;
+  const int triangles_offset = kernel_tex_fetch(__light_tree_lookup, object_lookup);
+  if (triangles_offset == -1) {
+    return 1.0f;
+  }
+  const int prim_offset = kernel_tex_fetch(__light_tree_lookup, object_lookup + 1);
+  const int emitter_index = kernel_tex_fetch(__light_tree_lookup,
+                                             triangles_offset + prim - prim_offset);
+  return (emitter_index != -1) ? light_tree_emitter_pdf_scale(kg, emitter_index, P) : 1.0f;
+}
+
 /* Generic Light */
 
 ccl_device_inline bool light_select_reached_max_bounces(KernelGlobals *kg, int index, int bounce)
@@ -1126,9 +1296,20 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
                                       int bounce,
                                       LightSample *ls)
 {
+  float pdf_scale = 1.0f;
+
   if (lamp < 0) {
     /* sample index */
-    int index = light_distribution_sample(kg, &randu);
+    int index;
+    if (kernel_data.integrator.use_light_tree) {
+      index = light_tree_sample(kg, P, &randu, &pdf_scale);
+      if (index < 0) {
+        return false;
+      }
+    }
+    else {
+      index = light_distribution_sample(kg, &randu);
+    }
 
     /* fetch light data */
     const ccl_global KernelLightDistribution *kdistribution = &kernel_tex_fetch(
@@ -1141,6 +1322,7 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
 
       triangle_light_sample(kg, prim, object, randu, randv, time, ls, P);
       ls->shader |= shader_flag;
+      ls->pdf *= pdf_scale;
       return (ls->pdf > 0.0f);
     }
 
@@ -1151,7 +1333,12 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
     return false;
   }
 
-  return lamp_light_sample(kg, lamp, randu, randv, P, ls);
+  if (!lamp_light_sample(kg, lamp, randu, randv, P, ls)) {
+    return false;
+  }
+
+  ls->pdf *= pdf_scale;
+  return true;
 }
 
 ccl_device_inline int light_select_num_samples(KernelGlobals *kg, int index)
@@ -294,8 +294,8 @@ enum PathRayFlag {
                                  PATH_RAY_SHADOW_TRANSPARENT_NON_CATCHER),
   PATH_RAY_SHADOW = (PATH_RAY_SHADOW_OPAQUE | PATH_RAY_SHADOW_TRANSPARENT),
 
-  /* Unused, free to reuse. */
-  PATH_RAY_UNUSED = (1 << 11),
+  /* Special flag to tag quantized BVH nodes. */
+  PATH_RAY_NODE_QUANTIZED = (1 << 11),
 
   /* Ray visibility for volume scattering. */
   PATH_RAY_VOLUME_SCATTER = (1 << 12),
@@ -1306,6 +1306,12 @@ typedef struct KernelIntegrator {
   int pdf_background_res_y;
   float light_inv_rr_threshold;
 
+  /* light tree */
+  int use_light_tree;
+  int num_light_tree_emitters;
+  int num_light_tree_distant;
+  float light_tree_pdf;
+
   /* light portals */
   float portal_pdf;
   int num_portals;
@@ -1553,6 +1559,35 @@ typedef struct KernelLightDistribution {
 } KernelLightDistribution;
 static_assert_align(KernelLightDistribution, 16);
 
+/* Light tree node, stored in depth-first order. The first child of an inner node immediately
+ * follows it, the second child is at child_index. Leaf nodes reference a range of emitters.
+ *
+ * Orientation bounds: normals of all emitters are within theta_o of the axis, and every emitter
+ * radiates within theta_e of its normal. */
+typedef struct KernelLightTreeNode {
+  float bbox_min[3];
+  float energy;
+  float bbox_max[3];
+  float theta_o;
+  float axis[3];
+  float theta_e;
+  int child_index;
+  int first_emitter;
+  int num_emitters;
+  int parent_index;
+} KernelLightTreeNode;
+static_assert_align(KernelLightTreeNode, 16);
+
+typedef struct KernelLightTreeEmitter {
+  /* Estimated emitted power, used to pick emitter within a leaf. */
+  float energy;
+  /* Probability to pick this emitter from the regular light distribution. */
+  float pdf_flat;
+  int distribution_index;
+  int node_index;
+} KernelLightTreeEmitter;
+static_assert_align(KernelLightTreeEmitter, 16);
+
 typedef struct KernelParticle {
   int index;
   float age;
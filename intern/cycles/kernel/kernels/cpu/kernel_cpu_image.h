@@ -17,6 +17,9 @@
 #ifndef __KERNEL_CPU_IMAGE_H__
 #define __KERNEL_CPU_IMAGE_H__
 
+#include "util/util_sparse_grid.h"
+#include "util/util_texture_cache_lookup.h"
+
 CCL_NAMESPACE_BEGIN
 
 /* Make template functions private so symbols don't conflict between kernels with different
@@ -253,6 +256,28 @@ template<typename T> struct TextureInterpolator {
 
   /* ********  3D interpolation ******** */
 
+  static ccl_always_inline float4 read_3d(const TextureInfo &info, int x, int y, int z)
+  {
+    const T *data = (const T *)info.data;
+    const size_t width = info.width;
+    const size_t height = info.height;
+
+    if (info.use_sparse_grid) {
+      /* Look up the tile in the index, empty tiles read as zero. */
+      const int *tile_index = (const int *)data;
+      const int tile = tile_index[sparse_grid_tile(x, y, z, width, height)];
+      if (tile == SPARSE_TILE_EMPTY) {
+        return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+      }
+
+      const size_t num_tiles = sparse_grid_num_tiles(width, height, info.depth);
+      const T *voxels = data + sparse_grid_index_texels(num_tiles, sizeof(T));
+      return read(voxels[((size_t)tile) * SPARSE_TILE_VOXELS + sparse_grid_tile_voxel(x, y, z)]);
+    }
+
+    return read(data[x + y * width + z * width * height]);
+  }
+
   static ccl_always_inline float4 interp_3d_closest(const TextureInfo &info,
                                                     float x,
                                                     float y,
@@ -288,8 +313,7 @@ template<typename T> struct TextureInterpolator {
         return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
     }
 
-    const T *data = (const T *)info.data;
-    return read(data[ix + iy * width + iz * width * height]);
+    return read_3d(info, ix, iy, iz);
   }
 
   static ccl_always_inline float4 interp_3d_linear(const TextureInfo &info,
@@ -336,19 +360,17 @@ template<typename T> struct TextureInterpolator {
         return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
     }
 
-    const T *data = (const T *)info.data;
     float4 r;
 
-    r = (1.0f - tz) * (1.0f - ty) * (1.0f - tx) *
-        read(data[ix + iy * width + iz * width * height]);
-    r += (1.0f - tz) * (1.0f - ty) * tx * read(data[nix + iy * width + iz * width * height]);
-    r += (1.0f - tz) * ty * (1.0f - tx) * read(data[ix + niy * width + iz * width * height]);
-    r += (1.0f - tz) * ty * tx * read(data[nix + niy * width + iz * width * height]);
+    r = (1.0f - tz) * (1.0f - ty) * (1.0f - tx) * read_3d(info, ix, iy, iz);
+    r += (1.0f - tz) * (1.0f - ty) * tx * read_3d(info, nix, iy, iz);
+    r += (1.0f - tz) * ty * (1.0f - tx) * read_3d(info, ix, niy, iz);
+    r += (1.0f - tz) * ty * tx * read_3d(info, nix, niy, iz);
 
-    r += tz * (1.0f - ty) * (1.0f - tx) * read(data[ix + iy * width + niz * width * height]);
-    r += tz * (1.0f - ty) * tx * read(data[nix + iy * width + niz * width * height]);
-    r += tz * ty * (1.0f - tx) * read(data[ix + niy * width + niz * width * height]);
-    r += tz * ty * tx * read(data[nix + niy * width + niz * width * height]);
+    r += tz * (1.0f - ty) * (1.0f - tx) * read_3d(info, ix, iy, niz);
+    r += tz * (1.0f - ty) * tx * read_3d(info, nix, iy, niz);
+    r += tz * ty * (1.0f - tx) * read_3d(info, ix, niy, niz);
+    r += tz * ty * tx * read_3d(info, nix, niy, niz);
 
     return r;
   }
@@ -424,15 +446,14 @@ template<typename T> struct TextureInterpolator {
     }
 
     const int xc[4] = {pix, ix, nix, nnix};
-    const int yc[4] = {width * piy, width * iy, width * niy, width * nniy};
-    const int zc[4] = {
-        width * height * piz, width * height * iz, width * height * niz, width * height * nniz};
+    const int yc[4] = {piy, iy, niy, nniy};
+    const int zc[4] = {piz, iz, niz, nniz};
     float u[4], v[4], w[4];
 
     /* Some helper macro to keep code reasonable size,
      * let compiler to inline all the matrix multiplications.
      */
-#define DATA(x, y, z) (read(data[xc[x] + yc[y] + zc[z]]))
+#define DATA(x, y, z) (read_3d(info, xc[x], yc[y], zc[z]))
 #define COL_TERM(col, row) \
   (v[col] * (u[0] * DATA(0, col, row) + u[1] * DATA(1, col, row) + u[2] * DATA(2, col, row) + \
              u[3] * DATA(3, col, row)))
@@ -444,7 +465,6 @@ template<typename T> struct TextureInterpolator {
     SET_CUBIC_SPLINE_WEIGHTS(w, tz);
 
     /* Actual interpolation. */
-    const T *data = (const T *)info.data;
     return ROW_TERM(0) + ROW_TERM(1) + ROW_TERM(2) + ROW_TERM(3);
 
 #undef COL_TERM
@@ -474,6 +494,11 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, fl
 {
   const TextureInfo &info = kernel_tex_fetch(__texture_info, id);
 
+  if (info.use_texture_cache) {
+    return texture_cache_lookup(
+        (const TextureCacheTexture *)info.data, x, y, 0.0f, 0.0f, 0.0f, 0.0f);
+  }
+
   switch (info.data_type) {
     case IMAGE_DATA_TYPE_HALF:
       return TextureInterpolator<half>::interp(info, x, y);
@@ -498,6 +523,21 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, fl
   }
 }
 
+/* Lookup with texture coordinate differentials, used to pick the mip level for images
+ * in the texture cache. Fully loaded images have no mip levels and ignore them. */
+ccl_device float4 kernel_tex_image_interp_filtered(
+    KernelGlobals *kg, int id, float x, float y, float2 dx, float2 dy)
+{
+  const TextureInfo &info = kernel_tex_fetch(__texture_info, id);
+
+  if (info.use_texture_cache) {
+    return texture_cache_lookup(
+        (const TextureCacheTexture *)info.data, x, y, dx.x, dx.y, dy.x, dy.y);
+  }
+
+  return kernel_tex_image_interp(kg, id, x, y);
+}
+
 ccl_device float4 kernel_tex_image_interp_3d(KernelGlobals *kg,
                                              int id,
                                              float3 P,
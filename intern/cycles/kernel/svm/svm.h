@@ -227,8 +227,11 @@ ccl_device_noinline void svm_eval_nodes(KernelGlobals *kg,
   float stack[SVM_STACK_SIZE];
   int offset = sd->shader & SHADER_MASK;
 
+  PROFILING_SVM_INIT(kg);
+
   while (1) {
     uint4 node = read_node(kg, &offset);
+    PROFILING_SVM_NODE();
 
     switch (node.x) {
       case NODE_END:
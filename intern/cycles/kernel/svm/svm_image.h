@@ -16,14 +16,19 @@
 
 CCL_NAMESPACE_BEGIN
 
-ccl_device float4 svm_image_texture(KernelGlobals *kg, int id, float x, float y, uint flags)
+ccl_device float4 svm_image_texture_filtered(
+    KernelGlobals *kg, int id, float x, float y, float2 dx, float2 dy, uint flags)
 {
   if (id == -1) {
     return make_float4(
         TEX_IMAGE_MISSING_R, TEX_IMAGE_MISSING_G, TEX_IMAGE_MISSING_B, TEX_IMAGE_MISSING_A);
   }
 
+#ifdef __KERNEL_CPU__
+  float4 r = kernel_tex_image_interp_filtered(kg, id, x, y, dx, dy);
+#else
   float4 r = kernel_tex_image_interp(kg, id, x, y);
+#endif
   const float alpha = r.w;
 
   if ((flags & NODE_IMAGE_ALPHA_UNASSOCIATE) && alpha != 1.0f && alpha != 0.0f) {
@@ -38,6 +43,36 @@ ccl_device float4 svm_image_texture(KernelGlobals *kg, int id, float x, float y,
   return r;
 }
 
+ccl_device float4 svm_image_texture(KernelGlobals *kg, int id, float x, float y, uint flags)
+{
+  const float2 zero = make_float2(0.0f, 0.0f);
+  return svm_image_texture_filtered(kg, id, x, y, zero, zero, flags);
+}
+
+#ifdef __KERNEL_CPU__
+/* Differentials of the image texture coordinate, for mip level selection in the texture
+ * cache. Texture coordinate differentials are not tracked through the shader graph, so
+ * use those of the default UV map, which is what image textures use unless remapped. */
+ccl_device void svm_image_texture_differentials(KernelGlobals *kg,
+                                                ShaderData *sd,
+                                                int id,
+                                                float2 *dx,
+                                                float2 *dy)
+{
+  *dx = make_float2(0.0f, 0.0f);
+  *dy = make_float2(0.0f, 0.0f);
+
+  if (id == -1 || !kernel_tex_fetch(__texture_info, id).use_texture_cache) {
+    return;
+  }
+
+  const AttributeDescriptor desc = find_attribute(kg, sd, ATTR_STD_UV);
+  if (desc.offset != ATTR_STD_NOT_FOUND) {
+    primitive_surface_attribute_float2(kg, sd, desc, dx, dy);
+  }
+}
+#endif
+
 /* Remap coordnate from 0..1 box to -1..-1 */
 ccl_device_inline float3 texco_remap_square(float3 co)
 {
@@ -108,7 +143,15 @@ ccl_device void svm_node_tex_image(
     id = -num_nodes;
   }
 
-  float4 f = svm_image_texture(kg, id, tex_co.x, tex_co.y, flags);
+  float2 tex_co_dx = make_float2(0.0f, 0.0f), tex_co_dy = make_float2(0.0f, 0.0f);
+#ifdef __KERNEL_CPU__
+  if (node.w == NODE_IMAGE_PROJ_FLAT) {
+    svm_image_texture_differentials(kg, sd, id, &tex_co_dx, &tex_co_dy);
+  }
+#endif
+
+  float4 f = svm_image_texture_filtered(
+      kg, id, tex_co.x, tex_co.y, tex_co_dx, tex_co_dy, flags);
 
   if (stack_valid(out_offset))
     stack_store_float3(stack, out_offset, make_float3(f.x, f.y, f.z));
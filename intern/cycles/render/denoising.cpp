@@ -19,6 +19,7 @@
 #include "kernel/filter/filter_defines.h"
 
 #include "util/util_foreach.h"
+#include "util/util_logging.h"
 #include "util/util_map.h"
 #include "util/util_system.h"
 #include "util/util_time.h"
@@ -429,81 +430,114 @@ void DenoiseTask::create_task(DeviceTask &task)
 
 /* Denoiser Operations */
 
-bool DenoiseTask::load_input_pixels(int layer)
+bool DenoiseTask::cache_input_pixels(int cache_frame, int neighbor)
+{
+  if (denoiser->frame_cache.count(cache_frame)) {
+    return true;
+  }
+
+  /* Read the whole file once and extract all layers from it. */
+  array<float> neighbor_pixels;
+  if (neighbor >= 0 && !image.read_neighbor_image(neighbor, neighbor_pixels)) {
+    error = "Failed to read neighbor frame pixels";
+    return false;
+  }
+
+  size_t num_pixels = (size_t)image.width * (size_t)image.height;
+  map<string, array<float>> &cached_layers = denoiser->frame_cache[cache_frame];
+
+  foreach (const DenoiseImageLayer &image_layer, image.layers) {
+    array<float> &cached_pixels = cached_layers[image_layer.name];
+    cached_pixels.resize(num_pixels * INPUT_NUM_CHANNELS);
+
+    if (neighbor >= 0) {
+      image.read_neighbor_pixels(neighbor, image_layer, neighbor_pixels, cached_pixels.data());
+    }
+    else {
+      image.read_pixels(image_layer, cached_pixels.data());
+    }
+
+    preprocess_input_pixels(cached_pixels.data());
+  }
+
+  return true;
+}
+
+void DenoiseTask::preprocess_input_pixels(float *buffer_data)
 {
   int w = image.width;
   int h = image.height;
   int num_pixels = image.width * image.height;
-  int frame_stride = num_pixels * INPUT_NUM_CHANNELS;
 
-  /* Load center image */
-  DenoiseImageLayer &image_layer = image.layers[layer];
-
-  float *buffer_data = input_pixels.data();
-  image.read_pixels(image_layer, buffer_data);
-  buffer_data += frame_stride;
-
-  /* Load neighbor images */
-  for (int i = 0; i < image.in_neighbors.size(); i++) {
-    if (!image.read_neighbor_pixels(i, image_layer, buffer_data)) {
-      error = "Failed to read neighbor frame pixels";
-      return false;
+  /* Clamp */
+  if (denoiser->params.clamp_input) {
+    for (int i = 0; i < num_pixels * INPUT_NUM_CHANNELS; i++) {
+      buffer_data[i] = clamp(buffer_data[i], -1e8f, 1e8f);
     }
-    buffer_data += frame_stride;
   }
 
-  /* Preprocess */
-  buffer_data = input_pixels.data();
-  for (int neighbor = 0; neighbor < image.in_neighbors.size() + 1; neighbor++) {
-    /* Clamp */
-    if (denoiser->params.clamp_input) {
-      for (int i = 0; i < num_pixels * INPUT_NUM_CHANNELS; i++) {
-        buffer_data[i] = clamp(buffer_data[i], -1e8f, 1e8f);
+  /* Box blur */
+  int r = 5 * denoiser->params.radius;
+  float *data = buffer_data + 14;
+  array<float> temp(num_pixels);
+
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      int n = 0;
+      float sum = 0.0f;
+      for (int dx = max(x - r, 0); dx < min(x + r + 1, w); dx++, n++) {
+        sum += data[INPUT_NUM_CHANNELS * (y * w + dx)];
       }
+      temp[y * w + x] = sum / n;
     }
+  }
 
-    /* Box blur */
-    int r = 5 * denoiser->params.radius;
-    float *data = buffer_data + 14;
-    array<float> temp(num_pixels);
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      int n = 0;
+      float sum = 0.0f;
 
-    for (int y = 0; y < h; y++) {
-      for (int x = 0; x < w; x++) {
-        int n = 0;
-        float sum = 0.0f;
-        for (int dx = max(x - r, 0); dx < min(x + r + 1, w); dx++, n++) {
-          sum += data[INPUT_NUM_CHANNELS * (y * w + dx)];
-        }
-        temp[y * w + x] = sum / n;
+      for (int dy = max(y - r, 0); dy < min(y + r + 1, h); dy++, n++) {
+        sum += temp[dy * w + x];
       }
+
+      data[INPUT_NUM_CHANNELS * (y * w + x)] = sum / n;
     }
+  }
 
-    for (int y = 0; y < h; y++) {
-      for (int x = 0; x < w; x++) {
-        int n = 0;
-        float sum = 0.0f;
+  /* Highlight compression */
+  data = buffer_data + 8;
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      int idx = INPUT_NUM_CHANNELS * (y * w + x);
+      float3 color = make_float3(data[idx], data[idx + 1], data[idx + 2]);
+      color = color_highlight_compress(color, NULL);
+      data[idx] = color.x;
+      data[idx + 1] = color.y;
+      data[idx + 2] = color.z;
+    }
+  }
+}
 
-        for (int dy = max(y - r, 0); dy < min(y + r + 1, h); dy++, n++) {
-          sum += temp[dy * w + x];
-        }
+bool DenoiseTask::load_input_pixels(int layer)
+{
+  int num_pixels = image.width * image.height;
+  int frame_stride = num_pixels * INPUT_NUM_CHANNELS;
 
-        data[INPUT_NUM_CHANNELS * (y * w + x)] = sum / n;
-      }
-    }
+  /* Copy preprocessed center and neighbor frames from the cache. */
+  const string &layer_name = image.layers[layer].name;
+  float *buffer_data = input_pixels.data();
 
-    /* Highlight compression */
-    data = buffer_data + 8;
-    for (int y = 0; y < h; y++) {
-      for (int x = 0; x < w; x++) {
-        int idx = INPUT_NUM_CHANNELS * (y * w + x);
-        float3 color = make_float3(data[idx], data[idx + 1], data[idx + 2]);
-        color = color_highlight_compress(color, NULL);
-        data[idx] = color.x;
-        data[idx + 1] = color.y;
-        data[idx + 2] = color.z;
-      }
+  for (int i = 0; i < neighbor_frames.size() + 1; i++) {
+    int cache_frame = (i == 0) ? frame : neighbor_frames[i - 1];
+    map<string, array<float>> &cached_layers = denoiser->frame_cache[cache_frame];
+    map<string, array<float>>::iterator it = cached_layers.find(layer_name);
+    if (it == cached_layers.end()) {
+      error = "Neighbor frame misses denoising data passes: " + denoiser->input[cache_frame];
+      return false;
     }
 
+    memcpy(buffer_data, it->second.data(), sizeof(float) * frame_stride);
     buffer_data += frame_stride;
   }
 
@@ -522,7 +556,20 @@ bool DenoiseTask::load()
     return false;
   }
 
-  if (!image.load_neighbors(denoiser->input, neighbor_frames, error)) {
+  if (neighbor_frames.size() > DENOISE_MAX_FRAMES - 1) {
+    error = string_printf("Maximum number of neighbors (%d) exceeded\n", DENOISE_MAX_FRAMES - 1);
+    return false;
+  }
+
+  /* Only open neighbor frames that were not read for a previous frame. */
+  vector<int> uncached_frames;
+  foreach (int neighbor_frame, neighbor_frames) {
+    if (!denoiser->frame_cache.count(neighbor_frame)) {
+      uncached_frames.push_back(neighbor_frame);
+    }
+  }
+
+  if (!image.load_neighbors(denoiser->input, uncached_frames, error)) {
     return false;
   }
 
@@ -531,8 +578,17 @@ bool DenoiseTask::load()
     return false;
   }
 
+  if (!cache_input_pixels(frame, -1)) {
+    return false;
+  }
+  for (int neighbor = 0; neighbor < uncached_frames.size(); neighbor++) {
+    if (!cache_input_pixels(uncached_frames[neighbor], neighbor)) {
+      return false;
+    }
+  }
+
   /* Allocate device buffer. */
-  int num_frames = image.in_neighbors.size() + 1;
+  int num_frames = neighbor_frames.size() + 1;
   input_pixels.alloc(image.width * INPUT_NUM_CHANNELS, image.height * num_frames);
   input_pixels.zero_to_device();
 
@@ -683,18 +739,20 @@ void DenoiseImage::read_pixels(const DenoiseImageLayer &layer, float *input_pixe
   }
 }
 
-bool DenoiseImage::read_neighbor_pixels(int neighbor,
-                                        const DenoiseImageLayer &layer,
-                                        float *input_pixels)
+bool DenoiseImage::read_neighbor_image(int neighbor, array<float> &neighbor_pixels)
 {
-  /* Load pixels from neighboring frames, and copy them into device buffer
-   * with channels reshuffled. */
+  /* Read all channels at once, for the same reason as the center frame. */
   size_t num_pixels = (size_t)width * (size_t)height;
-  array<float> neighbor_pixels(num_pixels * num_channels);
-  if (!in_neighbors[neighbor]->read_image(TypeDesc::FLOAT, neighbor_pixels.data())) {
-    return false;
-  }
+  neighbor_pixels.resize(num_pixels * num_channels);
+  return in_neighbors[neighbor]->read_image(TypeDesc::FLOAT, neighbor_pixels.data());
+}
 
+void DenoiseImage::read_neighbor_pixels(int neighbor,
+                                        const DenoiseImageLayer &layer,
+                                        const array<float> &neighbor_pixels,
+                                        float *input_pixels)
+{
+  /* Copy pixels from neighboring frames into device buffer with channels reshuffled. */
   const int *input_to_image_channel = layer.neighbor_input_to_image_channel[neighbor].data();
 
   for (int i = 0; i < width * height; i++) {
@@ -704,8 +762,6 @@ bool DenoiseImage::read_neighbor_pixels(int neighbor,
           neighbor_pixels[((size_t)i) * num_channels + image_channel];
     }
   }
-
-  return true;
 }
 
 bool DenoiseImage::load(const string &in_filepath, string &error)
@@ -884,6 +940,11 @@ bool Denoiser::run()
   assert(input.size() == output.size());
 
   num_frames = output.size();
+  frame_cache.clear();
+
+  /* Timing, useful for comparing tile sizes and devices. */
+  int num_denoised = 0;
+  double total_load_time = 0.0, total_exec_time = 0.0, total_save_time = 0.0;
 
   for (int frame = 0; frame < num_frames; frame++) {
     /* Skip empty output paths. */
@@ -899,26 +960,54 @@ bool Denoiser::run()
       }
     }
 
+    /* Free cached frames that have left the window. */
+    while (!frame_cache.empty() &&
+           frame_cache.begin()->first < frame - params.neighbor_frames) {
+      frame_cache.erase(frame_cache.begin());
+    }
+
     /* Execute task. */
     DenoiseTask task(device, this, frame, neighbor_frames);
+    double start_time = time_dt();
     if (!task.load()) {
       error = task.error;
       return false;
     }
 
+    double load_time = time_dt();
     if (!task.exec()) {
       error = task.error;
       return false;
     }
 
+    double exec_time = time_dt();
     if (!task.save()) {
       error = task.error;
       return false;
     }
 
     task.free();
+
+    double end_time = time_dt();
+    total_load_time += load_time - start_time;
+    total_exec_time += exec_time - load_time;
+    total_save_time += end_time - exec_time;
+    num_denoised++;
+
+    VLOG(1) << "Denoised frame " << frame << " in " << end_time - start_time << "s (load "
+            << load_time - start_time << "s, denoise " << exec_time - load_time << "s, save "
+            << end_time - exec_time << "s).";
+  }
+
+  if (num_denoised > 0) {
+    VLOG(1) << "Denoised " << num_denoised << " frames with " << tile_size.x << "x"
+            << tile_size.y << " tiles, average denoise time per frame "
+            << total_exec_time / num_denoised << "s, load " << total_load_time / num_denoised
+            << "s, save " << total_save_time / num_denoised << "s.";
   }
 
+  frame_cache.clear();
+
   return true;
 }
 
@@ -22,6 +22,7 @@
 
 #include "render/buffers.h"
 
+#include "util/util_map.h"
 #include "util/util_string.h"
 #include "util/util_unique_ptr.h"
 #include "util/util_vector.h"
@@ -67,6 +68,11 @@ class Denoiser {
   Device *device;
 
   int num_frames;
+
+  /* Preprocessed input pixels of frames within the window around the current frame, per
+   * layer name. Consecutive frames share most of their neighbors, so every file is only read
+   * and preprocessed once while the window slides through the sequence. */
+  map<int, map<string, array<float>>> frame_cache;
 };
 
 /* Denoise Image Layer */
@@ -138,7 +144,11 @@ class DenoiseImage {
   /* Load subset of pixels from file buffer into input buffer, as needed for denoising
    * on the device. Channels are reshuffled following the provided mapping. */
   void read_pixels(const DenoiseImageLayer &layer, float *input_pixels);
-  bool read_neighbor_pixels(int neighbor, const DenoiseImageLayer &layer, float *input_pixels);
+  bool read_neighbor_image(int neighbor, array<float> &neighbor_pixels);
+  void read_neighbor_pixels(int neighbor,
+                            const DenoiseImageLayer &layer,
+                            const array<float> &neighbor_pixels,
+                            float *input_pixels);
 
   bool save_output(const string &out_filepath, string &error);
 
@@ -191,6 +201,8 @@ class DenoiseTask {
   map<int, device_vector<float> *> output_pixels;
 
   /* Task handling */
+  bool cache_input_pixels(int cache_frame, int neighbor);
+  void preprocess_input_pixels(float *buffer_data);
   bool load_input_pixels(int layer);
   void create_task(DeviceTask &task);
 
@@ -209,6 +209,9 @@ void Geometry::compute_bvh(
       bparams.bvh_layout = bvh_layout;
       bparams.use_unaligned_nodes = dscene->data.bvh.have_curves &&
                                     params->use_bvh_unaligned_nodes;
+      bparams.use_quantized_nodes = params->use_bvh_quantized_nodes;
+      /* CPU kernels test the curve segments of a leaf together. */
+      bparams.max_curve_leaf_size = (bvh_layout & (BVH_LAYOUT_BVH4 | BVH_LAYOUT_BVH8)) ? 4 : 1;
       bparams.num_motion_triangle_steps = params->num_bvh_time_steps;
       bparams.num_motion_curve_steps = params->num_bvh_time_steps;
       bparams.bvh_type = params->bvh_type;
@@ -1024,6 +1027,9 @@ void GeometryManager::device_update_bvh(Device *device,
   bparams.use_spatial_split = scene->params.use_bvh_spatial_split;
   bparams.use_unaligned_nodes = dscene->data.bvh.have_curves &&
                                 scene->params.use_bvh_unaligned_nodes;
+  bparams.use_quantized_nodes = scene->params.use_bvh_quantized_nodes;
+  /* CPU kernels test the curve segments of a leaf together. */
+  bparams.max_curve_leaf_size = (bparams.bvh_layout & (BVH_LAYOUT_BVH4 | BVH_LAYOUT_BVH8)) ? 4 : 1;
   bparams.num_motion_triangle_steps = scene->params.num_bvh_time_steps;
   bparams.num_motion_curve_steps = scene->params.num_bvh_time_steps;
   bparams.bvh_type = scene->params.bvh_type;
@@ -1107,6 +1113,7 @@ void GeometryManager::device_update_bvh(Device *device,
 
   bvh->copy_to_device(progress, dscene);
 
+  scene_bvh_stats = bvh->build_stats;
   delete bvh;
 }
 
@@ -1271,6 +1278,12 @@ void GeometryManager::device_update(Device *device,
     Camera *dicing_camera = scene->dicing_camera;
     dicing_camera->update(scene);
 
+    /* Keep diced geometry around for when the scene is updated again, which only happens
+     * for interactive and persistent data renders. Final renders only keep the same Mesh
+     * across frames with persistent data, where the render depsgraph is kept alive. The
+     * cache holds a second copy of the diced geometry, so it is not used otherwise. */
+    const bool use_dice_cache = !scene->params.background || scene->params.persistent_data;
+
     size_t i = 0;
     foreach (Geometry *geom, scene->geometry) {
       if (!(geom->need_update && geom->type == Geometry::MESH)) {
@@ -1291,7 +1304,7 @@ void GeometryManager::device_update(Device *device,
 
         mesh->subd_params->camera = dicing_camera;
         DiagSplit dsplit(*mesh->subd_params);
-        mesh->tessellate(&dsplit);
+        mesh->tessellate(&dsplit, use_dice_cache);
 
         i++;
 
@@ -1326,19 +1339,18 @@ void GeometryManager::device_update(Device *device,
 
   /* Update displacement. */
   bool displacement_done = false;
+  if (true_displacement_used) {
+    displacement_done = displace(device, dscene, scene, progress);
+  }
+  if (progress.get_cancel())
+    return;
+
   size_t num_bvh = 0;
   BVHLayout bvh_layout = BVHParams::best_bvh_layout(scene->params.bvh_layout,
                                                     device->get_bvh_layout_mask());
 
   foreach (Geometry *geom, scene->geometry) {
     if (geom->need_update) {
-      if (geom->type == Geometry::MESH) {
-        Mesh *mesh = static_cast<Mesh *>(geom);
-        if (displace(device, dscene, scene, mesh, progress)) {
-          displacement_done = true;
-        }
-      }
-
       if (geom->need_build_bvh(bvh_layout)) {
         num_bvh++;
       }
@@ -1464,7 +1476,11 @@ void GeometryManager::collect_statistics(const Scene *scene, RenderStats *stats)
   foreach (Geometry *geometry, scene->geometry) {
     stats->mesh.geometry.add_entry(
         NamedSizeEntry(string(geometry->name.c_str()), geometry->get_total_size_in_bytes()));
+    if (geometry->bvh != NULL) {
+      stats->bvh.add_entry(string(geometry->name.c_str()), geometry->bvh->build_stats);
+    }
   }
+  stats->bvh.add_entry("Scene", scene_bvh_stats);
 }
 
 CCL_NAMESPACE_END
@@ -164,7 +164,11 @@ class GeometryManager {
   void collect_statistics(const Scene *scene, RenderStats *stats);
 
  protected:
-  bool displace(Device *device, DeviceScene *dscene, Scene *scene, Mesh *mesh, Progress &progress);
+  bool displace(Device *device, DeviceScene *dscene, Scene *scene, Progress &progress);
+  static void displace_apply(Scene *scene,
+                             Mesh *mesh,
+                             const vector<int> *displace_verts,
+                             const float4 *offset);
 
   void create_volume_mesh(Mesh *mesh, Progress &progress);
 
@@ -198,6 +202,9 @@ class GeometryManager {
   void device_update_displacement_images(Device *device, Scene *scene, Progress &progress);
 
   void device_update_volume_images(Device *device, Scene *scene, Progress &progress);
+
+  /* Statistics of the last scene BVH build, the BVH itself is freed after copying to device. */
+  BVHBuildStats scene_bvh_stats;
 };
 
 CCL_NAMESPACE_END
@@ -27,6 +27,7 @@
 #include "util/util_logging.h"
 #include "util/util_path.h"
 #include "util/util_progress.h"
+#include "util/util_sparse_grid.h"
 #include "util/util_texture.h"
 #include "util/util_unique_ptr.h"
 
@@ -242,6 +243,16 @@ ImageLoader::ImageLoader()
 {
 }
 
+bool ImageLoader::load_sparse_index(const ImageMetaData &, int *)
+{
+  return false;
+}
+
+bool ImageLoader::load_pixels_sparse(const ImageMetaData &, const int *, void *, const size_t)
+{
+  return false;
+}
+
 ustring ImageLoader::osl_filepath() const
 {
   return ustring();
@@ -607,6 +618,144 @@ bool ImageManager::file_load_image(Image *img, int texture_limit)
   return true;
 }
 
+bool ImageManager::texture_cache_load_image(Image *img)
+{
+  /* Only images read from file by OpenImageIO, and that need no conversion besides alpha
+   * association and sRGB decoding in the kernel, can be read on demand. */
+  const ImageMetaData &metadata = img->metadata;
+  const ustring filepath = img->loader->osl_filepath();
+  if (filepath.empty() || metadata.depth > 1 || metadata.channels < 1 ||
+      metadata.channels > 4) {
+    return false;
+  }
+  if (metadata.colorspace != u_colorspace_raw && metadata.colorspace != u_colorspace_srgb) {
+    return false;
+  }
+  if (!image_associate_alpha(img) && !(metadata.channels == 1 || metadata.channels == 3)) {
+    return false;
+  }
+
+  TextureCacheTexture *texture = texture_cache->add_texture(
+      filepath.string(), metadata.channels, img->params.interpolation, img->params.extension);
+  if (texture == NULL) {
+    return false;
+  }
+
+  /* Placeholder so the slot is allocated on the device, the kernel reads pixels through
+   * the texture cache. */
+  thread_scoped_lock device_lock(device_mutex);
+  void *pixels = img->mem->alloc(1, 1);
+  memset(pixels, 0, img->mem->memory_size());
+  img->mem->info.use_texture_cache = true;
+  img->mem->info.data = (uint64_t)texture;
+
+  VLOG(1) << "Using texture cache for " << img->loader->name() << ".";
+  return true;
+}
+
+void ImageManager::texture_cache_free_image(Image *img)
+{
+  if (img->mem && img->mem->info.use_texture_cache) {
+    texture_cache->remove_texture((TextureCacheTexture *)img->mem->info.data);
+  }
+}
+
+bool ImageManager::sparse_load_image(Image *img)
+{
+  /* Only float volumes without color space conversion, as read from OpenVDB. */
+  const ImageMetaData &metadata = img->metadata;
+  const bool is_rgba = (metadata.type == IMAGE_DATA_TYPE_FLOAT4);
+  if (!(metadata.type == IMAGE_DATA_TYPE_FLOAT || is_rgba) || metadata.depth <= 1) {
+    return false;
+  }
+  if (metadata.colorspace != u_colorspace_raw || metadata.channels < 1 ||
+      metadata.channels > 4) {
+    return false;
+  }
+
+  const size_t num_tiles = sparse_grid_num_tiles(
+      metadata.width, metadata.height, metadata.depth);
+  vector<int> tile_index(num_tiles, SPARSE_TILE_EMPTY);
+  if (!img->loader->load_sparse_index(metadata, tile_index.data())) {
+    return false;
+  }
+
+  /* Number active tiles in order. */
+  int num_active_tiles = 0;
+  foreach (int &tile, tile_index) {
+    if (tile != SPARSE_TILE_EMPTY) {
+      tile = num_active_tiles++;
+    }
+  }
+
+  /* Dense lookups are faster, so only use the sparse grid when it saves a lot of memory. */
+  const int texel_elements = is_rgba ? 4 : 1;
+  const size_t index_texels = sparse_grid_index_texels(num_tiles,
+                                                       sizeof(float) * texel_elements);
+  const size_t num_pixels = ((size_t)num_active_tiles) * SPARSE_TILE_VOXELS;
+  const size_t num_texels = index_texels + num_pixels;
+  const size_t num_dense_texels = metadata.width * metadata.height * metadata.depth;
+  if (num_texels * 2 > num_dense_texels) {
+    return false;
+  }
+
+  float *texels;
+  {
+    thread_scoped_lock device_lock(device_mutex);
+    texels = (float *)img->mem->alloc(num_texels, 1, 1);
+  }
+
+  if (texels == NULL) {
+    return false;
+  }
+
+  memcpy(texels, tile_index.data(), num_tiles * sizeof(int));
+
+  const int components = metadata.channels;
+  float *pixels = texels + index_texels * texel_elements;
+  if (!img->loader->load_pixels_sparse(
+          metadata, tile_index.data(), pixels, num_pixels * components)) {
+    return false;
+  }
+
+  /* Convert to RGBA and remove non-finite values, same as for dense images. */
+  if (is_rgba && components != 4) {
+    for (size_t i = num_pixels - 1, pixel = 0; pixel < num_pixels; pixel++, i--) {
+      float rgba[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+      for (int c = 0; c < 3; c++) {
+        rgba[c] = pixels[i * components + min(c, components - 1)];
+      }
+      if (components == 2) {
+        rgba[3] = pixels[i * components + 1];
+      }
+      memcpy(pixels + i * 4, rgba, sizeof(rgba));
+    }
+  }
+
+  for (size_t i = 0; i < num_pixels; i++) {
+    float *pixel = &pixels[i * texel_elements];
+    for (int c = 0; c < texel_elements; c++) {
+      if (!isfinite(pixel[c])) {
+        memset(pixel, 0, sizeof(float) * texel_elements);
+        break;
+      }
+    }
+  }
+
+  /* The allocation is a flat array, the kernel needs the voxel resolution. */
+  img->mem->info.width = metadata.width;
+  img->mem->info.height = metadata.height;
+  img->mem->info.depth = metadata.depth;
+  img->mem->info.use_sparse_grid = true;
+
+  VLOG(1) << "Using sparse grid for " << img->loader->name() << ", " << num_active_tiles
+          << " of " << num_tiles << " tiles active, "
+          << string_human_readable_size(img->mem->memory_size()) << " instead of "
+          << string_human_readable_size(num_dense_texels * texel_elements * sizeof(float))
+          << ".";
+  return true;
+}
+
 void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Progress *progress)
 {
   if (progress->get_cancel()) {
@@ -627,6 +776,7 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
 
   /* Free previous texture in slot. */
   if (img->mem) {
+    texture_cache_free_image(img);
     thread_scoped_lock device_lock(device_mutex);
     delete img->mem;
     img->mem = NULL;
@@ -638,7 +788,13 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
   img->mem->info.transform_3d = img->metadata.transform_3d;
 
   /* Create new texture. */
-  if (type == IMAGE_DATA_TYPE_FLOAT4) {
+  if (texture_cache && texture_limit == 0 && texture_cache_load_image(img)) {
+    /* Pixels are loaded on demand. */
+  }
+  else if (device->info.type == DEVICE_CPU && texture_limit == 0 && sparse_load_image(img)) {
+    /* Only tiles with active voxels are stored. */
+  }
+  else if (type == IMAGE_DATA_TYPE_FLOAT4) {
     if (!file_load_image<TypeDesc::FLOAT, float>(img, texture_limit)) {
       /* on failure to load, we set a 1x1 pixels pink image */
       thread_scoped_lock device_lock(device_mutex);
@@ -750,6 +906,7 @@ void ImageManager::device_free_image(Device *, int slot)
   }
 
   if (img->mem) {
+    texture_cache_free_image(img);
     thread_scoped_lock device_lock(device_mutex);
     delete img->mem;
   }
@@ -765,6 +922,13 @@ void ImageManager::device_update(Device *device, Scene *scene, Progress &progres
     return;
   }
 
+  /* Read image files on demand rather than fully loading them. OSL has its own texture
+   * system, and other devices can not read from host memory during rendering. */
+  if (!texture_cache && scene->params.texture_cache_size > 0 &&
+      device->info.type == DEVICE_CPU && !osl_texture_system) {
+    texture_cache.reset(new TextureCache(scene->params.texture_cache_size));
+  }
+
   TaskPool pool;
   for (size_t slot = 0; slot < images.size(); slot++) {
     Image *img = images[slot];
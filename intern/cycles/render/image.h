@@ -23,6 +23,7 @@
 #include "render/colorspace.h"
 
 #include "util/util_string.h"
+#include "util/util_texture_cache.h"
 #include "util/util_thread.h"
 #include "util/util_transform.h"
 #include "util/util_unique_ptr.h"
@@ -111,6 +112,18 @@ class ImageLoader {
                            const size_t pixels_size,
                            const bool associate_alpha) = 0;
 
+  /* Optional sparse loading of 3D images, see util_sparse_grid.h. Set the entries of
+   * tiles that contain active voxels to any value other than SPARSE_TILE_EMPTY. Returns
+   * false to load the image dense, for example when inactive voxels are not zero. */
+  virtual bool load_sparse_index(const ImageMetaData &metadata, int *tile_index);
+
+  /* Load the voxels of the active tiles, in the order given by the tile index. Voxels are
+   * stored with the number of channels from the metadata, like load_pixels. */
+  virtual bool load_pixels_sparse(const ImageMetaData &metadata,
+                                  const int *tile_index,
+                                  void *pixels,
+                                  const size_t pixels_size);
+
   /* Name for logs and stats. */
   virtual string name() const = 0;
 
@@ -211,6 +224,7 @@ class ImageManager {
 
   vector<Image *> images;
   void *osl_texture_system;
+  unique_ptr<TextureCache> texture_cache;
 
   int add_image_slot(ImageLoader *loader, const ImageParams &params, const bool builtin);
   void add_image_user(int slot);
@@ -221,6 +235,11 @@ class ImageManager {
   template<TypeDesc::BASETYPE FileFormat, typename StorageType>
   bool file_load_image(Image *img, int texture_limit);
 
+  bool texture_cache_load_image(Image *img);
+  void texture_cache_free_image(Image *img);
+
+  bool sparse_load_image(Image *img);
+
   void device_load_image(Device *device, Scene *scene, int slot, Progress *progress);
   void device_free_image(Device *device, int slot);
 
@@ -16,6 +16,8 @@
 
 #include "render/image_vdb.h"
 
+#include "util/util_sparse_grid.h"
+
 #ifdef WITH_OPENVDB
 #  include <openvdb/openvdb.h>
 #  include <openvdb/tools/Dense.h>
@@ -23,6 +25,81 @@
 
 CCL_NAMESPACE_BEGIN
 
+#ifdef WITH_OPENVDB
+/* Mark the sparse grid tiles overlapping active voxels or active tiles of the tree. */
+template<typename GridType>
+static bool vdb_sparse_index(const openvdb::GridBase::ConstPtr &grid,
+                             const openvdb::CoordBBox &bbox,
+                             int *tile_index)
+{
+  const openvdb::Coord min = bbox.min();
+  const openvdb::Coord dim = bbox.dim();
+  const size_t tiles_x = sparse_grid_num_tiles(dim.x());
+  const size_t tiles_y = sparse_grid_num_tiles(dim.y());
+
+  typename GridType::ConstPtr typed_grid = openvdb::gridConstPtrCast<GridType>(grid);
+
+  /* Empty tiles read as zero, while the dense copy fills inactive voxels with the
+   * background, so grids with another background must be loaded dense. */
+  if (typed_grid->background() != openvdb::zeroVal<typename GridType::ValueType>()) {
+    return false;
+  }
+
+  for (typename GridType::ValueOnCIter iter = typed_grid->cbeginValueOn(); iter; ++iter) {
+    openvdb::CoordBBox active_bbox;
+    iter.getBoundingBox(active_bbox);
+
+    const openvdb::Coord tile_min = (active_bbox.min() - min) >> SPARSE_TILE_SHIFT;
+    const openvdb::Coord tile_max = (active_bbox.max() - min) >> SPARSE_TILE_SHIFT;
+
+    for (int z = tile_min.z(); z <= tile_max.z(); z++) {
+      for (int y = tile_min.y(); y <= tile_max.y(); y++) {
+        for (int x = tile_min.x(); x <= tile_max.x(); x++) {
+          tile_index[x + tiles_x * (y + tiles_y * z)] = 0;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+/* Copy the voxels of the active tiles, one tile after the other. */
+template<typename GridType, typename ValueType>
+static void vdb_sparse_pixels(const openvdb::GridBase::ConstPtr &grid,
+                              const openvdb::CoordBBox &bbox,
+                              const int *tile_index,
+                              ValueType *pixels)
+{
+  const openvdb::Coord min = bbox.min();
+  const openvdb::Coord dim = bbox.dim();
+  const int tiles_x = sparse_grid_num_tiles(dim.x());
+  const int tiles_y = sparse_grid_num_tiles(dim.y());
+  const int tiles_z = sparse_grid_num_tiles(dim.z());
+
+  typename GridType::ConstPtr typed_grid = openvdb::gridConstPtrCast<GridType>(grid);
+  size_t index = 0;
+  for (int z = 0; z < tiles_z; z++) {
+    for (int y = 0; y < tiles_y; y++) {
+      for (int x = 0; x < tiles_x; x++, index++) {
+        const int tile = tile_index[index];
+        if (tile == SPARSE_TILE_EMPTY) {
+          continue;
+        }
+
+        const openvdb::Coord tile_min = min + openvdb::Coord(x * SPARSE_TILE_SIZE,
+                                                             y * SPARSE_TILE_SIZE,
+                                                             z * SPARSE_TILE_SIZE);
+        const openvdb::CoordBBox tile_bbox(tile_min, tile_min.offsetBy(SPARSE_TILE_SIZE - 1));
+        openvdb::tools::Dense<ValueType, openvdb::tools::LayoutXYZ> dense(
+            tile_bbox, pixels + ((size_t)tile) * SPARSE_TILE_VOXELS);
+        openvdb::tools::copyToDense(*typed_grid, dense, true);
+      }
+    }
+  }
+}
+#endif
+
 VDBImageLoader::VDBImageLoader(const string &grid_name) : grid_name(grid_name)
 {
 }
@@ -161,6 +238,89 @@ bool VDBImageLoader::load_pixels(const ImageMetaData &, void *pixels, const size
 #endif
 }
 
+bool VDBImageLoader::load_sparse_index(const ImageMetaData &, int *tile_index)
+{
+#ifdef WITH_OPENVDB
+  if (grid->isType<openvdb::FloatGrid>()) {
+    return vdb_sparse_index<openvdb::FloatGrid>(grid, bbox, tile_index);
+  }
+  else if (grid->isType<openvdb::Vec3fGrid>()) {
+    return vdb_sparse_index<openvdb::Vec3fGrid>(grid, bbox, tile_index);
+  }
+  else if (grid->isType<openvdb::BoolGrid>()) {
+    return vdb_sparse_index<openvdb::BoolGrid>(grid, bbox, tile_index);
+  }
+  else if (grid->isType<openvdb::DoubleGrid>()) {
+    return vdb_sparse_index<openvdb::DoubleGrid>(grid, bbox, tile_index);
+  }
+  else if (grid->isType<openvdb::Int32Grid>()) {
+    return vdb_sparse_index<openvdb::Int32Grid>(grid, bbox, tile_index);
+  }
+  else if (grid->isType<openvdb::Int64Grid>()) {
+    return vdb_sparse_index<openvdb::Int64Grid>(grid, bbox, tile_index);
+  }
+  else if (grid->isType<openvdb::Vec3IGrid>()) {
+    return vdb_sparse_index<openvdb::Vec3IGrid>(grid, bbox, tile_index);
+  }
+  else if (grid->isType<openvdb::Vec3dGrid>()) {
+    return vdb_sparse_index<openvdb::Vec3dGrid>(grid, bbox, tile_index);
+  }
+  else if (grid->isType<openvdb::MaskGrid>()) {
+    return vdb_sparse_index<openvdb::MaskGrid>(grid, bbox, tile_index);
+  }
+
+  return false;
+#else
+  (void)tile_index;
+  return false;
+#endif
+}
+
+bool VDBImageLoader::load_pixels_sparse(const ImageMetaData &,
+                                        const int *tile_index,
+                                        void *pixels,
+                                        const size_t)
+{
+#ifdef WITH_OPENVDB
+  if (grid->isType<openvdb::FloatGrid>()) {
+    vdb_sparse_pixels<openvdb::FloatGrid>(grid, bbox, tile_index, (float *)pixels);
+  }
+  else if (grid->isType<openvdb::Vec3fGrid>()) {
+    vdb_sparse_pixels<openvdb::Vec3fGrid>(grid, bbox, tile_index, (openvdb::Vec3f *)pixels);
+  }
+  else if (grid->isType<openvdb::BoolGrid>()) {
+    vdb_sparse_pixels<openvdb::BoolGrid>(grid, bbox, tile_index, (float *)pixels);
+  }
+  else if (grid->isType<openvdb::DoubleGrid>()) {
+    vdb_sparse_pixels<openvdb::DoubleGrid>(grid, bbox, tile_index, (float *)pixels);
+  }
+  else if (grid->isType<openvdb::Int32Grid>()) {
+    vdb_sparse_pixels<openvdb::Int32Grid>(grid, bbox, tile_index, (float *)pixels);
+  }
+  else if (grid->isType<openvdb::Int64Grid>()) {
+    vdb_sparse_pixels<openvdb::Int64Grid>(grid, bbox, tile_index, (float *)pixels);
+  }
+  else if (grid->isType<openvdb::Vec3IGrid>()) {
+    vdb_sparse_pixels<openvdb::Vec3IGrid>(grid, bbox, tile_index, (openvdb::Vec3f *)pixels);
+  }
+  else if (grid->isType<openvdb::Vec3dGrid>()) {
+    vdb_sparse_pixels<openvdb::Vec3dGrid>(grid, bbox, tile_index, (openvdb::Vec3f *)pixels);
+  }
+  else if (grid->isType<openvdb::MaskGrid>()) {
+    vdb_sparse_pixels<openvdb::MaskGrid>(grid, bbox, tile_index, (float *)pixels);
+  }
+  else {
+    return false;
+  }
+
+  return true;
+#else
+  (void)tile_index;
+  (void)pixels;
+  return false;
+#endif
+}
+
 string VDBImageLoader::name() const
 {
   return grid_name;
@@ -37,6 +37,13 @@ class VDBImageLoader : public ImageLoader {
                            const size_t pixels_size,
                            const bool associate_alpha) override;
 
+  virtual bool load_sparse_index(const ImageMetaData &metadata, int *tile_index) override;
+
+  virtual bool load_pixels_sparse(const ImageMetaData &metadata,
+                                  const int *tile_index,
+                                  void *pixels,
+                                  const size_t pixels_size) override;
+
   virtual string name() const override;
 
   virtual bool equals(const ImageLoader &other) const override;
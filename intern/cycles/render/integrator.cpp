@@ -76,6 +76,7 @@ NODE_DEFINE(Integrator)
   SOCKET_BOOLEAN(sample_all_lights_direct, "Sample All Lights Direct", true);
   SOCKET_BOOLEAN(sample_all_lights_indirect, "Sample All Lights Indirect", true);
   SOCKET_FLOAT(light_sampling_threshold, "Light Sampling Threshold", 0.05f);
+  SOCKET_BOOLEAN(use_light_tree, "Use Light Tree", false);
 
   static NodeEnum method_enum;
   method_enum.insert("path", PATH);
@@ -94,6 +95,9 @@ NODE_DEFINE(Integrator)
 Integrator::Integrator() : Node(node_type)
 {
   need_update = true;
+  compiled_filter_glossy = -1.0f;
+  lut_sampling_pattern = SAMPLING_NUM_PATTERNS;
+  lut_dimensions = 0;
 }
 
 Integrator::~Integrator()
@@ -105,8 +109,6 @@ void Integrator::device_update(Device *device, DeviceScene *dscene, Scene *scene
   if (!need_update)
     return;
 
-  device_free(device, dscene);
-
   KernelIntegrator *kintegrator = &dscene->data.integrator;
 
   /* integrator parameters */
@@ -234,7 +236,13 @@ void Integrator::device_update(Device *device, DeviceScene *dscene, Scene *scene
   int dimensions = PRNG_BASE_NUM + max_samples * PRNG_BOUNCE_NUM;
   dimensions = min(dimensions, SOBOL_MAX_DIMENSIONS);
 
-  if (sampling_pattern == SAMPLING_PATTERN_SOBOL) {
+  /* Table only depends on the pattern and dimensions, keep it when those did not change. */
+  if (dscene->sample_pattern_lut.size() != 0 && sampling_pattern == lut_sampling_pattern &&
+      (sampling_pattern != SAMPLING_PATTERN_SOBOL || dimensions == lut_dimensions)) {
+    /* Nothing to do. */
+  }
+  else if (sampling_pattern == SAMPLING_PATTERN_SOBOL) {
+    dscene->sample_pattern_lut.free();
     uint *directions = dscene->sample_pattern_lut.alloc(SOBOL_BITS * dimensions);
 
     sobol_generate_direction_vectors((uint(*)[SOBOL_BITS])directions, dimensions);
@@ -244,6 +252,7 @@ void Integrator::device_update(Device *device, DeviceScene *dscene, Scene *scene
   else {
     constexpr int sequence_size = NUM_PMJ_SAMPLES;
     constexpr int num_sequences = NUM_PMJ_PATTERNS;
+    dscene->sample_pattern_lut.free();
     float2 *directions = (float2 *)dscene->sample_pattern_lut.alloc(sequence_size * num_sequences *
                                                                     2);
     TaskPool pool;
@@ -256,6 +265,9 @@ void Integrator::device_update(Device *device, DeviceScene *dscene, Scene *scene
     dscene->sample_pattern_lut.copy_to_device();
   }
 
+  lut_sampling_pattern = sampling_pattern;
+  lut_dimensions = dimensions;
+  compiled_filter_glossy = filter_glossy;
   need_update = false;
 }
 
@@ -269,12 +281,22 @@ bool Integrator::modified(const Integrator &integrator)
   return !Node::equals(integrator);
 }
 
+bool Integrator::use_light_tree_sampling() const
+{
+  if (method == BRANCHED_PATH && (sample_all_lights_direct || sample_all_lights_indirect)) {
+    return false;
+  }
+  return use_light_tree;
+}
+
 void Integrator::tag_update(Scene *scene)
 {
-  foreach (Shader *shader, scene->shaders) {
-    if (shader->has_integrator_dependency) {
-      scene->shader_manager->need_update = true;
-      break;
+  if (filter_glossy != compiled_filter_glossy) {
+    foreach (Shader *shader, scene->shaders) {
+      if (shader->has_integrator_dependency) {
+        scene->shader_manager->need_update = true;
+        break;
+      }
     }
   }
   need_update = true;
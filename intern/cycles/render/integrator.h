@@ -74,6 +74,7 @@ class Integrator : public Node {
   bool sample_all_lights_direct;
   bool sample_all_lights_indirect;
   float light_sampling_threshold;
+  bool use_light_tree;
 
   int adaptive_min_samples;
   float adaptive_threshold;
@@ -98,7 +99,18 @@ class Integrator : public Node {
   void device_free(Device *device, DeviceScene *dscene);
 
   bool modified(const Integrator &integrator);
+
+  /* Light tree is not used when sampling all lights, which relies on the flat distribution. */
+  bool use_light_tree_sampling() const;
   void tag_update(Scene *scene);
+
+ protected:
+  /* Glossy filter the shaders were last compiled with, and layout of the sample pattern
+   * table on the device. Used to avoid recompiling shaders and regenerating the table
+   * when only other settings changed, like the seed for every frame of an animation. */
+  float compiled_filter_glossy;
+  SamplingPattern lut_sampling_pattern;
+  int lut_dimensions;
 };
 
 CCL_NAMESPACE_END
@@ -20,6 +20,7 @@
 #include "render/film.h"
 #include "render/graph.h"
 #include "render/integrator.h"
+#include "render/light_tree.h"
 #include "render/mesh.h"
 #include "render/nodes.h"
 #include "render/object.h"
@@ -31,9 +32,14 @@
 #include "util/util_logging.h"
 #include "util/util_path.h"
 #include "util/util_progress.h"
+#include "util/util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
+/* Maximum number of emitters in a light tree leaf. Emitters in a leaf are picked proportionally
+ * to their energy only, so keep leaves small. */
+#define LIGHT_TREE_MAX_PRIMS_IN_LEAF 1
+
 static void shade_background_pixels(Device *device,
                                     DeviceScene *dscene,
                                     int width,
@@ -273,6 +279,57 @@ bool LightManager::object_usable_as_light(Object *object)
   return false;
 }
 
+/* Rough estimate of the shader emission strength, used to guide light tree construction. */
+static float light_tree_shader_energy(Shader *shader)
+{
+  float3 emission;
+  if (shader->is_constant_emission(&emission)) {
+    return average(fabs(emission));
+  }
+  return 1.0f;
+}
+
+static LightTreePrimitive light_tree_lamp_primitive(Scene *scene,
+                                                    Light *light,
+                                                    int distribution_index)
+{
+  Shader *shader = (light->shader) ? light->shader : scene->default_light;
+  float energy = average(fabs(light->strength)) * light_tree_shader_energy(shader);
+
+  LightTreePrimitive prim;
+  prim.bounds = BoundBox::empty;
+  prim.distribution_index = distribution_index;
+  prim.orientation.axis = make_float3(0.0f, 0.0f, 1.0f);
+  prim.orientation.theta_o = M_PI_F;
+  prim.orientation.theta_e = M_PI_2_F;
+
+  if (light->type == LIGHT_AREA) {
+    const float3 axisu = light->axisu * (light->sizeu * light->size * 0.5f);
+    const float3 axisv = light->axisv * (light->sizev * light->size * 0.5f);
+    prim.bounds.grow(light->co + axisu + axisv);
+    prim.bounds.grow(light->co + axisu - axisv);
+    prim.bounds.grow(light->co - axisu + axisv);
+    prim.bounds.grow(light->co - axisu - axisv);
+    /* Area lights only emit to the front side. */
+    prim.orientation.axis = safe_normalize(light->dir);
+    prim.orientation.theta_o = 0.0f;
+    energy *= M_PI_4_F;
+  }
+  else {
+    prim.bounds.grow(light->co, light->size);
+    if (light->type == LIGHT_SPOT) {
+      prim.orientation.axis = safe_normalize(light->dir);
+      prim.orientation.theta_o = 0.0f;
+      prim.orientation.theta_e = min(light->spot_angle * 0.5f, M_PI_2_F);
+    }
+  }
+
+  prim.centroid = prim.bounds.center();
+  prim.energy = energy;
+  prim.pdf_flat = 0.0f;
+  return prim;
+}
+
 void LightManager::device_update_distribution(Device *,
                                               DeviceScene *dscene,
                                               Scene *scene,
@@ -288,6 +345,9 @@ void LightManager::device_update_distribution(Device *,
 
   bool background_mis = false;
 
+  const bool use_light_tree = scene->integrator->use_light_tree_sampling();
+  size_t num_light_tree_triangle_slots = 0;
+
   foreach (Light *light, scene->lights) {
     if (light->is_enabled) {
       num_lights++;
@@ -308,6 +368,7 @@ void LightManager::device_update_distribution(Device *,
     /* Count triangles. */
     Mesh *mesh = static_cast<Mesh *>(object->geometry);
     size_t mesh_num_triangles = mesh->num_triangles();
+    num_light_tree_triangle_slots += mesh_num_triangles;
     for (size_t i = 0; i < mesh_num_triangles; i++) {
       int shader_index = mesh->shader[i];
       Shader *shader = (shader_index < mesh->used_shaders.size()) ?
@@ -323,6 +384,22 @@ void LightManager::device_update_distribution(Device *,
   size_t num_distribution = num_triangles + num_lights;
   VLOG(1) << "Total " << num_distribution << " of light distribution primitives.";
 
+  /* Light tree primitives, and lookup table used to find the emitter of a lamp or triangle for
+   * multiple importance sampling. The table contains an emitter for every lamp, followed by the
+   * triangle table start and primitive offset of every object, followed by the triangle tables. */
+  vector<LightTreePrimitive> light_tree_prims;
+  vector<int> light_tree_distant;
+  vector<int> light_tree_lookup;
+  vector<int> light_tree_lookup_slot;
+  size_t light_tree_triangle_slot = num_lights + 2 * scene->objects.size();
+  float default_surface_energy = 0.0f;
+  if (use_light_tree) {
+    light_tree_prims.reserve(num_distribution);
+    light_tree_lookup.resize(light_tree_triangle_slot + num_light_tree_triangle_slots, -1);
+    light_tree_lookup_slot.resize(num_distribution, -1);
+    default_surface_energy = light_tree_shader_energy(scene->default_surface);
+  }
+
   /* emission area */
   KernelLightDistribution *distribution = dscene->light_distribution.alloc(num_distribution + 1);
   float totarea = 0.0f;
@@ -364,6 +441,16 @@ void LightManager::device_update_distribution(Device *,
     }
 
     size_t mesh_num_triangles = mesh->num_triangles();
+
+    vector<float> shader_energy;
+    if (use_light_tree) {
+      light_tree_lookup[num_lights + 2 * object_id] = light_tree_triangle_slot;
+      light_tree_lookup[num_lights + 2 * object_id + 1] = mesh->prim_offset;
+      foreach (Shader *shader, mesh->used_shaders) {
+        shader_energy.push_back(light_tree_shader_energy(shader));
+      }
+    }
+
     for (size_t i = 0; i < mesh_num_triangles; i++) {
       int shader_index = mesh->shader[i];
       Shader *shader = (shader_index < mesh->used_shaders.size()) ?
@@ -375,6 +462,9 @@ void LightManager::device_update_distribution(Device *,
         distribution[offset].prim = i + mesh->prim_offset;
         distribution[offset].mesh_light.shader_flag = shader_flag;
         distribution[offset].mesh_light.object_id = object_id;
+        if (use_light_tree) {
+          light_tree_lookup_slot[offset] = light_tree_triangle_slot + i;
+        }
         offset++;
 
         Mesh::Triangle t = mesh->get_triangle(i);
@@ -391,10 +481,32 @@ void LightManager::device_update_distribution(Device *,
           p3 = transform_point(&tfm, p3);
         }
 
-        totarea += triangle_area(p1, p2, p3);
+        const float area = triangle_area(p1, p2, p3);
+        totarea += area;
+
+        if (use_light_tree && area > 0.0f) {
+          LightTreePrimitive prim;
+          prim.bounds = BoundBox::empty;
+          prim.bounds.grow(p1);
+          prim.bounds.grow(p2);
+          prim.bounds.grow(p3);
+          prim.centroid = (p1 + p2 + p3) * (1.0f / 3.0f);
+          /* Mesh lights emit from both sides, so there is no useful orientation bound. */
+          prim.orientation.axis = safe_normalize(cross(p2 - p1, p3 - p1));
+          prim.orientation.theta_o = M_PI_F;
+          prim.orientation.theta_e = M_PI_2_F;
+          prim.energy = M_2PI_F * area *
+                        ((shader_index < mesh->used_shaders.size()) ? shader_energy[shader_index] :
+                                                                     default_surface_energy);
+          /* Converted to probability once the distribution is normalized. */
+          prim.pdf_flat = area;
+          prim.distribution_index = offset - 1;
+          light_tree_prims.push_back(prim);
+        }
       }
     }
 
+    light_tree_triangle_slot += mesh_num_triangles;
     j++;
   }
 
@@ -415,6 +527,16 @@ void LightManager::device_update_distribution(Device *,
     distribution[offset].lamp.size = light->size;
     totarea += lightarea;
 
+    if (use_light_tree) {
+      light_tree_lookup_slot[offset] = light_index;
+      if (light->type == LIGHT_DISTANT || light->type == LIGHT_BACKGROUND) {
+        light_tree_distant.push_back(offset);
+      }
+      else {
+        light_tree_prims.push_back(light_tree_lamp_primitive(scene, light, offset));
+      }
+    }
+
     if (light->type == LIGHT_DISTANT) {
       use_lamp_mis |= (light->angle > 0.0f && light->use_mis);
     }
@@ -491,6 +613,24 @@ void LightManager::device_update_distribution(Device *,
     /* CDF */
     dscene->light_distribution.copy_to_device();
 
+    /* Light tree */
+    kintegrator->use_light_tree = false;
+    kintegrator->num_light_tree_emitters = 0;
+    kintegrator->num_light_tree_distant = 0;
+    kintegrator->light_tree_pdf = 0.0f;
+    if (use_light_tree) {
+      foreach (LightTreePrimitive &prim, light_tree_prims) {
+        prim.pdf_flat = (distribution[prim.distribution_index].prim >= 0) ?
+                            prim.pdf_flat * kintegrator->pdf_triangles :
+                            kintegrator->pdf_lights;
+      }
+      device_update_light_tree(dscene,
+                               light_tree_prims,
+                               light_tree_distant,
+                               light_tree_lookup_slot,
+                               light_tree_lookup);
+    }
+
     /* Portals */
     if (num_portals > 0) {
       kintegrator->portal_offset = light_index;
@@ -514,11 +654,73 @@ void LightManager::device_update_distribution(Device *,
     kintegrator->num_portals = 0;
     kintegrator->portal_offset = 0;
     kintegrator->portal_pdf = 0.0f;
+    kintegrator->use_light_tree = false;
+    kintegrator->num_light_tree_emitters = 0;
+    kintegrator->num_light_tree_distant = 0;
+    kintegrator->light_tree_pdf = 0.0f;
 
     kfilm->pass_shadow_scale = 1.0f;
   }
 }
 
+void LightManager::device_update_light_tree(DeviceScene *dscene,
+                                            vector<LightTreePrimitive> &prims,
+                                            const vector<int> &distant,
+                                            const vector<int> &lookup_slot,
+                                            vector<int> &lookup)
+{
+  KernelIntegrator *kintegrator = &dscene->data.integrator;
+
+  /* Distant and background lights can not be bounded, they are sampled separately with the same
+   * probability as in the regular distribution. The tree gets the remaining probability. */
+  const float light_tree_pdf = 1.0f - distant.size() * kintegrator->pdf_lights;
+  if (prims.empty() || light_tree_pdf <= 0.0f) {
+    VLOG(1) << "No local emitters, light tree is disabled.";
+    return;
+  }
+
+  double time_start = time_dt();
+  LightTree tree(prims, LIGHT_TREE_MAX_PRIMS_IN_LEAF);
+
+  const size_t num_emitters = tree.emitters.size();
+  const size_t num_distant = distant.size();
+
+  KernelLightTreeNode *nodes = dscene->light_tree_nodes.alloc(tree.nodes.size());
+  memcpy(nodes, tree.nodes.data(), sizeof(KernelLightTreeNode) * tree.nodes.size());
+
+  KernelLightTreeEmitter *emitters = dscene->light_tree_emitters.alloc(num_emitters +
+                                                                       num_distant);
+  memcpy(emitters, tree.emitters.data(), sizeof(KernelLightTreeEmitter) * num_emitters);
+  for (size_t i = 0; i < num_distant; i++) {
+    KernelLightTreeEmitter &emitter = emitters[num_emitters + i];
+    emitter.energy = 0.0f;
+    emitter.pdf_flat = kintegrator->pdf_lights;
+    emitter.distribution_index = distant[i];
+    emitter.node_index = -1;
+  }
+
+  /* Distant lights are not part of the tree and keep their regular pdf, so they are left out of
+   * the lookup. */
+  for (size_t i = 0; i < num_emitters; i++) {
+    lookup[lookup_slot[emitters[i].distribution_index]] = i;
+  }
+  int *klookup = dscene->light_tree_lookup.alloc(lookup.size());
+  memcpy(klookup, lookup.data(), sizeof(int) * lookup.size());
+
+  dscene->light_tree_nodes.copy_to_device();
+  dscene->light_tree_emitters.copy_to_device();
+  dscene->light_tree_lookup.copy_to_device();
+
+  kintegrator->use_light_tree = true;
+  kintegrator->num_light_tree_emitters = num_emitters;
+  kintegrator->num_light_tree_distant = num_distant;
+  kintegrator->light_tree_pdf = light_tree_pdf;
+
+  VLOG(1) << "Light tree built in " << time_dt() - time_start << " seconds, "
+          << tree.nodes.size() << " nodes, " << num_emitters << " emitters, " << num_distant
+          << " distant lights.";
+}
+
 static void background_cdf(
     int start, int end, int res_x, int res_y, const vector<float3> *pixels, float2 *cond_cdf)
 {
@@ -954,6 +1156,9 @@ void LightManager::device_update(Device *device,
 void LightManager::device_free(Device *, DeviceScene *dscene, const bool free_background)
 {
   dscene->light_distribution.free();
+  dscene->light_tree_nodes.free();
+  dscene->light_tree_emitters.free();
+  dscene->light_tree_lookup.free();
   dscene->lights.free();
   if (free_background) {
     dscene->light_background_marginal_cdf.free();
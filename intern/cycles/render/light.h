@@ -30,6 +30,7 @@ CCL_NAMESPACE_BEGIN
 
 class Device;
 class DeviceScene;
+struct LightTreePrimitive;
 class Object;
 class Progress;
 class Scene;
@@ -119,6 +120,11 @@ class LightManager {
                                   DeviceScene *dscene,
                                   Scene *scene,
                                   Progress &progress);
+  void device_update_light_tree(DeviceScene *dscene,
+                                vector<LightTreePrimitive> &prims,
+                                const vector<int> &distant,
+                                const vector<int> &lookup_slot,
+                                vector<int> &lookup);
   void device_update_background(Device *device,
                                 DeviceScene *dscene,
                                 Scene *scene,
@@ -0,0 +1,279 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render/light_tree.h"
+
+#include "util/util_algorithm.h"
+#include "util/util_math.h"
+#include "util/util_transform.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Number of centroid bins used to evaluate split candidates along each axis. */
+#define LIGHT_TREE_NUM_BINS 12
+
+/* Depth after which we stop trying heuristic splits and fall back to median splits, to keep
+ * recursion depth bounded for degenerate distributions. */
+#define LIGHT_TREE_MAX_HEURISTIC_DEPTH 64
+
+static LightTreeOrientation light_tree_orientation_merge(const LightTreeOrientation &a_,
+                                                         const LightTreeOrientation &b_)
+{
+  const bool a_is_wider = (a_.theta_o >= b_.theta_o);
+  const LightTreeOrientation &a = a_is_wider ? a_ : b_;
+  const LightTreeOrientation &b = a_is_wider ? b_ : a_;
+
+  LightTreeOrientation result;
+  result.axis = a.axis;
+  result.theta_e = max(a.theta_e, b.theta_e);
+
+  const float theta_d = safe_acosf(dot(a.axis, b.axis));
+  if (min(theta_d + b.theta_o, M_PI_F) <= a.theta_o) {
+    /* Cone b is inside of cone a. */
+    result.theta_o = a.theta_o;
+    return result;
+  }
+
+  const float theta_o = 0.5f * (a.theta_o + theta_d + b.theta_o);
+  const float3 rotation_axis = cross(a.axis, b.axis);
+  if (theta_o >= M_PI_F || len_squared(rotation_axis) == 0.0f) {
+    result.theta_o = M_PI_F;
+    return result;
+  }
+
+  /* Rotate axis of a towards b, so the new cone covers both. */
+  const Transform rotation = transform_rotate(theta_o - a.theta_o, normalize(rotation_axis));
+  result.axis = normalize(transform_direction(&rotation, a.axis));
+  result.theta_o = theta_o;
+  return result;
+}
+
+/* Orientation measure M_Omega from the paper: integral of the bounded cone of emission
+ * directions, weighted by the cosine falloff. */
+static float light_tree_orientation_measure(const LightTreeOrientation &orientation)
+{
+  const float theta_o = min(orientation.theta_o, M_PI_F);
+  const float theta_w = min(theta_o + orientation.theta_e, M_PI_F);
+  const float sin_theta_o = sinf(theta_o);
+  const float cos_theta_o = cosf(theta_o);
+  return M_2PI_F * (1.0f - cos_theta_o) +
+         M_PI_2_F * (2.0f * theta_w * sin_theta_o - cosf(theta_o - 2.0f * theta_w) -
+                     2.0f * theta_o * sin_theta_o + cos_theta_o);
+}
+
+/* Accumulated bounds of a set of primitives. */
+struct LightTreeBounds {
+  BoundBox bounds;
+  LightTreeOrientation orientation;
+  float energy;
+  int num_prims;
+
+  LightTreeBounds() : bounds(BoundBox::empty), energy(0.0f), num_prims(0)
+  {
+  }
+
+  void grow(const LightTreePrimitive &prim)
+  {
+    bounds.grow(prim.bounds);
+    orientation = (num_prims == 0) ?
+                      prim.orientation :
+                      light_tree_orientation_merge(orientation, prim.orientation);
+    energy += prim.energy;
+    num_prims++;
+  }
+
+  void grow(const LightTreeBounds &other)
+  {
+    if (other.num_prims == 0) {
+      return;
+    }
+    bounds.grow(other.bounds);
+    orientation = (num_prims == 0) ? other.orientation :
+                                     light_tree_orientation_merge(orientation, other.orientation);
+    energy += other.energy;
+    num_prims += other.num_prims;
+  }
+
+  float cost() const
+  {
+    return energy * bounds.safe_area() * light_tree_orientation_measure(orientation);
+  }
+};
+
+LightTree::LightTree(vector<LightTreePrimitive> &prims, int max_prims_in_leaf)
+    : prims_(prims), max_prims_in_leaf_(max(max_prims_in_leaf, 1))
+{
+  if (prims_.empty()) {
+    return;
+  }
+  nodes.reserve(2 * prims_.size() / max_prims_in_leaf_ + 1);
+  emitters.resize(prims_.size());
+  recursive_build(0, prims_.size(), -1, 0);
+}
+
+int LightTree::recursive_build(int start, int end, int parent_index, int depth)
+{
+  LightTreeBounds node_bounds;
+  BoundBox centroid_bounds = BoundBox::empty;
+  for (int i = start; i < end; i++) {
+    node_bounds.grow(prims_[i]);
+    centroid_bounds.grow(prims_[i].centroid);
+  }
+
+  const int node_index = nodes.size();
+  nodes.push_back(KernelLightTreeNode());
+  KernelLightTreeNode &node = nodes[node_index];
+  node.bbox_min[0] = node_bounds.bounds.min.x;
+  node.bbox_min[1] = node_bounds.bounds.min.y;
+  node.bbox_min[2] = node_bounds.bounds.min.z;
+  node.bbox_max[0] = node_bounds.bounds.max.x;
+  node.bbox_max[1] = node_bounds.bounds.max.y;
+  node.bbox_max[2] = node_bounds.bounds.max.z;
+  node.energy = node_bounds.energy;
+  node.axis[0] = node_bounds.orientation.axis.x;
+  node.axis[1] = node_bounds.orientation.axis.y;
+  node.axis[2] = node_bounds.orientation.axis.z;
+  node.theta_o = node_bounds.orientation.theta_o;
+  node.theta_e = node_bounds.orientation.theta_e;
+  node.parent_index = parent_index;
+  node.child_index = -1;
+  node.first_emitter = -1;
+  node.num_emitters = 0;
+
+  const int num_prims = end - start;
+  if (num_prims <= max_prims_in_leaf_) {
+    node.first_emitter = start;
+    node.num_emitters = num_prims;
+    for (int i = start; i < end; i++) {
+      KernelLightTreeEmitter &emitter = emitters[i];
+      emitter.energy = prims_[i].energy;
+      emitter.pdf_flat = prims_[i].pdf_flat;
+      emitter.distribution_index = prims_[i].distribution_index;
+      emitter.node_index = node_index;
+    }
+    return node_index;
+  }
+
+  int middle = -1;
+  if (depth < LIGHT_TREE_MAX_HEURISTIC_DEPTH && node_bounds.energy > 0.0f) {
+    middle = find_split(start,
+                        end,
+                        node_bounds.bounds,
+                        centroid_bounds,
+                        node_bounds.orientation,
+                        node_bounds.energy);
+  }
+  if (middle <= start || middle >= end) {
+    /* Median split along the longest centroid axis. */
+    const float3 extent = centroid_bounds.size();
+    const int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 :
+                                                                       (extent.y >= extent.z) ? 1 :
+                                                                                                2;
+    middle = (start + end) / 2;
+    std::nth_element(prims_.begin() + start,
+                     prims_.begin() + middle,
+                     prims_.begin() + end,
+                     [axis](const LightTreePrimitive &a, const LightTreePrimitive &b) {
+                       return a.centroid[axis] < b.centroid[axis];
+                     });
+  }
+
+  /* Node reference is not valid after children are added. */
+  recursive_build(start, middle, node_index, depth + 1);
+  const int right_index = recursive_build(middle, end, node_index, depth + 1);
+  nodes[node_index].child_index = right_index;
+  return node_index;
+}
+
+int LightTree::find_split(int start,
+                          int end,
+                          const BoundBox &bounds,
+                          const BoundBox &centroid_bounds,
+                          const LightTreeOrientation &orientation,
+                          float energy)
+{
+  const float3 extent = centroid_bounds.size();
+  const float max_extent = max3(extent);
+  const float inv_node_cost = 1.0f /
+                              max(energy * bounds.safe_area() *
+                                      light_tree_orientation_measure(orientation),
+                                  FLT_MIN);
+
+  float min_cost = FLT_MAX;
+  int min_axis = -1, min_bin = -1;
+
+  for (int axis = 0; axis < 3; axis++) {
+    if (extent[axis] == 0.0f) {
+      continue;
+    }
+
+    const float inv_extent = 1.0f / extent[axis];
+    LightTreeBounds bins[LIGHT_TREE_NUM_BINS];
+    for (int i = start; i < end; i++) {
+      const LightTreePrimitive &prim = prims_[i];
+      const int bin = min(int(LIGHT_TREE_NUM_BINS * (prim.centroid[axis] - centroid_bounds.min[axis]) *
+                              inv_extent),
+                          LIGHT_TREE_NUM_BINS - 1);
+      bins[bin].grow(prim);
+    }
+
+    /* Sweep from the right to get bounds of everything past each split plane. */
+    LightTreeBounds right_bounds[LIGHT_TREE_NUM_BINS];
+    right_bounds[LIGHT_TREE_NUM_BINS - 1] = bins[LIGHT_TREE_NUM_BINS - 1];
+    for (int i = LIGHT_TREE_NUM_BINS - 2; i > 0; i--) {
+      right_bounds[i] = right_bounds[i + 1];
+      right_bounds[i].grow(bins[i]);
+    }
+
+    /* Regularization factor from the paper, avoids thin slabs on short axes. */
+    const float regularization = max_extent * inv_extent;
+
+    LightTreeBounds left_bounds;
+    for (int split = 0; split < LIGHT_TREE_NUM_BINS - 1; split++) {
+      left_bounds.grow(bins[split]);
+      const LightTreeBounds &right = right_bounds[split + 1];
+      if (left_bounds.num_prims == 0 || right.num_prims == 0) {
+        continue;
+      }
+      const float cost = regularization * (left_bounds.cost() + right.cost()) * inv_node_cost;
+      if (cost < min_cost) {
+        min_cost = cost;
+        min_axis = axis;
+        min_bin = split;
+      }
+    }
+  }
+
+  if (min_axis == -1) {
+    return -1;
+  }
+
+  const float min_value = centroid_bounds.min[min_axis];
+  const float inv_extent = 1.0f / extent[min_axis];
+  const int axis = min_axis, split_bin = min_bin;
+  vector<LightTreePrimitive>::iterator middle = std::partition(
+      prims_.begin() + start,
+      prims_.begin() + end,
+      [axis, split_bin, min_value, inv_extent](const LightTreePrimitive &prim) {
+        const int bin = min(int(LIGHT_TREE_NUM_BINS * (prim.centroid[axis] - min_value) *
+                                inv_extent),
+                            LIGHT_TREE_NUM_BINS - 1);
+        return bin <= split_bin;
+      });
+  return middle - prims_.begin();
+}
+
+CCL_NAMESPACE_END
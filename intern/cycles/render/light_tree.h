@@ -0,0 +1,74 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIGHT_TREE_H__
+#define __LIGHT_TREE_H__
+
+#include "kernel/kernel_types.h"
+
+#include "util/util_boundbox.h"
+#include "util/util_types.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Orientation bounds of a set of emitters: all normals are within theta_o of the axis, and
+ * every emitter radiates within theta_e of its normal. */
+struct LightTreeOrientation {
+  float3 axis;
+  float theta_o;
+  float theta_e;
+};
+
+/* Emitter as seen by the light tree builder. */
+struct LightTreePrimitive {
+  BoundBox bounds;
+  float3 centroid;
+  LightTreeOrientation orientation;
+  float energy;
+  float pdf_flat;
+  int distribution_index;
+};
+
+/* Light tree for importance sampling of many lights.
+ *
+ * Based on "Importance Sampling of Many Lights with Adaptive Tree Splitting" by Conty Estevez and
+ * Kulla. Nodes are split using the surface area orientation heuristic, with primitives binned on
+ * their centroids. Primitives are reordered during the build, so emitters[i] corresponds to
+ * prims[i] after construction. */
+class LightTree {
+ public:
+  LightTree(vector<LightTreePrimitive> &prims, int max_prims_in_leaf);
+
+  vector<KernelLightTreeNode> nodes;
+  vector<KernelLightTreeEmitter> emitters;
+
+ protected:
+  int recursive_build(int start, int end, int parent_index, int depth);
+  int find_split(int start,
+                 int end,
+                 const BoundBox &bounds,
+                 const BoundBox &centroid_bounds,
+                 const LightTreeOrientation &orientation,
+                 float energy);
+
+  vector<LightTreePrimitive> &prims_;
+  int max_prims_in_leaf_;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __LIGHT_TREE_H__ */
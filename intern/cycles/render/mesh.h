@@ -166,6 +166,29 @@ class Mesh : public Geometry {
   friend class DiagSplit;
   friend class GeometryManager;
 
+  /* Diced geometry from the last tessellation, before displacement. Kept when the mesh is
+   * cleared, so it can be reused when the mesh is synced again with the same control mesh,
+   * dicing parameters and dicing camera. Only used for viewport and persistent data renders,
+   * as it doubles the memory used by diced geometry. */
+  struct SubdDiceCache {
+    uint key;
+    size_t num_subd_verts;
+    array<float3> verts;
+    array<float3> vert_normals;
+    array<float2> vert_patch_uv;
+    array<int> triangles;
+    array<int> shader;
+    array<bool> smooth;
+    array<int> triangle_patch;
+    unordered_map<int, int> vert_to_stitching_key_map;
+    unordered_multimap<int, int> vert_stitching_map;
+  };
+  SubdDiceCache *subd_dice_cache;
+
+  uint subd_dice_cache_key() const;
+  void subd_dice_cache_store(uint key);
+  void subd_dice_cache_restore();
+
  public:
   /* Functions */
   Mesh();
@@ -202,7 +225,7 @@ class Mesh : public Geometry {
                   size_t tri_offset);
   void pack_patches(uint *patch_data, uint vert_offset, uint face_offset, uint corner_offset);
 
-  void tessellate(DiagSplit *split);
+  void tessellate(DiagSplit *split, bool use_dice_cache = false);
 };
 
 CCL_NAMESPACE_END
@@ -25,6 +25,7 @@
 #include "util/util_map.h"
 #include "util/util_progress.h"
 #include "util/util_set.h"
+#include "util/util_task.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -43,33 +44,26 @@ static float3 compute_face_normal(const Mesh::Triangle &t, float3 *verts)
   return norm / normlen;
 }
 
-bool GeometryManager::displace(
-    Device *device, DeviceScene *dscene, Scene *scene, Mesh *mesh, Progress &progress)
+/* Maximum number of vertices evaluated in one shader task, bounds the memory used for
+ * host and device input and output buffers. Meshes with more vertices are evaluated on
+ * their own. */
+#define DISPLACE_MAX_BATCH_VERTS (1 << 24)
+
+/* Vertices of a mesh to displace, in the order they are evaluated. */
+struct DisplaceMesh {
+  Mesh *mesh;
+  size_t object_index;
+  vector<uint4> input;
+  vector<int> verts;
+  size_t offset;
+};
+
+static void displace_collect(Scene *scene, DisplaceMesh *dmesh)
 {
-  /* verify if we have a displacement shader */
-  if (!mesh->has_true_displacement()) {
-    return false;
-  }
-
-  string msg = string_printf("Computing Displacement %s", mesh->name.c_str());
-  progress.set_status("Updating Mesh", msg);
-
-  /* find object index. todo: is arbitrary */
-  size_t object_index = OBJECT_NONE;
-
-  for (size_t i = 0; i < scene->objects.size(); i++) {
-    if (scene->objects[i]->geometry == mesh) {
-      object_index = i;
-      break;
-    }
-  }
+  Mesh *mesh = dmesh->mesh;
 
-  /* setup input for device task */
   const size_t num_verts = mesh->verts.size();
   vector<bool> done(num_verts, false);
-  device_vector<uint4> d_input(device, "displace_input", MEM_READ_ONLY);
-  uint4 *d_input_data = d_input.alloc(num_verts);
-  size_t d_input_size = 0;
 
   size_t num_triangles = mesh->num_triangles();
   for (size_t i = 0; i < num_triangles; i++) {
@@ -90,7 +84,7 @@ bool GeometryManager::displace(
       done[t.v[j]] = true;
 
       /* set up object, primitive and barycentric coordinates */
-      int object = object_index;
+      int object = dmesh->object_index;
       int prim = mesh->prim_offset + i;
       float u, v;
 
@@ -111,80 +105,185 @@ bool GeometryManager::displace(
 
       /* back */
       uint4 in = make_uint4(object, prim, __float_as_int(u), __float_as_int(v));
-      d_input_data[d_input_size++] = in;
+      dmesh->input.push_back(in);
+      dmesh->verts.push_back(t.v[j]);
     }
   }
+}
 
-  if (d_input_size == 0)
-    return false;
+bool GeometryManager::displace(Device *device,
+                               DeviceScene *dscene,
+                               Scene *scene,
+                               Progress &progress)
+{
+  /* find object index of meshes with displacement. todo: is arbitrary */
+  map<Geometry *, size_t> object_index;
 
-  /* run device task */
-  device_vector<float4> d_output(device, "displace_output", MEM_READ_WRITE);
-  d_output.alloc(d_input_size);
-  d_output.zero_to_device();
-  d_input.copy_to_device();
+  for (size_t i = 0; i < scene->objects.size(); i++) {
+    Geometry *geom = scene->objects[i]->geometry;
+    if (geom->need_update && geom->type == Geometry::MESH && geom->has_true_displacement() &&
+        object_index.find(geom) == object_index.end()) {
+      object_index[geom] = i;
+    }
+  }
 
-  /* needs to be up to data for attribute access */
-  device->const_copy_to("__data", &dscene->data, sizeof(dscene->data));
+  vector<DisplaceMesh> dmeshes;
 
-  DeviceTask task(DeviceTask::SHADER);
-  task.shader_input = d_input.device_pointer;
-  task.shader_output = d_output.device_pointer;
-  task.shader_eval_type = SHADER_EVAL_DISPLACE;
-  task.shader_x = 0;
-  task.shader_w = d_output.size();
-  task.num_samples = 1;
-  task.get_cancel = function_bind(&Progress::get_cancel, &progress);
+  foreach (Geometry *geom, scene->geometry) {
+    if (!(geom->need_update && geom->type == Geometry::MESH && geom->has_true_displacement())) {
+      continue;
+    }
 
-  device->task_add(task);
-  device->task_wait();
+    DisplaceMesh dmesh;
+    dmesh.mesh = static_cast<Mesh *>(geom);
+    map<Geometry *, size_t>::const_iterator it = object_index.find(geom);
+    dmesh.object_index = (it != object_index.end()) ? it->second : OBJECT_NONE;
+    dmesh.offset = 0;
+    dmeshes.push_back(dmesh);
+  }
 
-  if (progress.get_cancel()) {
-    d_input.free();
-    d_output.free();
+  if (dmeshes.empty()) {
     return false;
   }
 
-  d_output.copy_from_device(0, 1, d_output.size());
-  d_input.free();
+  progress.set_status("Updating Mesh", "Computing Displacement");
 
-  /* read result */
-  done.clear();
-  done.resize(num_verts, false);
-  int k = 0;
+  /* needs to be up to data for attribute access */
+  device->const_copy_to("__data", &dscene->data, sizeof(dscene->data));
 
-  float4 *offset = d_output.data();
+  /* Evaluate vertices of many meshes in a single shader task, so that small meshes do not
+   * each pay for a task and keep threads waiting on the slowest part of the mesh. */
+  bool displaced = false;
+  size_t batch_start = 0;
+
+  while (batch_start < dmeshes.size()) {
+    size_t batch_end = batch_start;
+    size_t batch_max_size = 0;
+
+    /* The number of mesh vertices bounds the number of displaced vertices, so the input is
+     * only collected for the meshes in this batch. */
+    while (batch_end < dmeshes.size() &&
+           (batch_end == batch_start ||
+            batch_max_size + dmeshes[batch_end].mesh->verts.size() <=
+                DISPLACE_MAX_BATCH_VERTS)) {
+      batch_max_size += dmeshes[batch_end].mesh->verts.size();
+      batch_end++;
+    }
 
-  Attribute *attr_mP = mesh->attributes.find(ATTR_STD_MOTION_VERTEX_POSITION);
-  for (size_t i = 0; i < num_triangles; i++) {
-    Mesh::Triangle t = mesh->get_triangle(i);
-    int shader_index = mesh->shader[i];
-    Shader *shader = (shader_index < mesh->used_shaders.size()) ?
-                         mesh->used_shaders[shader_index] :
-                         scene->default_surface;
+    /* setup input for device task, meshes are independent so collect them in parallel */
+    {
+      TaskPool pool;
+      for (size_t i = batch_start; i < batch_end; i++) {
+        pool.push(function_bind(&displace_collect, scene, &dmeshes[i]));
+      }
+      pool.wait_work();
+    }
 
-    if (!shader->has_displacement || shader->displacement_method == DISPLACE_BUMP) {
+    size_t batch_size = 0;
+    for (size_t i = batch_start; i < batch_end; i++) {
+      dmeshes[i].offset = batch_size;
+      batch_size += dmeshes[i].input.size();
+    }
+
+    if (batch_size == 0) {
+      batch_start = batch_end;
       continue;
     }
 
-    for (int j = 0; j < 3; j++) {
-      if (!done[t.v[j]]) {
-        done[t.v[j]] = true;
-        float3 off = float4_to_float3(offset[k++]);
-        /* Avoid illegal vertex coordinates. */
-        off = ensure_finite3(off);
-        mesh->verts[t.v[j]] += off;
-        if (attr_mP != NULL) {
-          for (int step = 0; step < mesh->motion_steps - 1; step++) {
-            float3 *mP = attr_mP->data_float3() + step * num_verts;
-            mP[t.v[j]] += off;
-          }
-        }
+    device_vector<uint4> d_input(device, "displace_input", MEM_READ_ONLY);
+    uint4 *d_input_data = d_input.alloc(batch_size);
+
+    for (size_t i = batch_start; i < batch_end; i++) {
+      const DisplaceMesh &dmesh = dmeshes[i];
+      if (dmesh.input.size()) {
+        memcpy(d_input_data + dmesh.offset,
+               dmesh.input.data(),
+               sizeof(uint4) * dmesh.input.size());
       }
     }
+
+    /* run device task */
+    device_vector<float4> d_output(device, "displace_output", MEM_READ_WRITE);
+    d_output.alloc(batch_size);
+    d_output.zero_to_device();
+    d_input.copy_to_device();
+
+    DeviceTask task(DeviceTask::SHADER);
+    task.shader_input = d_input.device_pointer;
+    task.shader_output = d_output.device_pointer;
+    task.shader_eval_type = SHADER_EVAL_DISPLACE;
+    task.shader_x = 0;
+    task.shader_w = d_output.size();
+    task.num_samples = 1;
+    task.get_cancel = function_bind(&Progress::get_cancel, &progress);
+
+    device->task_add(task);
+    device->task_wait();
+
+    if (progress.get_cancel()) {
+      d_input.free();
+      d_output.free();
+      return false;
+    }
+
+    d_output.copy_from_device(0, 1, d_output.size());
+    d_input.free();
+
+    /* scatter results back, each mesh only modifies its own data */
+    TaskPool pool;
+    for (size_t i = batch_start; i < batch_end; i++) {
+      DisplaceMesh &dmesh = dmeshes[i];
+      if (dmesh.input.size()) {
+        pool.push(function_bind(&GeometryManager::displace_apply,
+                                scene,
+                                dmesh.mesh,
+                                &dmesh.verts,
+                                d_output.data() + dmesh.offset));
+        displaced = true;
+      }
+    }
+    pool.wait_work();
+
+    d_output.free();
+
+    for (size_t i = batch_start; i < batch_end; i++) {
+      /* free memory early */
+      dmeshes[i].input.clear();
+      dmeshes[i].input.shrink_to_fit();
+      dmeshes[i].verts.clear();
+      dmeshes[i].verts.shrink_to_fit();
+    }
+
+    batch_start = batch_end;
   }
 
-  d_output.free();
+  return displaced;
+}
+
+void GeometryManager::displace_apply(Scene *scene,
+                                     Mesh *mesh,
+                                     const vector<int> *displace_verts,
+                                     const float4 *offset)
+{
+  const size_t num_verts = mesh->verts.size();
+  const size_t num_triangles = mesh->num_triangles();
+  vector<bool> done;
+
+  /* read result */
+  Attribute *attr_mP = mesh->attributes.find(ATTR_STD_MOTION_VERTEX_POSITION);
+  for (size_t k = 0; k < displace_verts->size(); k++) {
+    const int vert = (*displace_verts)[k];
+    float3 off = float4_to_float3(offset[k]);
+    /* Avoid illegal vertex coordinates. */
+    off = ensure_finite3(off);
+    mesh->verts[vert] += off;
+    if (attr_mP != NULL) {
+      for (int step = 0; step < mesh->motion_steps - 1; step++) {
+        float3 *mP = attr_mP->data_float3() + step * num_verts;
+        mP[vert] += off;
+      }
+    }
+  }
 
   /* stitch */
   unordered_set<int> stitch_keys;
@@ -390,8 +489,6 @@ bool GeometryManager::displace(
       }
     }
   }
-
-  return true;
 }
 
 CCL_NAMESPACE_END
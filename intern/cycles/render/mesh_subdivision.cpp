@@ -25,6 +25,8 @@
 #include "util/util_algorithm.h"
 #include "util/util_foreach.h"
 #include "util/util_hash.h"
+#include "util/util_logging.h"
+#include "util/util_murmurhash.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -366,14 +368,147 @@ struct OsdPatch : Patch {
 
 #endif
 
-void Mesh::tessellate(DiagSplit *split)
+/* Dice Cache */
+
+static uint subd_hash_float3(const float3 *data, size_t size, uint hash)
+{
+  /* Hash components only, float3 may contain uninitialized padding. */
+  for (size_t i = 0; i < size; i++) {
+    const float v[3] = {data[i].x, data[i].y, data[i].z};
+    hash = util_murmur_hash3(v, sizeof(v), hash);
+  }
+  return hash;
+}
+
+uint Mesh::subd_dice_cache_key() const
+{
+  const SubdParams &params = *subd_params;
+
+  const int sizes[6] = {subdivision_type,
+                        (int)verts.size(),
+                        (int)subd_faces.size(),
+                        (int)subd_face_corners.size(),
+                        (int)subd_creases.size(),
+                        num_ngons};
+  uint hash = util_murmur_hash3(sizes, sizeof(sizes), 0);
+
+  /* Control mesh. */
+  hash = subd_hash_float3(verts.data(), verts.size(), hash);
+  hash = util_murmur_hash3(
+      subd_face_corners.data(), sizeof(int) * subd_face_corners.size(), hash);
+  hash = util_murmur_hash3(
+      subd_creases.data(), sizeof(SubdEdgeCrease) * subd_creases.size(), hash);
+
+  for (size_t i = 0; i < subd_faces.size(); i++) {
+    const SubdFace &face = subd_faces[i];
+    const int data[5] = {
+        face.start_corner, face.num_corners, face.shader, face.smooth, face.ptex_offset};
+    hash = util_murmur_hash3(data, sizeof(data), hash);
+  }
+
+  const Attribute *attr_vN = subd_attributes.find(ATTR_STD_VERTEX_NORMAL);
+  if (attr_vN) {
+    hash = subd_hash_float3(attr_vN->data_float3(), verts.size(), hash);
+  }
+
+  /* Dicing parameters. */
+  const int iparams[4] = {
+      params.ptex, params.test_steps, params.split_threshold, params.max_level};
+  hash = util_murmur_hash3(iparams, sizeof(iparams), hash);
+  hash = util_murmur_hash3(&params.dicing_rate, sizeof(float), hash);
+  hash = util_murmur_hash3(&params.objecttoworld, sizeof(Transform), hash);
+
+  /* Dicing camera, all parameters used by Camera::world_to_raster_size(). */
+  const Camera *camera = params.camera;
+  if (camera) {
+    const int cam_iparams[3] = {camera->type, camera->full_width, camera->full_height};
+    hash = util_murmur_hash3(cam_iparams, sizeof(cam_iparams), hash);
+    hash = util_murmur_hash3(&camera->offscreen_dicing_scale, sizeof(float), hash);
+    hash = util_murmur_hash3(&camera->cameratoworld, sizeof(Transform), hash);
+    hash = util_murmur_hash3(&camera->worldtoraster, sizeof(ProjectionTransform), hash);
+    hash = util_murmur_hash3(
+        &camera->full_rastertocamera, sizeof(ProjectionTransform), hash);
+  }
+
+  return hash;
+}
+
+void Mesh::subd_dice_cache_store(uint key)
+{
+  if (!subd_dice_cache) {
+    subd_dice_cache = new SubdDiceCache();
+  }
+
+  SubdDiceCache &cache = *subd_dice_cache;
+  Attribute *attr_vN = attributes.find(ATTR_STD_VERTEX_NORMAL);
+
+  cache.key = key;
+  cache.num_subd_verts = num_subd_verts;
+  cache.verts = verts;
+  cache.vert_normals.resize(verts.size());
+  memcpy(cache.vert_normals.data(), attr_vN->data_float3(), sizeof(float3) * verts.size());
+  cache.vert_patch_uv = vert_patch_uv;
+  cache.triangles = triangles;
+  cache.shader = shader;
+  cache.smooth = smooth;
+  cache.triangle_patch = triangle_patch;
+  cache.vert_to_stitching_key_map = vert_to_stitching_key_map;
+  cache.vert_stitching_map = vert_stitching_map;
+}
+
+void Mesh::subd_dice_cache_restore()
 {
+  const SubdDiceCache &cache = *subd_dice_cache;
+
+  /* Same attributes as added by EdgeDice. */
+  attributes.add(ATTR_STD_VERTEX_NORMAL);
+  if (subd_params->ptex) {
+    attributes.add(ATTR_STD_PTEX_UV);
+    attributes.add(ATTR_STD_PTEX_FACE_ID);
+  }
+
+  num_subd_verts = cache.num_subd_verts;
+  verts = cache.verts;
+  vert_patch_uv = cache.vert_patch_uv;
+  triangles = cache.triangles;
+  shader = cache.shader;
+  smooth = cache.smooth;
+  triangle_patch = cache.triangle_patch;
+  vert_to_stitching_key_map = cache.vert_to_stitching_key_map;
+  vert_stitching_map = cache.vert_stitching_map;
+
+  attributes.resize();
+  Attribute *attr_vN = attributes.find(ATTR_STD_VERTEX_NORMAL);
+  memcpy(attr_vN->data_float3(), cache.vert_normals.data(), sizeof(float3) * verts.size());
+}
+
+/* Tessellation */
+
+void Mesh::tessellate(DiagSplit *split, bool use_dice_cache)
+{
+  /* Diced geometry only depends on the control mesh, dicing parameters and camera. Vertex
+   * attributes and displacement are applied after dicing, so they are not part of the key. */
+  const uint dice_key = (use_dice_cache) ? subd_dice_cache_key() : 0;
+  const bool dice_cached = use_dice_cache && subd_dice_cache && subd_dice_cache->key == dice_key;
+
+  if (!use_dice_cache) {
+    delete subd_dice_cache;
+    subd_dice_cache = NULL;
+  }
+
 #ifdef WITH_OPENSUBDIV
   OsdData osd_data;
   bool need_packed_patch_table = false;
 
   if (subdivision_type == SUBDIVISION_CATMULL_CLARK) {
-    if (subd_faces.size()) {
+    bool need_osd_data = !dice_cached;
+    foreach (const Attribute &attr, subd_attributes.attributes) {
+      if (attr.flags & ATTR_SUBDIVIDED) {
+        need_osd_data = true;
+      }
+    }
+
+    if (subd_faces.size() && need_osd_data) {
       osd_data.build_from_mesh(this);
     }
   }
@@ -435,7 +570,9 @@ void Mesh::tessellate(DiagSplit *split)
     }
 
     /* split patches */
-    split->split_patches(osd_patches.data(), sizeof(OsdPatch));
+    if (!dice_cached) {
+      split->split_patches(osd_patches.data(), sizeof(OsdPatch));
+    }
   }
   else
 #endif
@@ -531,7 +668,17 @@ void Mesh::tessellate(DiagSplit *split)
     }
 
     /* split patches */
-    split->split_patches(linear_patches.data(), sizeof(LinearQuadPatch));
+    if (!dice_cached) {
+      split->split_patches(linear_patches.data(), sizeof(LinearQuadPatch));
+    }
+  }
+
+  if (dice_cached) {
+    VLOG(1) << "Reusing diced geometry of mesh " << name;
+    subd_dice_cache_restore();
+  }
+  else if (use_dice_cache) {
+    subd_dice_cache_store(dice_key);
   }
 
   /* interpolate center points for attributes */
@@ -22,6 +22,7 @@
 #include "util/util_hash.h"
 #include "util/util_logging.h"
 #include "util/util_progress.h"
+#include "util/util_sparse_grid.h"
 #include "util/util_types.h"
 
 CCL_NAMESPACE_BEGIN
@@ -364,8 +365,37 @@ void VolumeMeshBuilder::convert_quads_to_tris(const vector<QuadData> &quads,
 struct VoxelAttributeGrid {
   float *data;
   int channels;
+  bool sparse;
 };
 
+/* Add nodes for all voxels in the box that are above the clipping value. */
+static void add_voxel_nodes(VolumeMeshBuilder &builder,
+                            const float *data,
+                            const int channels,
+                            const int3 &resolution,
+                            const int3 &box_min,
+                            const int3 &box_max,
+                            const float clipping)
+{
+  const int3 box_size = box_max - box_min;
+
+  for (int z = box_min.z; z < min(box_max.z, resolution.z); ++z) {
+    for (int y = box_min.y; y < min(box_max.y, resolution.y); ++y) {
+      for (int x = box_min.x; x < min(box_max.x, resolution.x); ++x) {
+        const int64_t voxel_index = compute_voxel_index(
+            box_size, x - box_min.x, y - box_min.y, z - box_min.z);
+
+        for (int c = 0; c < channels; c++) {
+          if (data[voxel_index * channels + c] >= clipping) {
+            builder.add_node_with_padding(x, y, z);
+            break;
+          }
+        }
+      }
+    }
+  }
+}
+
 void GeometryManager::create_volume_mesh(Mesh *mesh, Progress &progress)
 {
   string msg = string_printf("Computing Volume Mesh %s", mesh->name.c_str());
@@ -387,7 +417,7 @@ void GeometryManager::create_volume_mesh(Mesh *mesh, Progress &progress)
     ImageHandle &handle = attr.data_voxel();
     device_texture *image_memory = handle.image_memory();
     int3 resolution = make_int3(
-        image_memory->data_width, image_memory->data_height, image_memory->data_depth);
+        image_memory->info.width, image_memory->info.height, image_memory->info.depth);
 
     if (volume_params.resolution == make_int3(0, 0, 0)) {
       volume_params.resolution = resolution;
@@ -401,6 +431,7 @@ void GeometryManager::create_volume_mesh(Mesh *mesh, Progress &progress)
     VoxelAttributeGrid voxel_grid;
     voxel_grid.data = static_cast<float *>(image_memory->host_pointer);
     voxel_grid.channels = image_memory->data_elements;
+    voxel_grid.sparse = image_memory->info.use_sparse_grid;
     voxel_grids.push_back(voxel_grid);
 
     /* TODO: support multiple transforms. */
@@ -463,21 +494,48 @@ void GeometryManager::create_volume_mesh(Mesh *mesh, Progress &progress)
   VolumeMeshBuilder builder(&volume_params);
   const float clipping = mesh->volume_clipping;
 
-  for (int z = 0; z < resolution.z; ++z) {
-    for (int y = 0; y < resolution.y; ++y) {
-      for (int x = 0; x < resolution.x; ++x) {
-        int64_t voxel_index = compute_voxel_index(resolution, x, y, z);
-
-        for (size_t i = 0; i < voxel_grids.size(); ++i) {
-          const VoxelAttributeGrid &voxel_grid = voxel_grids[i];
-          const int channels = voxel_grid.channels;
+  foreach (const VoxelAttributeGrid &voxel_grid, voxel_grids) {
+    if (!voxel_grid.sparse) {
+      add_voxel_nodes(builder,
+                      voxel_grid.data,
+                      voxel_grid.channels,
+                      resolution,
+                      make_int3(0, 0, 0),
+                      resolution,
+                      clipping);
+      continue;
+    }
 
-          for (int c = 0; c < channels; c++) {
-            if (voxel_grid.data[voxel_index * channels + c] >= clipping) {
-              builder.add_node_with_padding(x, y, z);
-              break;
-            }
+    /* Only visit tiles with active voxels, empty tiles add no nodes. */
+    const int3 tiles = make_int3(sparse_grid_num_tiles(resolution.x),
+                                 sparse_grid_num_tiles(resolution.y),
+                                 sparse_grid_num_tiles(resolution.z));
+    const int *tile_index = (const int *)voxel_grid.data;
+    const size_t num_tiles = sparse_grid_num_tiles(resolution.x, resolution.y, resolution.z);
+    const float *voxels = voxel_grid.data +
+                          sparse_grid_index_texels(num_tiles,
+                                                   sizeof(float) * voxel_grid.channels) *
+                              voxel_grid.channels;
+    const int3 tile_size = make_int3(SPARSE_TILE_SIZE, SPARSE_TILE_SIZE, SPARSE_TILE_SIZE);
+
+    size_t index = 0;
+    for (int z = 0; z < tiles.z; ++z) {
+      for (int y = 0; y < tiles.y; ++y) {
+        for (int x = 0; x < tiles.x; ++x, ++index) {
+          const int tile = tile_index[index];
+          if (tile == SPARSE_TILE_EMPTY) {
+            continue;
           }
+
+          const int3 tile_min = make_int3(
+              x * SPARSE_TILE_SIZE, y * SPARSE_TILE_SIZE, z * SPARSE_TILE_SIZE);
+          add_voxel_nodes(builder,
+                          voxels + ((size_t)tile) * SPARSE_TILE_VOXELS * voxel_grid.channels,
+                          voxel_grid.channels,
+                          resolution,
+                          tile_min,
+                          tile_min + tile_size,
+                          clipping);
         }
       }
     }
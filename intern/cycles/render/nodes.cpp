@@ -2112,6 +2112,53 @@ BsdfNode::BsdfNode(const NodeType *node_type) : BsdfBaseNode(node_type)
 {
 }
 
+/* Test if a mix or add closure node still has another closure when the closure linked to
+ * this input is removed, so that removing it does not remove the surface. */
+static bool combine_closure_keeps_other_input(ShaderInput *to)
+{
+  ShaderNode *node = to->parent;
+  if (node->special_type != SHADER_SPECIAL_TYPE_COMBINE_CLOSURE) {
+    return false;
+  }
+
+  ShaderInput *closure1_in = node->input("Closure1");
+  ShaderInput *closure2_in = node->input("Closure2");
+  ShaderInput *other_in = (to == closure1_in) ? closure2_in : closure1_in;
+  if (!other_in->link || other_in->link == to->link) {
+    return false;
+  }
+
+  /* Mix closure folding would select this input. */
+  if (node->type == MixClosureNode::node_type && !node->input("Fac")->link) {
+    const float fac = static_cast<MixClosureNode *>(node)->fac;
+    if ((fac <= 0.0f && to == closure1_in) || (fac >= 1.0f && to == closure2_in)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void BsdfNode::constant_fold(const ConstantFolder &folder)
+{
+  ShaderInput *color_in = input("Color");
+
+  if (color_in->link || color != make_float3(0.0f, 0.0f, 0.0f)) {
+    return;
+  }
+
+  /* remove closures that can not contribute, so that mix and add closure nodes
+   * using them can be folded as well. A black BSDF is still an opaque surface, so
+   * it is kept when removing it would leave the shader without a surface. */
+  foreach (ShaderInput *to, folder.output->links) {
+    if (!combine_closure_keeps_other_input(to)) {
+      return;
+    }
+  }
+
+  folder.discard();
+}
+
 void BsdfNode::compile(SVMCompiler &compiler,
                        ShaderInput *param1,
                        ShaderInput *param2,
@@ -491,6 +491,7 @@ class BsdfNode : public BsdfBaseNode {
  public:
   explicit BsdfNode(const NodeType *node_type);
   SHADER_NODE_BASE_CLASS(BsdfNode)
+  void constant_fold(const ConstantFolder &folder);
 
   void compile(SVMCompiler &compiler,
                ShaderInput *param1,
@@ -30,6 +30,7 @@
 #include "render/particles.h"
 #include "render/scene.h"
 #include "render/shader.h"
+#include "render/stats.h"
 #include "render/svm.h"
 #include "render/tables.h"
 
@@ -37,6 +38,7 @@
 #include "util/util_guarded_allocator.h"
 #include "util/util_logging.h"
 #include "util/util_progress.h"
+#include "util/util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -74,6 +76,9 @@ DeviceScene::DeviceScene(Device *device)
       lights(device, "__lights", MEM_GLOBAL),
       light_background_marginal_cdf(device, "__light_background_marginal_cdf", MEM_GLOBAL),
       light_background_conditional_cdf(device, "__light_background_conditional_cdf", MEM_GLOBAL),
+      light_tree_nodes(device, "__light_tree_nodes", MEM_GLOBAL),
+      light_tree_emitters(device, "__light_tree_emitters", MEM_GLOBAL),
+      light_tree_lookup(device, "__light_tree_lookup", MEM_GLOBAL),
       particles(device, "__particles", MEM_GLOBAL),
       svm_nodes(device, "__svm_nodes", MEM_GLOBAL),
       shaders(device, "__shaders", MEM_GLOBAL),
@@ -84,6 +89,40 @@ DeviceScene::DeviceScene(Device *device)
   memset((void *)&data, 0, sizeof(data));
 }
 
+/* Records time spent in each step of the scene device update, a step ends when the next
+ * one starts or the timer goes out of scope. */
+class SceneUpdateTimer {
+ public:
+  explicit SceneUpdateTimer(NamedTimeStats *stats) : stats_(stats), name_(NULL), time_start_(0.0)
+  {
+  }
+
+  ~SceneUpdateTimer()
+  {
+    end_step();
+  }
+
+  void step(const char *name)
+  {
+    end_step();
+    name_ = name;
+    time_start_ = time_dt();
+  }
+
+ protected:
+  void end_step()
+  {
+    if (name_ != NULL) {
+      stats_->add_entry(NamedTimeEntry(name_, time_dt() - time_start_));
+      name_ = NULL;
+    }
+  }
+
+  NamedTimeStats *stats_;
+  const char *name_;
+  double time_start_;
+};
+
 Scene::Scene(const SceneParams &params_, Device *device)
     : name("Scene"),
       default_surface(NULL),
@@ -110,6 +149,7 @@ Scene::Scene(const SceneParams &params_, Device *device)
   particle_system_manager = new ParticleSystemManager();
   curve_system_manager = new CurveSystemManager();
   bake_manager = new BakeManager();
+  update_stats = new NamedTimeStats();
 
   /* OSL only works on the CPU */
   if (device->info.has_osl)
@@ -183,6 +223,7 @@ void Scene::free_memory(bool final)
     delete curve_system_manager;
     delete image_manager;
     delete bake_manager;
+    delete update_stats;
   }
 }
 
@@ -193,6 +234,9 @@ void Scene::device_update(Device *device_, Progress &progress)
 
   bool print_stats = need_data_update();
 
+  update_stats->clear();
+  SceneUpdateTimer update_timer(update_stats);
+
   /* The order of updates is important, because there's dependencies between
    * the different managers, using data computed by previous managers.
    *
@@ -204,101 +248,118 @@ void Scene::device_update(Device *device_, Progress &progress)
    * - Lookup tables are done a second time to handle film tables
    */
 
+  update_timer.step("Shaders");
   progress.set_status("Updating Shaders");
   shader_manager->device_update(device, &dscene, this, progress);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
+  update_timer.step("Background");
   progress.set_status("Updating Background");
   background->device_update(device, &dscene, this);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
+  update_timer.step("Camera");
   progress.set_status("Updating Camera");
   camera->device_update(device, &dscene, this);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
+  update_timer.step("Geometry Preprocess");
   geometry_manager->device_update_preprocess(device, this, progress);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
+  update_timer.step("Objects");
   progress.set_status("Updating Objects");
   object_manager->device_update(device, &dscene, this, progress);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
+  update_timer.step("Hair Systems");
   progress.set_status("Updating Hair Systems");
   curve_system_manager->device_update(device, &dscene, this, progress);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
+  update_timer.step("Particle Systems");
   progress.set_status("Updating Particle Systems");
   particle_system_manager->device_update(device, &dscene, this, progress);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
+  update_timer.step("Meshes");
   progress.set_status("Updating Meshes");
   geometry_manager->device_update(device, &dscene, this, progress);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
+  update_timer.step("Objects Flags");
   progress.set_status("Updating Objects Flags");
   object_manager->device_update_flags(device, &dscene, this, progress);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
+  update_timer.step("Images");
   progress.set_status("Updating Images");
   image_manager->device_update(device, this, progress);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
+  update_timer.step("Camera Volume");
   progress.set_status("Updating Camera Volume");
   camera->device_update_volume(device, &dscene, this);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
+  update_timer.step("Lookup Tables");
   progress.set_status("Updating Lookup Tables");
   lookup_tables->device_update(device, &dscene);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
+  update_timer.step("Lights");
   progress.set_status("Updating Lights");
   light_manager->device_update(device, &dscene, this, progress);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
+  update_timer.step("Integrator");
   progress.set_status("Updating Integrator");
   integrator->device_update(device, &dscene, this);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
+  update_timer.step("Film");
   progress.set_status("Updating Film");
   film->device_update(device, &dscene, this);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
+  update_timer.step("Lookup Tables");
   progress.set_status("Updating Lookup Tables");
   lookup_tables->device_update(device, &dscene);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
+  update_timer.step("Baking");
   progress.set_status("Updating Baking");
   bake_manager->device_update(device, &dscene, this, progress);
 
@@ -306,6 +367,7 @@ void Scene::device_update(Device *device_, Progress &progress)
     return;
 
   if (device->have_error() == false) {
+    update_timer.step("Device");
     progress.set_status("Updating Device", "Writing constant memory");
     device->const_copy_to("__data", &dscene.data, sizeof(dscene.data));
   }
@@ -405,6 +467,7 @@ void Scene::collect_statistics(RenderStats *stats)
 {
   geometry_manager->collect_statistics(this, stats);
   image_manager->collect_statistics(stats);
+  stats->sync.device = *update_stats;
 }
 
 CCL_NAMESPACE_END
@@ -56,6 +56,7 @@ class ShaderManager;
 class Progress;
 class BakeManager;
 class BakeData;
+class NamedTimeStats;
 class RenderStats;
 
 /* Scene Device Data */
@@ -108,6 +109,9 @@ class DeviceScene {
   device_vector<KernelLight> lights;
   device_vector<float2> light_background_marginal_cdf;
   device_vector<float2> light_background_conditional_cdf;
+  device_vector<KernelLightTreeNode> light_tree_nodes;
+  device_vector<KernelLightTreeEmitter> light_tree_emitters;
+  device_vector<int> light_tree_lookup;
 
   /* particles */
   device_vector<KernelParticle> particles;
@@ -167,9 +171,13 @@ class SceneParams {
   BVHType bvh_type;
   bool use_bvh_spatial_split;
   bool use_bvh_unaligned_nodes;
+  /* Store child bounds of BVH8 nodes quantized to 8 bits, halving the node size. */
+  bool use_bvh_quantized_nodes;
   int num_bvh_time_steps;
   bool persistent_data;
   int texture_limit;
+  /* Memory budget in MB for reading image textures on demand, 0 to disable. */
+  int texture_cache_size;
 
   bool background;
 
@@ -180,9 +188,11 @@ class SceneParams {
     bvh_type = BVH_DYNAMIC;
     use_bvh_spatial_split = false;
     use_bvh_unaligned_nodes = true;
+    use_bvh_quantized_nodes = false;
     num_bvh_time_steps = 0;
     persistent_data = false;
     texture_limit = 0;
+    texture_cache_size = 0;
     background = true;
   }
 
@@ -192,8 +202,10 @@ class SceneParams {
              bvh_type == params.bvh_type &&
              use_bvh_spatial_split == params.use_bvh_spatial_split &&
              use_bvh_unaligned_nodes == params.use_bvh_unaligned_nodes &&
+             use_bvh_quantized_nodes == params.use_bvh_quantized_nodes &&
              num_bvh_time_steps == params.num_bvh_time_steps &&
-             persistent_data == params.persistent_data && texture_limit == params.texture_limit);
+             persistent_data == params.persistent_data && texture_limit == params.texture_limit &&
+             texture_cache_size == params.texture_cache_size);
   }
 };
 
@@ -229,6 +241,9 @@ class Scene {
   CurveSystemManager *curve_system_manager;
   BakeManager *bake_manager;
 
+  /* time spent in each step of the last device update */
+  NamedTimeStats *update_stats;
+
   /* default shaders */
   Shader *default_surface;
   Shader *default_volume;
@@ -61,6 +61,11 @@ Session::Session(const SessionParams &params_)
 
   TaskScheduler::init(params.threads);
 
+  /* Every CPU thread acquires its own tiles. */
+  if (params.use_tile_splitting && params.device.type == DEVICE_CPU) {
+    tile_manager.num_split_workers = TaskScheduler::num_threads();
+  }
+
   device = Device::create(params.device, stats, profiler, params.background);
 
   if (params.background && !params.write_render_cb) {
@@ -110,17 +115,7 @@ Session::~Session()
   }
 
   if (params.write_render_cb) {
-    /* Copy to display buffer and write out image if requested */
-    delete display;
-
-    display = new DisplayBuffer(device, false);
-    display->reset(buffers->params);
-    copy_to_display_buffer(params.samples);
-
-    int w = display->draw_width;
-    int h = display->draw_height;
-    uchar4 *pixels = display->rgba_byte.copy_from_device(0, w, h);
-    params.write_render_cb((uchar *)pixels, w, h, 4);
+    write_render();
   }
 
   /* clean up */
@@ -134,6 +129,21 @@ Session::~Session()
   TaskScheduler::exit();
 }
 
+void Session::write_render()
+{
+  /* Copy to display buffer and write out image. */
+  delete display;
+
+  display = new DisplayBuffer(device, false);
+  display->reset(buffers->params);
+  copy_to_display_buffer(params.samples);
+
+  int w = display->draw_width;
+  int h = display->draw_height;
+  uchar4 *pixels = display->rgba_byte.copy_from_device(0, w, h);
+  params.write_render_cb((uchar *)pixels, w, h, 4);
+}
+
 void Session::start()
 {
   if (!session_thread) {
@@ -1296,6 +1306,11 @@ void Session::device_free()
 void Session::collect_statistics(RenderStats *render_stats)
 {
   scene->collect_statistics(render_stats);
+
+  double total_time;
+  progress.get_time(total_time, render_stats->render_time);
+  render_stats->pixel_samples = progress.get_pixel_samples();
+
   if (params.use_profiling && (params.device.type == DEVICE_CPU)) {
     render_stats->collect_profiling(scene, profiler);
   }
@@ -57,6 +57,9 @@ class SessionParams {
   int pixel_size;
   int threads;
   bool adaptive_sampling;
+  /* Split tiles at the end of a final render to keep all CPU threads busy. Tiles then no
+   * longer match the render result tiles on the host side. */
+  bool use_tile_splitting;
 
   bool use_profiling;
 
@@ -91,6 +94,7 @@ class SessionParams {
     pixel_size = 1;
     threads = 0;
     adaptive_sampling = false;
+    use_tile_splitting = true;
 
     use_profiling = false;
 
@@ -120,6 +124,7 @@ class SessionParams {
              tile_size == params.tile_size && start_resolution == params.start_resolution &&
              pixel_size == params.pixel_size && threads == params.threads &&
              adaptive_sampling == params.adaptive_sampling &&
+             use_tile_splitting == params.use_tile_splitting &&
              use_profiling == params.use_profiling &&
              display_buffer_linear == params.display_buffer_linear &&
              cancel_timeout == params.cancel_timeout && reset_timeout == params.reset_timeout &&
@@ -157,6 +162,11 @@ class Session {
   bool draw(BufferParams &params, DeviceDrawParams &draw_params);
   void wait();
 
+  /* Write the render result with params.write_render_cb. This is done automatically when the
+   * session is destroyed, but can be used to write results in between when the same session
+   * renders multiple scenes. */
+  void write_render();
+
   bool ready_to_reset();
   void reset(BufferParams &params, int samples);
   void set_pause(bool pause);
@@ -40,11 +40,35 @@ bool namedTimeSampleEntryComparator(const NamedNestedSampleStats &a,
   return a.sum_samples > b.sum_samples;
 }
 
+bool namedBVHBuildEntryComparator(const NamedBVHBuildEntry &a, const NamedBVHBuildEntry &b)
+{
+  return a.stats.total_time() > b.stats.total_time();
+}
+
 bool namedSampleCountPairComparator(const NamedSampleCountPair &a, const NamedSampleCountPair &b)
 {
   return a.samples > b.samples;
 }
 
+/* Quoted JSON string, with quotes, backslashes and control characters escaped. */
+string json_string(const string &str)
+{
+  string result = "\"";
+  foreach (const char ch, str) {
+    if (ch == '"' || ch == '\\') {
+      result += '\\';
+      result += ch;
+    }
+    else if ((unsigned char)ch < 0x20) {
+      result += string_printf("\\u%04x", ch);
+    }
+    else {
+      result += ch;
+    }
+  }
+  return result + "\"";
+}
+
 }  // namespace
 
 NamedSizeEntry::NamedSizeEntry() : name(""), size(0)
@@ -142,10 +166,34 @@ string NamedNestedSampleStats::full_report(int indent_level, uint64_t total_samp
   return result;
 }
 
+string NamedNestedSampleStats::json_report()
+{
+  update_sum();
+
+  string result = string_printf("{\"name\":%s,\"total_time\":%.3f,\"self_time\":%.3f",
+                                json_string(name).c_str(),
+                                sum_samples * 0.001,
+                                self_samples * 0.001);
+
+  result += ",\"entries\":[";
+
+  sort(entries.begin(), entries.end(), namedTimeSampleEntryComparator);
+  for (size_t i = 0; i < entries.size(); i++) {
+    if (i > 0) {
+      result += ",";
+    }
+    result += entries[i].json_report();
+  }
+  return result + "]}";
+}
+
 /* Named sample count pairs. */
 
-NamedSampleCountPair::NamedSampleCountPair(const ustring &name, uint64_t samples, uint64_t hits)
-    : name(name), samples(samples), hits(hits)
+NamedSampleCountPair::NamedSampleCountPair(const ustring &name,
+                                           uint64_t samples,
+                                           uint64_t hits,
+                                           uint64_t svm_nodes)
+    : name(name), samples(samples), hits(hits), svm_nodes(svm_nodes)
 {
 }
 
@@ -153,23 +201,26 @@ NamedSampleCountStats::NamedSampleCountStats()
 {
 }
 
-void NamedSampleCountStats::add(const ustring &name, uint64_t samples, uint64_t hits)
+void NamedSampleCountStats::add(const ustring &name,
+                                uint64_t samples,
+                                uint64_t hits,
+                                uint64_t svm_nodes)
 {
   entry_map::iterator entry = entries.find(name);
   if (entry != entries.end()) {
     entry->second.samples += samples;
     entry->second.hits += hits;
+    entry->second.svm_nodes += svm_nodes;
     return;
   }
-  entries.emplace(name, NamedSampleCountPair(name, samples, hits));
+  entries.emplace(name, NamedSampleCountPair(name, samples, hits, svm_nodes));
 }
 
-string NamedSampleCountStats::full_report(int indent_level)
+vector<NamedSampleCountPair> NamedSampleCountStats::sorted_entries(
+    double *avg_samples_per_hit) const
 {
-  const string indent(indent_level * kIndentNumSpaces, ' ');
-
-  vector<NamedSampleCountPair> sorted_entries;
-  sorted_entries.reserve(entries.size());
+  vector<NamedSampleCountPair> result;
+  result.reserve(entries.size());
 
   uint64_t total_hits = 0, total_samples = 0;
   foreach (entry_map::const_reference entry, entries) {
@@ -178,24 +229,66 @@ string NamedSampleCountStats::full_report(int indent_level)
     total_hits += pair.hits;
     total_samples += pair.samples;
 
-    sorted_entries.push_back(pair);
+    result.push_back(pair);
   }
-  const double avg_samples_per_hit = ((double)total_samples) / total_hits;
+  *avg_samples_per_hit = ((double)total_samples) / total_hits;
 
-  sort(sorted_entries.begin(), sorted_entries.end(), namedSampleCountPairComparator);
+  sort(result.begin(), result.end(), namedSampleCountPairComparator);
+  return result;
+}
+
+string NamedSampleCountStats::full_report(int indent_level)
+{
+  const string indent(indent_level * kIndentNumSpaces, ' ');
+
+  double avg_samples_per_hit;
+  const vector<NamedSampleCountPair> sorted = sorted_entries(&avg_samples_per_hit);
 
   string result = "";
-  foreach (const NamedSampleCountPair &entry, sorted_entries) {
+  foreach (const NamedSampleCountPair &entry, sorted) {
     const double seconds = entry.samples * 0.001;
     const double relative = ((double)entry.samples) / (entry.hits * avg_samples_per_hit);
 
     result += indent +
               string_printf(
-                  "%-32s: %.2fs (Relative cost: %.2f)\n", entry.name.c_str(), seconds, relative);
+                  "%-32s: %.2fs (Relative cost: %.2f", entry.name.c_str(), seconds, relative);
+    if (entry.svm_nodes > 0 && entry.hits > 0) {
+      result += string_printf(", SVM nodes per hit: %.1f", ((double)entry.svm_nodes) / entry.hits);
+    }
+    result += ")\n";
   }
   return result;
 }
 
+string NamedSampleCountStats::json_report()
+{
+  double avg_samples_per_hit;
+  const vector<NamedSampleCountPair> sorted = sorted_entries(&avg_samples_per_hit);
+
+  string result = "[";
+  for (size_t i = 0; i < sorted.size(); i++) {
+    const NamedSampleCountPair &entry = sorted[i];
+    if (i > 0) {
+      result += ",";
+    }
+    result += string_printf("{\"name\":%s,\"time\":%.3f,\"hits\":%llu",
+                            json_string(entry.name.string()).c_str(),
+                            entry.samples * 0.001,
+                            (unsigned long long)entry.hits);
+    /* Entries that were never hit have no meaningful cost. */
+    if (entry.hits > 0 && avg_samples_per_hit > 0.0) {
+      const double relative = ((double)entry.samples) / (entry.hits * avg_samples_per_hit);
+      result += string_printf(",\"relative_cost\":%.3f", relative);
+      if (entry.svm_nodes > 0) {
+        result += string_printf(",\"svm_nodes_per_hit\":%.1f",
+                                ((double)entry.svm_nodes) / entry.hits);
+      }
+    }
+    result += "}";
+  }
+  return result + "]";
+}
+
 /* Mesh statistics. */
 
 MeshStats::MeshStats()
@@ -224,11 +317,122 @@ string ImageStats::full_report(int indent_level)
   return result;
 }
 
+/* BVH statistics. */
+
+NamedBVHBuildEntry::NamedBVHBuildEntry(const string &name, const BVHBuildStats &stats)
+    : name(name), stats(stats)
+{
+}
+
+BVHStats::BVHStats()
+{
+}
+
+void BVHStats::add_entry(const string &name, const BVHBuildStats &stats)
+{
+  if (stats.num_references == 0) {
+    return;
+  }
+  total.references_time += stats.references_time;
+  total.build_time += stats.build_time;
+  total.pack_time += stats.pack_time;
+  total.num_references += stats.num_references;
+  total.num_nodes += stats.num_nodes;
+  total.num_leaf_nodes += stats.num_leaf_nodes;
+  entries.push_back(NamedBVHBuildEntry(name, stats));
+}
+
+string BVHStats::full_report(int indent_level)
+{
+  const string indent(indent_level * kIndentNumSpaces, ' ');
+  const string double_indent = indent + indent;
+  string result = "";
+  result += string_printf("%sTotal time: %.2fs (references %.2fs, build %.2fs, pack %.2fs)\n",
+                          indent.c_str(),
+                          total.total_time(),
+                          total.references_time,
+                          total.build_time,
+                          total.pack_time);
+  result += string_printf("%sTotal references: %s, nodes: %s\n",
+                          indent.c_str(),
+                          string_human_readable_number(total.num_references).c_str(),
+                          string_human_readable_number(total.num_nodes).c_str());
+  sort(entries.begin(), entries.end(), namedBVHBuildEntryComparator);
+  foreach (const NamedBVHBuildEntry &entry, entries) {
+    result += string_printf("%s%-32s %.2fs (build %.2fs), references: %s, nodes: %s\n",
+                            double_indent.c_str(),
+                            entry.name.c_str(),
+                            entry.stats.total_time(),
+                            entry.stats.build_time,
+                            string_human_readable_number(entry.stats.num_references).c_str(),
+                            string_human_readable_number(entry.stats.num_nodes).c_str());
+  }
+  return result;
+}
+
+/* Time statistics. */
+
+NamedTimeEntry::NamedTimeEntry(const string &name, double time) : name(name), time(time)
+{
+}
+
+NamedTimeStats::NamedTimeStats() : total_time(0.0)
+{
+}
+
+void NamedTimeStats::add_entry(const NamedTimeEntry &entry)
+{
+  total_time += entry.time;
+  foreach (NamedTimeEntry &existing_entry, entries) {
+    if (existing_entry.name == entry.name) {
+      existing_entry.time += entry.time;
+      return;
+    }
+  }
+  entries.push_back(entry);
+}
+
+void NamedTimeStats::clear()
+{
+  total_time = 0.0;
+  entries.clear();
+}
+
+string NamedTimeStats::full_report(int indent_level)
+{
+  const string indent(indent_level * kIndentNumSpaces, ' ');
+  const string double_indent = indent + indent;
+  string result = "";
+  result += string_printf("%sTotal time: %.2fs\n", indent.c_str(), total_time);
+  foreach (const NamedTimeEntry &entry, entries) {
+    result += string_printf(
+        "%s%-32s %.2fs\n", double_indent.c_str(), entry.name.c_str(), entry.time);
+  }
+  return result;
+}
+
+/* Synchronization statistics. */
+
+SyncStats::SyncStats()
+{
+}
+
+string SyncStats::full_report(int indent_level)
+{
+  const string indent(indent_level * kIndentNumSpaces, ' ');
+  string result = "";
+  result += indent + "Host:\n" + host.full_report(indent_level + 1);
+  result += indent + "Device:\n" + device.full_report(indent_level + 1);
+  return result;
+}
+
 /* Overall statistics. */
 
 RenderStats::RenderStats()
 {
   has_profiling = false;
+  render_time = 0.0;
+  pixel_samples = 0;
 }
 
 void RenderStats::collect_profiling(Scene *scene, Profiler &prof)
@@ -286,9 +490,9 @@ void RenderStats::collect_profiling(Scene *scene, Profiler &prof)
 
   shaders.entries.clear();
   foreach (Shader *shader, scene->shaders) {
-    uint64_t samples, hits;
-    if (prof.get_shader(shader->id, samples, hits)) {
-      shaders.add(shader->name, samples, hits);
+    uint64_t samples, hits, svm_nodes;
+    if (prof.get_shader(shader->id, samples, hits, svm_nodes)) {
+      shaders.add(shader->name, samples, hits, svm_nodes);
     }
   }
 
@@ -306,6 +510,8 @@ string RenderStats::full_report()
   string result = "";
   result += "Mesh statistics:\n" + mesh.full_report(1);
   result += "Image statistics:\n" + image.full_report(1);
+  result += "BVH statistics:\n" + bvh.full_report(1);
+  result += "Synchronization statistics:\n" + sync.full_report(1);
   if (has_profiling) {
     result += "Kernel statistics:\n" + kernel.full_report(1);
     result += "Shader statistics:\n" + shaders.full_report(1);
@@ -317,4 +523,20 @@ string RenderStats::full_report()
   return result;
 }
 
+string RenderStats::profiling_json_report()
+{
+  const double samples_per_second = (render_time > 0.0) ? pixel_samples / render_time : 0.0;
+
+  string result = "{";
+  result += string_printf("\"render_time\":%.3f,", render_time);
+  result += string_printf("\"pixel_samples\":%llu,", (unsigned long long)pixel_samples);
+  result += string_printf("\"samples_per_second\":%.1f", samples_per_second);
+  if (has_profiling) {
+    result += ",\"kernel\":" + kernel.json_report();
+    result += ",\"shaders\":" + shaders.json_report();
+    result += ",\"objects\":" + objects.json_report();
+  }
+  return result + "}";
+}
+
 CCL_NAMESPACE_END
@@ -19,6 +19,8 @@
 
 #include "render/scene.h"
 
+#include "bvh/bvh_params.h"
+
 #include "util/util_stats.h"
 #include "util/util_string.h"
 #include "util/util_vector.h"
@@ -76,6 +78,9 @@ class NamedNestedSampleStats {
 
   string full_report(int indent_level = 0, uint64_t total_samples = 0);
 
+  /* Generate report as a JSON object, with times in seconds. */
+  string json_report();
+
   string name;
 
   /* self_samples contains only the samples that this specific event got,
@@ -90,11 +95,16 @@ class NamedNestedSampleStats {
  * This allows to estimate the time spent per item. */
 class NamedSampleCountPair {
  public:
-  NamedSampleCountPair(const ustring &name, uint64_t samples, uint64_t hits);
+  NamedSampleCountPair(const ustring &name,
+                       uint64_t samples,
+                       uint64_t hits,
+                       uint64_t svm_nodes = 0);
 
   ustring name;
   uint64_t samples;
   uint64_t hits;
+  /* Number of SVM nodes executed, only counted for shaders. */
+  uint64_t svm_nodes;
 };
 
 /* Contains statistics about pairs of samples and counts as described above. */
@@ -103,10 +113,19 @@ class NamedSampleCountStats {
   NamedSampleCountStats();
 
   string full_report(int indent_level = 0);
-  void add(const ustring &name, uint64_t samples, uint64_t hits);
+
+  /* Generate report as a JSON array of entries, most expensive first. */
+  string json_report();
+
+  void add(const ustring &name, uint64_t samples, uint64_t hits, uint64_t svm_nodes = 0);
 
   typedef unordered_map<ustring, NamedSampleCountPair, ustringHash> entry_map;
   entry_map entries;
+
+ protected:
+  /* Entries sorted by time, along with the average number of samples per hit of all entries
+   * which relative costs are measured against. */
+  vector<NamedSampleCountPair> sorted_entries(double *avg_samples_per_hit) const;
 };
 
 /* Statistics about mesh in the render database. */
@@ -135,6 +154,73 @@ class ImageStats {
   NamedSizeStats textures;
 };
 
+/* Named BVH build statistics entry. */
+class NamedBVHBuildEntry {
+ public:
+  NamedBVHBuildEntry(const string &name, const BVHBuildStats &stats);
+
+  string name;
+  BVHBuildStats stats;
+};
+
+/* Statistics about BVH builds, for geometry BVHs and the scene BVH. */
+class BVHStats {
+ public:
+  BVHStats();
+
+  /* Add entry to the statistics, skipping BVHs which were not built by us. */
+  void add_entry(const string &name, const BVHBuildStats &stats);
+
+  /* Generate full human-readable report. */
+  string full_report(int indent_level = 0);
+
+  /* Accumulated statistics of all entries. */
+  BVHBuildStats total;
+
+  vector<NamedBVHBuildEntry> entries;
+};
+
+/* Named entry of time spent in some step, in seconds. */
+class NamedTimeEntry {
+ public:
+  NamedTimeEntry(const string &name, double time);
+
+  string name;
+  double time;
+};
+
+/* Container of named time entries, kept in the order the steps happened. */
+class NamedTimeStats {
+ public:
+  NamedTimeStats();
+
+  /* Add entry to the statistics, accumulating into an existing entry with the same name. */
+  void add_entry(const NamedTimeEntry &entry);
+
+  void clear();
+
+  /* Generate full human-readable report. */
+  string full_report(int indent_level = 0);
+
+  /* Total time of all entries. */
+  double total_time;
+
+  vector<NamedTimeEntry> entries;
+};
+
+/* Time spent synchronizing the last frame: reading data from the host application,
+ * and updating the scene on the device. */
+class SyncStats {
+ public:
+  SyncStats();
+
+  /* Generate full human-readable report. */
+  string full_report(int indent_level = 0);
+
+  NamedTimeStats host;
+  NamedTimeStats device;
+};
+
 /* Render process statistics. */
 class RenderStats {
  public:
@@ -143,13 +229,22 @@ class RenderStats {
   /* Return full report as string. */
   string full_report();
 
+  /* Return kernel, shader and object profiling as a JSON object, for use by scripts. */
+  string profiling_json_report();
+
   /* Collect kernel sampling information from Stats. */
   void collect_profiling(Scene *scene, Profiler &prof);
 
   bool has_profiling;
 
+  /* Render time in seconds and number of samples rendered over all pixels. */
+  double render_time;
+  uint64_t pixel_samples;
+
   MeshStats mesh;
   ImageStats image;
+  BVHStats bvh;
+  SyncStats sync;
   NamedNestedSampleStats kernel;
   NamedSampleCountStats shaders;
   NamedSampleCountStats objects;
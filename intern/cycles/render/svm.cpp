@@ -177,6 +177,7 @@ SVMCompiler::SVMCompiler(Scene *scene) : scene(scene)
   background = false;
   mix_weight_offset = SVM_STACK_INVALID;
   compile_failed = false;
+  num_merged_constants = 0;
 }
 
 int SVMCompiler::stack_size(SocketType::Type type)
@@ -263,24 +264,47 @@ int SVMCompiler::stack_assign(ShaderInput *input)
       Node *node = input->parent;
 
       /* not linked to output -> add nodes to load default value */
-      input->stack_offset = stack_find_offset(input->type());
+      int4 value = make_int4(0, 0, 0, 0);
+      int size = stack_size(input->type());
 
       if (input->type() == SocketType::FLOAT) {
-        add_node(NODE_VALUE_F,
-                 __float_as_int(node->get_float(input->socket_type)),
-                 input->stack_offset);
+        value.x = __float_as_int(node->get_float(input->socket_type));
       }
       else if (input->type() == SocketType::INT) {
-        add_node(NODE_VALUE_F, node->get_int(input->socket_type), input->stack_offset);
+        value.x = node->get_int(input->socket_type);
       }
       else if (input->type() == SocketType::VECTOR || input->type() == SocketType::NORMAL ||
                input->type() == SocketType::POINT || input->type() == SocketType::COLOR) {
-
-        add_node(NODE_VALUE_V, input->stack_offset);
-        add_node(NODE_VALUE_V, node->get_float3(input->socket_type));
+        float3 f = node->get_float3(input->socket_type);
+        value = make_int4(__float_as_int(f.x), __float_as_int(f.y), __float_as_int(f.z), 0);
       }
       else /* should not get called for closure */
         assert(0);
+
+      /* reuse the stack offset if the same value was already loaded for this node */
+      foreach (const ConstantLoad &load, constant_loads) {
+        if (load.size == size && load.value.x == value.x && load.value.y == value.y &&
+            load.value.z == value.z) {
+          input->stack_offset = load.offset;
+          for (int i = 0; i < size; i++)
+            active_stack.users[load.offset + i]++;
+          num_merged_constants++;
+          return input->stack_offset;
+        }
+      }
+
+      input->stack_offset = stack_find_offset(size);
+
+      if (size == 1) {
+        add_node(NODE_VALUE_F, value.x, input->stack_offset);
+      }
+      else {
+        add_node(NODE_VALUE_V, input->stack_offset);
+        add_node(NODE_VALUE_V, value.x, value.y, value.z);
+      }
+
+      ConstantLoad load = {value, size, input->stack_offset};
+      constant_loads.push_back(load);
     }
   }
 
@@ -436,6 +460,7 @@ void SVMCompiler::generate_node(ShaderNode *node, ShaderNodeSet &done)
   node->compile(*this);
   stack_clear_users(node, done);
   stack_clear_temporary(node);
+  constant_loads.clear();
 
   if (current_type == SHADER_TYPE_SURFACE) {
     if (node->has_spatial_varying())
@@ -733,6 +758,7 @@ void SVMCompiler::compile_type(Shader *shader, ShaderGraph *graph, ShaderType ty
   /* clear all compiler state */
   memset((void *)&active_stack, 0, sizeof(active_stack));
   current_svm_nodes.clear();
+  constant_loads.clear();
 
   foreach (ShaderNode *node, graph->nodes) {
     foreach (ShaderInput *input, node->inputs)
@@ -901,6 +927,7 @@ void SVMCompiler::compile(Shader *shader, array<int4> &svm_nodes, int index, Sum
   if (summary != NULL) {
     summary->time_total = time_dt() - time_start;
     summary->peak_stack_usage = max_stack_use;
+    summary->num_merged_constants = num_merged_constants;
     summary->num_svm_nodes = svm_nodes.size() - start_num_svm_nodes;
   }
 }
@@ -910,6 +937,7 @@ void SVMCompiler::compile(Shader *shader, array<int4> &svm_nodes, int index, Sum
 SVMCompiler::Summary::Summary()
     : num_svm_nodes(0),
       peak_stack_usage(0),
+      num_merged_constants(0),
       time_finalize(0.0),
       time_generate_surface(0.0),
       time_generate_bump(0.0),
@@ -924,6 +952,7 @@ string SVMCompiler::Summary::full_report() const
   string report = "";
   report += string_printf("Number of SVM nodes: %d\n", num_svm_nodes);
   report += string_printf("Peak stack usage:    %d\n", peak_stack_usage);
+  report += string_printf("Merged constants:    %d\n", num_merged_constants);
 
   report += string_printf("Time (in seconds):\n");
   report += string_printf("Finalize:            %f\n", time_finalize);
@@ -69,6 +69,9 @@ class SVMCompiler {
     /* Peak stack usage during shader evaluation. */
     int peak_stack_usage;
 
+    /* Number of constant input loads shared with an identical load of the same node. */
+    int num_merged_constants;
+
     /* Time spent on surface graph finalization. */
     double time_finalize;
 
@@ -190,6 +193,13 @@ class SVMCompiler {
     vector<bool> nodes_done_flag;
   };
 
+  /* Constant value loaded onto the stack for an unlinked input. */
+  struct ConstantLoad {
+    int4 value;
+    int size;
+    int offset;
+  };
+
   void stack_clear_temporary(ShaderNode *node);
   int stack_size(SocketType::Type type);
   void stack_clear_users(ShaderNode *node, ShaderNodeSet &done);
@@ -221,6 +231,12 @@ class SVMCompiler {
   int max_stack_use;
   uint mix_weight_offset;
   bool compile_failed;
+
+  /* Constants loaded for the inputs of the node being compiled. Inputs with the same
+   * value read from the same stack offset, so a node with many default inputs (like the
+   * Principled BSDF) only loads each distinct value once. */
+  vector<ConstantLoad> constant_loads;
+  int num_merged_constants;
 };
 
 CCL_NAMESPACE_END
@@ -77,6 +77,13 @@ inline int2 hilbert_index_to_pos(int n, int d)
   return xy;
 }
 
+/* Tiles are only split while both halves cover at least this size squared in pixels, below
+ * that the per-tile overhead would dominate. */
+#define TILE_SPLIT_MIN_SIZE 16
+/* Maximum number of extra tiles created by splitting per worker, so that room for them can be
+ * reserved up front. Tile pointers must stay valid while other threads acquire tiles. */
+#define TILE_SPLIT_MAX_PER_WORKER 8
+
 enum SpiralDirection {
   DIRECTION_UP,
   DIRECTION_LEFT,
@@ -107,6 +114,7 @@ TileManager::TileManager(bool progressive_,
   preserve_tile_device = preserve_tile_device_;
   background = background_;
   schedule_denoising = false;
+  num_split_workers = 0;
 
   range_start_sample = 0;
   range_num_samples = -1;
@@ -382,6 +390,10 @@ void TileManager::set_tiles()
 
   state.num_tiles = gen_tiles(!background);
 
+  if (can_split_tiles()) {
+    state.tiles.reserve(state.tiles.size() + num_split_workers * TILE_SPLIT_MAX_PER_WORKER);
+  }
+
   state.buffer.width = image_w;
   state.buffer.height = image_h;
 
@@ -495,6 +507,57 @@ bool TileManager::finish_tile(const int index, const bool need_denoise, bool &de
   }
 }
 
+bool TileManager::can_split_tiles()
+{
+  /* Splitting breaks the regular grid used to find neighbors for denoising and overlapping
+   * slices, and tiles that are reused between passes must keep their device. */
+  return num_split_workers > 0 && !progressive && !preserve_tile_device && !schedule_denoising &&
+         slice_overlap == 0;
+}
+
+/* Split the largest tile in the list in two halves along its longest side, with the new half
+ * following it in the list. Returns false if no tile is large enough to split. */
+bool TileManager::split_tile(list<int> &tile_list)
+{
+  if (state.tiles.size() == state.tiles.capacity()) {
+    return false;
+  }
+
+  list<int>::iterator largest = tile_list.end();
+  int largest_size = 2 * TILE_SPLIT_MIN_SIZE * TILE_SPLIT_MIN_SIZE - 1;
+  for (list<int>::iterator it = tile_list.begin(); it != tile_list.end(); it++) {
+    const Tile &tile = state.tiles[*it];
+    const int size = tile.w * tile.h;
+    if (size > largest_size) {
+      largest = it;
+      largest_size = size;
+    }
+  }
+
+  if (largest == tile_list.end()) {
+    return false;
+  }
+
+  const int index = state.tiles.size();
+  Tile &tile = state.tiles[*largest];
+  if (tile.w >= tile.h) {
+    const int w = tile.w / 2;
+    state.tiles.push_back(
+        Tile(index, tile.x + w, tile.y, tile.w - w, tile.h, tile.device, Tile::RENDER));
+    tile.w = w;
+  }
+  else {
+    const int h = tile.h / 2;
+    state.tiles.push_back(
+        Tile(index, tile.x, tile.y + h, tile.w, tile.h - h, tile.device, Tile::RENDER));
+    tile.h = h;
+  }
+
+  tile_list.insert(++largest, index);
+  state.num_tiles++;
+  return true;
+}
+
 bool TileManager::next_tile(Tile *&tile, int device, uint tile_types)
 {
   /* Preserve device if requested, unless this is a separate denoising device that just wants to
@@ -542,8 +605,16 @@ bool TileManager::next_tile(Tile *&tile, int device, uint tile_types)
         }
       }
 
-      tile_index = state.render_tiles[logical_device].front();
-      state.render_tiles[logical_device].pop_front();
+      /* Towards the end of the pass, hand out smaller pieces of the remaining tiles so that the
+       * work is spread over all threads until the last sample. */
+      list<int> &tile_list = state.render_tiles[logical_device];
+      if (can_split_tiles()) {
+        while (tile_list.size() < (size_t)num_split_workers && split_tile(tile_list)) {
+        }
+      }
+
+      tile_index = tile_list.front();
+      tile_list.pop_front();
       break;
     }
 
@@ -133,8 +133,15 @@ class TileManager {
   /* Schedule tiles for denoising after they've been rendered. */
   bool schedule_denoising;
 
+  /* Number of threads acquiring tiles from this manager. When non-zero, the remaining tiles are
+   * split towards the end of a pass so that threads do not go idle while others are still
+   * rendering the last big tiles. */
+  int num_split_workers;
+
  protected:
   void set_tiles();
+  bool can_split_tiles();
+  bool split_tile(list<int> &tile_list);
 
   bool progressive;
   int2 tile_size;
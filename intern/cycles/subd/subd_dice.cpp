@@ -45,8 +45,9 @@ void EdgeDice::reserve(int num_verts, int num_triangles)
   vert_offset = mesh->verts.size();
   tri_offset = mesh->num_triangles();
 
-  mesh->resize_mesh(mesh->verts.size() + num_verts, mesh->num_triangles());
-  mesh->reserve_mesh(mesh->verts.size() + num_verts, mesh->num_triangles() + num_triangles);
+  /* Triangles are written at known indices rather than appended, so that subpatches can be
+   * diced in any order. */
+  mesh->resize_mesh(mesh->verts.size() + num_verts, mesh->num_triangles() + num_triangles);
 
   Attribute *attr_vN = mesh->attributes.add(ATTR_STD_VERTEX_NORMAL);
 
@@ -69,17 +70,23 @@ void EdgeDice::set_vert(Patch *patch, int index, float2 uv)
   params.mesh->vert_patch_uv[index + vert_offset] = make_float2(uv.x, uv.y);
 }
 
-void EdgeDice::add_triangle(Patch *patch, int v0, int v1, int v2)
+void EdgeDice::add_triangle(Patch *patch, int index, int v0, int v1, int v2)
 {
   Mesh *mesh = params.mesh;
+  const size_t tri = tri_offset + index;
 
-  mesh->add_triangle(v0 + vert_offset, v1 + vert_offset, v2 + vert_offset, patch->shader, true);
-  params.mesh->triangle_patch[params.mesh->num_triangles() - 1] = patch->patch_index;
+  assert(tri < mesh->num_triangles());
 
-  tri_offset++;
+  mesh->triangles[tri * 3 + 0] = v0 + vert_offset;
+  mesh->triangles[tri * 3 + 1] = v1 + vert_offset;
+  mesh->triangles[tri * 3 + 2] = v2 + vert_offset;
+  mesh->shader[tri] = patch->shader;
+  mesh->smooth[tri] = true;
+  mesh->triangle_patch[tri] = patch->patch_index;
 }
 
-void EdgeDice::stitch_triangles(Subpatch &sub, int edge)
+/* Adds triangles starting at the given index, returns the index after the last one. */
+int EdgeDice::stitch_triangles(Subpatch &sub, int edge, int triangle)
 {
   int Mu = max(sub.edge_u0.T, sub.edge_u1.T);
   int Mv = max(sub.edge_v0.T, sub.edge_v1.T);
@@ -90,7 +97,7 @@ void EdgeDice::stitch_triangles(Subpatch &sub, int edge)
   int inner_T = ((edge % 2) == 0) ? Mv - 2 : Mu - 2;
 
   if (inner_T < 0 || outer_T < 0)
-    return;  // XXX avoid crashes for Mu or Mv == 1, missing polygons
+    return triangle;  // XXX avoid crashes for Mu or Mv == 1, missing polygons
 
   /* stitch together two arrays of verts with triangles. at each step,
    * we compare using the next verts on both sides, to find the split
@@ -122,8 +129,10 @@ void EdgeDice::stitch_triangles(Subpatch &sub, int edge)
         v2 = sub.get_vert_along_grid_edge(edge, ++i);
     }
 
-    add_triangle(sub.patch, v1, v0, v2);
+    add_triangle(sub.patch, triangle++, v1, v0, v2);
   }
+
+  return triangle;
 }
 
 /* QuadDice */
@@ -224,7 +233,7 @@ float QuadDice::scale_factor(Subpatch &sub, int Mu, int Mv)
   return S;
 }
 
-void QuadDice::add_grid(Subpatch &sub, int Mu, int Mv, int offset)
+void QuadDice::add_grid(Subpatch &sub, int Mu, int Mv, int offset, int triangle)
 {
   /* create inner grid */
   float du = 1.0f / (float)Mu;
@@ -243,41 +252,64 @@ void QuadDice::add_grid(Subpatch &sub, int Mu, int Mv, int offset)
         int i3 = offset + i + j * (Mu - 1);
         int i4 = offset + (i - 1) + j * (Mu - 1);
 
-        add_triangle(sub.patch, i1, i2, i3);
-        add_triangle(sub.patch, i1, i3, i4);
+        add_triangle(sub.patch, triangle++, i1, i2, i3);
+        add_triangle(sub.patch, triangle++, i1, i3, i4);
       }
     }
   }
 }
 
-void QuadDice::dice(Subpatch &sub)
+static void quad_dice_grid_size(const Subpatch &sub, int *Mu, int *Mv)
 {
   /* compute inner grid size with scale factor */
-  int Mu = max(sub.edge_u0.T, sub.edge_u1.T);
-  int Mv = max(sub.edge_v0.T, sub.edge_v1.T);
+  *Mu = max(sub.edge_u0.T, sub.edge_u1.T);
+  *Mv = max(sub.edge_v0.T, sub.edge_v1.T);
 
 #if 0 /* Doesn't work very well, especially at grazing angles. */
-  float S = scale_factor(sub, ef, Mu, Mv);
+  float S = scale_factor(sub, ef, *Mu, *Mv);
 #else
   float S = 1.0f;
 #endif
 
-  Mu = max((int)ceilf(S * Mu), 2);  // XXX handle 0 & 1?
-  Mv = max((int)ceilf(S * Mv), 2);  // XXX handle 0 & 1?
+  *Mu = max((int)ceilf(S * *Mu), 2);  // XXX handle 0 & 1?
+  *Mv = max((int)ceilf(S * *Mv), 2);  // XXX handle 0 & 1?
+}
+
+void QuadDice::dice(Subpatch &sub)
+{
+  dice_grid(sub);
+  dice_sides(sub);
+  dice_stitch(sub);
+}
+
+void QuadDice::dice_grid(Subpatch &sub)
+{
+  int Mu, Mv;
+  quad_dice_grid_size(sub, &Mu, &Mv);
 
   /* inner grid */
-  add_grid(sub, Mu, Mv, sub.inner_grid_vert_offset);
+  add_grid(sub, Mu, Mv, sub.inner_grid_vert_offset, sub.triangle_offset);
+}
 
-  /* sides */
+void QuadDice::dice_sides(Subpatch &sub)
+{
   set_side(sub, 0);
   set_side(sub, 1);
   set_side(sub, 2);
   set_side(sub, 3);
+}
 
-  stitch_triangles(sub, 0);
-  stitch_triangles(sub, 1);
-  stitch_triangles(sub, 2);
-  stitch_triangles(sub, 3);
+void QuadDice::dice_stitch(Subpatch &sub)
+{
+  int Mu, Mv;
+  quad_dice_grid_size(sub, &Mu, &Mv);
+
+  /* stitch triangles follow the triangles of the inner grid */
+  int triangle = sub.triangle_offset + (Mu - 2) * (Mv - 2) * 2;
+  triangle = stitch_triangles(sub, 0, triangle);
+  triangle = stitch_triangles(sub, 1, triangle);
+  triangle = stitch_triangles(sub, 2, triangle);
+  triangle = stitch_triangles(sub, 3, triangle);
 }
 
 CCL_NAMESPACE_END
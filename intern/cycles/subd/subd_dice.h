@@ -72,9 +72,9 @@ class EdgeDice {
   void reserve(int num_verts, int num_triangles);
 
   void set_vert(Patch *patch, int index, float2 uv);
-  void add_triangle(Patch *patch, int v0, int v1, int v2);
+  void add_triangle(Patch *patch, int index, int v0, int v1, int v2);
 
-  void stitch_triangles(Subpatch &sub, int edge);
+  int stitch_triangles(Subpatch &sub, int edge, int triangle);
 };
 
 /* Quad EdgeDice */
@@ -88,7 +88,7 @@ class QuadDice : public EdgeDice {
   float2 map_uv(Subpatch &sub, float u, float v);
   void set_vert(Subpatch &sub, int index, float u, float v);
 
-  void add_grid(Subpatch &sub, int Mu, int Mv, int offset);
+  void add_grid(Subpatch &sub, int Mu, int Mv, int offset, int triangle);
 
   void set_side(Subpatch &sub, int edge);
 
@@ -96,6 +96,13 @@ class QuadDice : public EdgeDice {
   float scale_factor(Subpatch &sub, int Mu, int Mv);
 
   void dice(Subpatch &sub);
+
+  /* Dicing split in passes, for dicing many subpatches in parallel. Inner grids and
+   * triangles only write to verts and triangles owned by the subpatch, while edge verts
+   * are shared with neighboring subpatches and must be set before stitching. */
+  void dice_grid(Subpatch &sub);
+  void dice_sides(Subpatch &sub);
+  void dice_stitch(Subpatch &sub);
 };
 
 CCL_NAMESPACE_END
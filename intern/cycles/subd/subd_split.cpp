@@ -25,6 +25,7 @@
 #include "util/util_foreach.h"
 #include "util/util_hash.h"
 #include "util/util_math.h"
+#include "util/util_task.h"
 #include "util/util_types.h"
 
 CCL_NAMESPACE_BEGIN
@@ -35,6 +36,9 @@ CCL_NAMESPACE_BEGIN
 #define STITCH_NGON_CENTER_VERT_INDEX_OFFSET 0x60000000
 #define STITCH_NGON_SPLIT_EDGE_CENTER_VERT_TAG (0x60000000 - 1)
 
+/* Minimum number of triangles diced per task, to keep scheduling overhead low. */
+#define DSPLIT_MIN_DICE_TRIANGLES 4096
+
 DiagSplit::DiagSplit(const SubdParams &params_) : params(params_)
 {
 }
@@ -601,6 +605,23 @@ void DiagSplit::split_ngon(const Mesh::SubdFace &face, Patch *patches, size_t pa
   }
 }
 
+static void dice_subpatch_grids(QuadDice *dice, Subpatch *subpatches, size_t start, size_t end)
+{
+  for (size_t i = start; i < end; i++) {
+    dice->dice_grid(subpatches[i]);
+  }
+}
+
+static void dice_subpatch_stitches(QuadDice *dice,
+                                   Subpatch *subpatches,
+                                   size_t start,
+                                   size_t end)
+{
+  for (size_t i = start; i < end; i++) {
+    dice->dice_stitch(subpatches[i]);
+  }
+}
+
 void DiagSplit::post_split()
 {
   int num_stitch_verts = 0;
@@ -718,17 +739,11 @@ void DiagSplit::post_split()
   /* Dice; TODO(mai): Move this out of split. */
   QuadDice dice(params);
 
+  /* Prefix sums of inner verts and triangles, so every subpatch knows where its output goes
+   * and subpatches can be diced in parallel. */
   int num_verts = num_alloced_verts;
   int num_triangles = 0;
 
-  for (size_t i = 0; i < subpatches.size(); i++) {
-    subpatches[i].inner_grid_vert_offset = num_verts;
-    num_verts += subpatches[i].calc_num_inner_verts();
-    num_triangles += subpatches[i].calc_num_triangles();
-  }
-
-  dice.reserve(num_verts, num_triangles);
-
   for (size_t i = 0; i < subpatches.size(); i++) {
     Subpatch &sub = subpatches[i];
 
@@ -737,8 +752,49 @@ void DiagSplit::post_split()
     sub.edge_v0.T = max(sub.edge_v0.T, 1);
     sub.edge_v1.T = max(sub.edge_v1.T, 1);
 
-    dice.dice(sub);
+    sub.inner_grid_vert_offset = num_verts;
+    sub.triangle_offset = num_triangles;
+    num_verts += sub.calc_num_inner_verts();
+    num_triangles += sub.calc_num_triangles();
+  }
+
+  dice.reserve(num_verts, num_triangles);
+
+  /* Split subpatches into ranges of similar amounts of triangles. */
+  const int num_threads = TaskScheduler::num_threads();
+  const int range_triangles = max(num_triangles / max(num_threads * 8, 1),
+                                  DSPLIT_MIN_DICE_TRIANGLES);
+  vector<size_t> ranges;
+
+  ranges.push_back(0);
+  for (size_t i = 0; i < subpatches.size(); i++) {
+    if (subpatches[i].triangle_offset >= subpatches[ranges.back()].triangle_offset +
+                                             range_triangles) {
+      ranges.push_back(i);
+    }
+  }
+  ranges.push_back(subpatches.size());
+
+  /* Inner grids. */
+  TaskPool pool;
+  for (size_t i = 0; i + 1 < ranges.size(); i++) {
+    pool.push(function_bind(
+        &dice_subpatch_grids, &dice, subpatches.data(), ranges[i], ranges[i + 1]));
+  }
+  pool.wait_work();
+
+  /* Edge verts are shared between subpatches, set them in order so the result does not
+   * depend on scheduling. */
+  for (size_t i = 0; i < subpatches.size(); i++) {
+    dice.dice_sides(subpatches[i]);
+  }
+
+  /* Stitching triangles, which read the inner grid and edge verts. */
+  for (size_t i = 0; i + 1 < ranges.size(); i++) {
+    pool.push(function_bind(
+        &dice_subpatch_stitches, &dice, subpatches.data(), ranges[i], ranges[i + 1]));
   }
+  pool.wait_work();
 
   /* Cleanup */
   subpatches.clear();
@@ -294,6 +294,68 @@ TEST_F(RenderGraph, constant_fold_background2)
   graph.finalize(scene);
 }
 
+/*
+ * Tests:
+ *  - Black BSDF connected to the output is kept, so the surface stays opaque.
+ */
+TEST_F(RenderGraph, constant_fold_bsdf_black_output)
+{
+  EXPECT_ANY_MESSAGE(log);
+  INVALID_INFO_MESSAGE(log, "Discarding closure Diffuse.");
+
+  builder
+      .add_node(ShaderNodeBuilder<DiffuseBsdfNode>("Diffuse").set("Color",
+                                                                  make_float3(0.0f, 0.0f, 0.0f)))
+      .add_node(ShaderNodeBuilder<AbsorptionVolumeNode>("Absorption"))
+      .add_connection("Absorption::Volume", "Output::Volume")
+      .output_closure("Diffuse::BSDF");
+
+  graph.finalize(scene);
+
+  EXPECT_NE((void *)NULL, graph.output()->input("Surface")->link);
+}
+
+/*
+ * Tests:
+ *  - Black BSDF in an Add Closure is discarded, and the Add Closure folded.
+ *  - Black BSDF in a Mix Closure that would be left without closures is kept.
+ */
+TEST_F(RenderGraph, constant_fold_bsdf_black_shader_mix)
+{
+  EXPECT_ANY_MESSAGE(log);
+  CORRECT_INFO_MESSAGE(log, "Discarding closure Diffuse1.");
+  CORRECT_INFO_MESSAGE(log, "Folding AddClosure::Closure to socket Glossy::BSDF.");
+  INVALID_INFO_MESSAGE(log, "Discarding closure Diffuse2.");
+  INVALID_INFO_MESSAGE(log, "Discarding closure Diffuse3.");
+
+  builder.add_attribute("Attribute")
+      .add_node(ShaderNodeBuilder<DiffuseBsdfNode>("Diffuse1").set("Color",
+                                                                   make_float3(0.0f, 0.0f, 0.0f)))
+      .add_node(ShaderNodeBuilder<DiffuseBsdfNode>("Diffuse2").set("Color",
+                                                                   make_float3(0.0f, 0.0f, 0.0f)))
+      .add_node(ShaderNodeBuilder<DiffuseBsdfNode>("Diffuse3").set("Color",
+                                                                   make_float3(0.0f, 0.0f, 0.0f)))
+      .add_node(ShaderNodeBuilder<GlossyBsdfNode>("Glossy"))
+      .add_node(ShaderNodeBuilder<AddClosureNode>("AddClosure"))
+      .add_connection("Diffuse1::BSDF", "AddClosure::Closure1")
+      .add_connection("Glossy::BSDF", "AddClosure::Closure2")
+      /* both inputs black */
+      .add_node(ShaderNodeBuilder<MixClosureNode>("MixClosure1"))
+      .add_connection("Attribute::Fac", "MixClosure1::Fac")
+      .add_connection("Diffuse2::BSDF", "MixClosure1::Closure1")
+      .add_connection("Diffuse2::BSDF", "MixClosure1::Closure2")
+      /* choose the black input */
+      .add_node(ShaderNodeBuilder<MixClosureNode>("MixClosure2").set("Fac", 0.0f))
+      .add_connection("Diffuse3::BSDF", "MixClosure2::Closure1")
+      .add_connection("AddClosure::Closure", "MixClosure2::Closure2")
+      .add_node(ShaderNodeBuilder<AddClosureNode>("AddClosure2"))
+      .add_connection("MixClosure1::Closure", "AddClosure2::Closure1")
+      .add_connection("MixClosure2::Closure", "AddClosure2::Closure2")
+      .output_closure("AddClosure2::Closure");
+
+  graph.finalize(scene);
+}
+
 /*
  * Tests:
  *  - Folding of Add Closure with only one input.
@@ -15,6 +15,7 @@
  */
 
 #include "util/util_path.h"
+#include "util/util_algorithm.h"
 #include "util/util_md5.h"
 #include "util/util_string.h"
 
@@ -658,6 +659,25 @@ void path_create_directories(const string &filepath)
   create_directories_recursivey(path);
 }
 
+vector<string> path_list_files(const string &dir)
+{
+  vector<string> files;
+
+  if (path_is_directory(dir)) {
+    directory_iterator it(dir), it_end;
+
+    for (; it != it_end; ++it) {
+      string filepath = it->path();
+
+      if (!path_is_directory(filepath))
+        files.push_back(filepath);
+    }
+  }
+
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
 bool path_write_binary(const string &path, const vector<uint8_t> &binary)
 {
   path_create_directories(path);
@@ -53,6 +53,8 @@ uint64_t path_modified_time(const string &path);
 
 /* directory utility */
 void path_create_directories(const string &path);
+/* Full paths of the files in the directory, sorted by name. */
+vector<string> path_list_files(const string &dir);
 
 /* file read/write utilities */
 FILE *path_fopen(const string &path, const string &mode);
@@ -82,6 +82,7 @@ void Profiler::reset(int num_shaders, int num_objects)
   /* Resize and clear the accumulation vectors. */
   shader_hits.assign(num_shaders, 0);
   object_hits.assign(num_objects, 0);
+  shader_svm_nodes.assign(num_shaders, 0);
 
   event_samples.assign(PROFILING_NUM_EVENTS, 0);
   shader_samples.assign(num_shaders, 0);
@@ -121,6 +122,7 @@ void Profiler::add_state(ProfilingState *state)
   /* Resize thread-local hit counters. */
   state->shader_hits.assign(shader_hits.size(), 0);
   state->object_hits.assign(object_hits.size(), 0);
+  state->shader_svm_nodes.assign(shader_svm_nodes.size(), 0);
 
   /* Initialize the state. */
   state->event = PROFILING_UNKNOWN;
@@ -143,6 +145,11 @@ void Profiler::remove_state(ProfilingState *state)
     shader_hits[i] += state->shader_hits[i];
   }
 
+  assert(shader_svm_nodes.size() == state->shader_svm_nodes.size());
+  for (int i = 0; i < shader_svm_nodes.size(); i++) {
+    shader_svm_nodes[i] += state->shader_svm_nodes[i];
+  }
+
   assert(object_hits.size() == state->object_hits.size());
   for (int i = 0; i < object_hits.size(); i++) {
     object_hits[i] += state->object_hits[i];
@@ -155,7 +162,7 @@ uint64_t Profiler::get_event(ProfilingEvent event)
   return event_samples[event];
 }
 
-bool Profiler::get_shader(int shader, uint64_t &samples, uint64_t &hits)
+bool Profiler::get_shader(int shader, uint64_t &samples, uint64_t &hits, uint64_t &svm_nodes)
 {
   assert(worker == NULL);
   if (shader_samples[shader] == 0) {
@@ -163,6 +170,7 @@ bool Profiler::get_shader(int shader, uint64_t &samples, uint64_t &hits)
   }
   samples = shader_samples[shader];
   hits = shader_hits[shader];
+  svm_nodes = shader_svm_nodes[shader];
   return true;
 }
 
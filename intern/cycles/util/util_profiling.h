@@ -85,6 +85,7 @@ struct ProfilingState {
 
   vector<uint64_t> shader_hits;
   vector<uint64_t> object_hits;
+  vector<uint64_t> shader_svm_nodes;
 };
 
 class Profiler {
@@ -101,7 +102,7 @@ class Profiler {
   void remove_state(ProfilingState *state);
 
   uint64_t get_event(ProfilingEvent event);
-  bool get_shader(int shader, uint64_t &samples, uint64_t &hits);
+  bool get_shader(int shader, uint64_t &samples, uint64_t &hits, uint64_t &svm_nodes);
   bool get_object(int object, uint64_t &samples, uint64_t &hits);
 
  protected:
@@ -121,6 +122,11 @@ class Profiler {
   vector<uint64_t> shader_hits;
   vector<uint64_t> object_hits;
 
+  /* Tracks the total number of SVM nodes executed for every shader, written by
+   * the render thread. Together with the hits this gives the average length of
+   * the node program that runs for each shader evaluation. */
+  vector<uint64_t> shader_svm_nodes;
+
   volatile bool do_stop_worker;
   thread *worker;
 
@@ -169,6 +175,33 @@ class ProfilingHelper {
   uint32_t previous_event;
 };
 
+/* Counts the SVM nodes executed during one shader evaluation, and adds them to the
+ * currently active shader when the evaluation ends. */
+class ProfilingSVMHelper {
+ public:
+  explicit ProfilingSVMHelper(ProfilingState *state) : state(state), num_nodes(0)
+  {
+  }
+
+  inline void add_node()
+  {
+    num_nodes++;
+  }
+
+  ~ProfilingSVMHelper()
+  {
+    const int32_t shader = state->shader;
+    if (state->active && shader >= 0) {
+      assert(shader < state->shader_svm_nodes.size());
+      state->shader_svm_nodes[shader] += num_nodes;
+    }
+  }
+
+ private:
+  ProfilingState *state;
+  uint32_t num_nodes;
+};
+
 CCL_NAMESPACE_END
 
 #endif /* __UTIL_PROFILING_H__ */
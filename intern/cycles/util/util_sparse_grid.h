@@ -0,0 +1,78 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __UTIL_SPARSE_GRID_H__
+#define __UTIL_SPARSE_GRID_H__
+
+#include "util/util_types.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Sparse Grid
+ *
+ * Two level layout for 3D textures that are mostly empty, like OpenVDB grids of smoke
+ * and fire. The voxels are split into tiles of SPARSE_TILE_SIZE^3 voxels, starting at the
+ * first voxel of the texture. Only tiles that contain active voxels are stored.
+ *
+ * The texture memory starts with the tile index, one int per tile in x, y, z order,
+ * padded to a whole number of texels. Each entry is the position of the tile in the
+ * voxel data that follows the index, or SPARSE_TILE_EMPTY for tiles without active
+ * voxels, which read as zero. Loaders must only use this layout for grids whose inactive
+ * voxels are zero. Voxels within a tile are stored in x, y, z order, like dense 3D
+ * textures. */
+
+#define SPARSE_TILE_SHIFT 3
+#define SPARSE_TILE_SIZE (1 << SPARSE_TILE_SHIFT)
+#define SPARSE_TILE_MASK (SPARSE_TILE_SIZE - 1)
+#define SPARSE_TILE_VOXELS (SPARSE_TILE_SIZE * SPARSE_TILE_SIZE * SPARSE_TILE_SIZE)
+#define SPARSE_TILE_EMPTY (-1)
+
+ccl_device_inline int sparse_grid_num_tiles(int size)
+{
+  return (size + SPARSE_TILE_MASK) >> SPARSE_TILE_SHIFT;
+}
+
+ccl_device_inline size_t sparse_grid_num_tiles(int width, int height, int depth)
+{
+  return ((size_t)sparse_grid_num_tiles(width)) * sparse_grid_num_tiles(height) *
+         sparse_grid_num_tiles(depth);
+}
+
+/* Number of texels taken by the tile index, for texels of the given size in bytes. */
+ccl_device_inline size_t sparse_grid_index_texels(size_t num_tiles, size_t texel_size)
+{
+  return (num_tiles * sizeof(int) + texel_size - 1) / texel_size;
+}
+
+/* Index of the tile containing the voxel. */
+ccl_device_inline size_t sparse_grid_tile(int x, int y, int z, int width, int height)
+{
+  const size_t tiles_x = sparse_grid_num_tiles(width);
+  const size_t tiles_y = sparse_grid_num_tiles(height);
+  return (x >> SPARSE_TILE_SHIFT) + tiles_x * ((y >> SPARSE_TILE_SHIFT) +
+                                               tiles_y * (z >> SPARSE_TILE_SHIFT));
+}
+
+/* Offset of the voxel within its tile. */
+ccl_device_inline int sparse_grid_tile_voxel(int x, int y, int z)
+{
+  return (x & SPARSE_TILE_MASK) +
+         SPARSE_TILE_SIZE * ((y & SPARSE_TILE_MASK) + SPARSE_TILE_SIZE * (z & SPARSE_TILE_MASK));
+}
+
+CCL_NAMESPACE_END
+
+#endif /* __UTIL_SPARSE_GRID_H__ */
@@ -103,6 +103,10 @@ typedef struct TextureInfo {
   uint width, height, depth;
   /* Transform for 3D textures. */
   uint use_transform_3d;
+  /* CPU only: data points to a TextureCacheTexture instead of pixels. */
+  uint use_texture_cache;
+  /* CPU only: data is a sparse grid, see util_sparse_grid.h. */
+  uint use_sparse_grid;
   Transform transform_3d;
 } TextureInfo;
 
@@ -0,0 +1,186 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "util/util_texture_cache.h"
+#include "util/util_algorithm.h"
+#include "util/util_foreach.h"
+#include "util/util_logging.h"
+
+#include <OpenImageIO/texture.h>
+
+OIIO_NAMESPACE_USING
+
+CCL_NAMESPACE_BEGIN
+
+struct TextureCacheTexture {
+  TextureSystem *texture_system;
+  TextureSystem::TextureHandle *handle;
+  ustring filepath;
+  int channels;
+  TextureOpt::InterpMode interpolation;
+  TextureOpt::Wrap wrap;
+};
+
+static TextureOpt::InterpMode texture_cache_interpolation(InterpolationType interpolation)
+{
+  switch (interpolation) {
+    case INTERPOLATION_CLOSEST:
+      return TextureOpt::InterpClosest;
+    case INTERPOLATION_CUBIC:
+      return TextureOpt::InterpBicubic;
+    case INTERPOLATION_SMART:
+      return TextureOpt::InterpSmartBicubic;
+    case INTERPOLATION_LINEAR:
+    default:
+      return TextureOpt::InterpBilinear;
+  }
+}
+
+static TextureOpt::Wrap texture_cache_wrap(ExtensionType extension)
+{
+  switch (extension) {
+    case EXTENSION_EXTEND:
+      return TextureOpt::WrapClamp;
+    case EXTENSION_CLIP:
+      return TextureOpt::WrapBlack;
+    case EXTENSION_REPEAT:
+    default:
+      return TextureOpt::WrapPeriodic;
+  }
+}
+
+/* Texture Cache */
+
+TextureCache::TextureCache(int max_memory_MB)
+{
+  /* Not shared with OSL, so that the memory budget applies to this render only. */
+  TextureSystem *ts = TextureSystem::create(false);
+  ts->attribute("automip", 1);
+  ts->attribute("autotile", 64);
+  ts->attribute("max_memory_MB", (float)max(max_memory_MB, 1));
+  texture_system = ts;
+
+  VLOG(1) << "Texture cache created with a budget of " << max_memory_MB << " MB.";
+}
+
+TextureCache::~TextureCache()
+{
+  foreach (TextureCacheTexture *texture, textures) {
+    delete texture;
+  }
+
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  VLOG(1) << "Texture cache statistics:\n" << ts->getstats(1);
+  ts->invalidate_all(true);
+  TextureSystem::destroy(ts);
+}
+
+TextureCacheTexture *TextureCache::add_texture(const string &filepath,
+                                               int channels,
+                                               InterpolationType interpolation,
+                                               ExtensionType extension)
+{
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  const ustring ufilepath(filepath);
+
+  TextureSystem::TextureHandle *handle = ts->get_texture_handle(ufilepath);
+  if (handle == NULL || !ts->good(handle)) {
+    /* Clear error so it does not leak into later lookups. */
+    ts->geterror();
+    return NULL;
+  }
+
+  TextureCacheTexture *texture = new TextureCacheTexture();
+  texture->texture_system = ts;
+  texture->handle = handle;
+  texture->filepath = ufilepath;
+  texture->channels = channels;
+  texture->interpolation = texture_cache_interpolation(interpolation);
+  texture->wrap = texture_cache_wrap(extension);
+
+  thread_scoped_lock lock(textures_mutex);
+  textures.push_back(texture);
+  return texture;
+}
+
+void TextureCache::remove_texture(TextureCacheTexture *texture)
+{
+  thread_scoped_lock lock(textures_mutex);
+
+  vector<TextureCacheTexture *>::iterator it = std::find(
+      textures.begin(), textures.end(), texture);
+  if (it == textures.end()) {
+    return;
+  }
+  textures.erase(it);
+
+  /* Free the tiles, the file may have changed by the time it is added again. */
+  ((TextureSystem *)texture_system)->invalidate(texture->filepath);
+  delete texture;
+}
+
+string TextureCache::stats() const
+{
+  return ((TextureSystem *)texture_system)->getstats(1);
+}
+
+/* Lookup */
+
+float4 texture_cache_lookup(const TextureCacheTexture *texture,
+                            float x,
+                            float y,
+                            float dxdx,
+                            float dydx,
+                            float dxdy,
+                            float dydy)
+{
+  TextureOpt options;
+  options.swrap = texture->wrap;
+  options.twrap = texture->wrap;
+  options.interpmode = texture->interpolation;
+
+  /* OpenImageIO has t pointing down. */
+  const int nchannels = min(texture->channels, 4);
+  float result[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+  if (!texture->texture_system->texture(texture->handle,
+                                        NULL,
+                                        options,
+                                        x,
+                                        1.0f - y,
+                                        dxdx,
+                                        -dydx,
+                                        dxdy,
+                                        -dydy,
+                                        nchannels,
+                                        result)) {
+    texture->texture_system->geterror();
+    return make_float4(
+        TEX_IMAGE_MISSING_R, TEX_IMAGE_MISSING_G, TEX_IMAGE_MISSING_B, TEX_IMAGE_MISSING_A);
+  }
+
+  switch (nchannels) {
+    case 1:
+      return make_float4(result[0], result[0], result[0], 1.0f);
+    case 2:
+      return make_float4(result[0], result[0], result[0], result[1]);
+    case 3:
+      return make_float4(result[0], result[1], result[2], 1.0f);
+    default:
+      return make_float4(result[0], result[1], result[2], result[3]);
+  }
+}
+
+CCL_NAMESPACE_END
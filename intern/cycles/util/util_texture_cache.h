@@ -0,0 +1,61 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __UTIL_TEXTURE_CACHE_H__
+#define __UTIL_TEXTURE_CACHE_H__
+
+#include "util/util_string.h"
+#include "util/util_texture.h"
+#include "util/util_texture_cache_lookup.h"
+#include "util/util_thread.h"
+#include "util/util_types.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Tiled, mip-mapped texture cache for CPU rendering.
+ *
+ * Rather than loading full resolution images into memory, tiles are read on demand
+ * from the file by OpenImageIO's texture system. Files that are not tiled or have no
+ * mip-maps are tiled and mip-mapped in memory on first access. Tiles are evicted in
+ * least recently used order once the memory budget is exceeded.
+ *
+ * Kernels only use texture_cache_lookup(), declared in util_texture_cache_lookup.h. */
+class TextureCache {
+ public:
+  explicit TextureCache(int max_memory_MB);
+  ~TextureCache();
+
+  /* Returns NULL if the file could not be opened. The texture remains valid until it
+   * is removed or the cache is destroyed. */
+  TextureCacheTexture *add_texture(const string &filepath,
+                                   int channels,
+                                   InterpolationType interpolation,
+                                   ExtensionType extension);
+  void remove_texture(TextureCacheTexture *texture);
+
+  string stats() const;
+
+ protected:
+  void *texture_system;
+
+  thread_mutex textures_mutex;
+  vector<TextureCacheTexture *> textures;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __UTIL_TEXTURE_CACHE_H__ */
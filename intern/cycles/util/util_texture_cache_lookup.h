@@ -0,0 +1,43 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __UTIL_TEXTURE_CACHE_LOOKUP_H__
+#define __UTIL_TEXTURE_CACHE_LOOKUP_H__
+
+#include "util/util_types.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Kernel side of the texture cache, see util_texture_cache.h for the host side. */
+
+/* Texture in the cache, as referenced from the kernel through TextureInfo.data. */
+struct TextureCacheTexture;
+
+/* Filtered lookup at texture coordinate (x, y), with y pointing up as for other image
+ * textures. Derivatives of the texture coordinate select the mip level, zero derivatives
+ * give the full resolution level. Result is RGBA, single channel and grayscale images are
+ * expanded the same way as fully loaded images. */
+float4 texture_cache_lookup(const TextureCacheTexture *texture,
+                            float x,
+                            float y,
+                            float dxdx,
+                            float dydx,
+                            float dxdy,
+                            float dydy);
+
+CCL_NAMESPACE_END
+
+#endif /* __UTIL_TEXTURE_CACHE_LOOKUP_H__ */
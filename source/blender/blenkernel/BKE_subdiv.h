@@ -97,6 +97,7 @@ typedef enum eSubdivStatsValue {
   SUBDIV_STATS_EVALUATOR_REFINE,
   SUBDIV_STATS_SUBDIV_TO_CCG,
   SUBDIV_STATS_SUBDIV_TO_CCG_ELEMENTS,
+  SUBDIV_STATS_SUBDIV_TO_CCG_NORMALS,
   SUBDIV_STATS_TOPOLOGY_COMPARE,
 
   NUM_SUBDIV_STATS_VALUES,
@@ -121,6 +122,8 @@ typedef struct SubdivStats {
       double subdiv_to_ccg_time;
       /* Time spent on CCG elements evaluation/initialization. */
       double subdiv_to_ccg_elements_time;
+      /* Time spent on CCG normals calculation and grid boundaries averaging. */
+      double subdiv_to_ccg_normals_time;
       /* Time spent on CCG elements evaluation/initialization. */
       double topology_compare_time;
     };
@@ -94,6 +94,8 @@ typedef struct SubdivToCCGSettings {
   /* Denotes which extra layers to be added to CCG elements. */
   bool need_normal;
   bool need_mask;
+  /* Store grids in a memory mapped scratch file, see BKE_subdiv_ccg_grids_page_out(). */
+  bool use_scratch_storage;
 } SubdivToCCGSettings;
 
 typedef struct SubdivCCGCoord {
@@ -155,7 +157,15 @@ typedef struct SubdivCCG {
   struct CCGElem **grids;
   /* Flat array of all grids' data. */
   unsigned char *grids_storage;
+  size_t grids_storage_size;
   int num_grids;
+  /* Out-of-core grids: grids_storage is a shared mapping of an unlinked scratch file, so its
+   * pages can be written out and dropped from memory. They are read back on access.
+   * scratch_fd is -1 when grids are stored on the heap. */
+  int scratch_fd;
+  /* Per-grid stamp of the last use, for least recently used eviction. */
+  int *grid_use_stamps;
+  int grid_use_stamp;
   /* Loose edges, each array element contains grid_size elements
    * corresponding to vertices created by subdividing coarse edges. */
   struct CCGElem **edges;
@@ -277,6 +287,25 @@ typedef struct SubdivCCGNeighbors {
   SubdivCCGCoord coords_fixed[256];
 } SubdivCCGNeighbors;
 
+/* Out-of-core grids.
+ *
+ * Grids used by an operation (like a sculpt stroke) are marked as used. Released grids are read
+ * back by the system when they are accessed again. */
+
+/* Whether grids are stored in the scratch file rather than on the heap. */
+bool BKE_subdiv_ccg_use_scratch_storage(const SubdivCCG *subdiv_ccg);
+
+/* Mark grids as used by the current operation, keeping them resident on the next page out. */
+void BKE_subdiv_ccg_grids_mark_used(SubdivCCG *subdiv_ccg,
+                                    const int *grid_indices,
+                                    const int num_grid_indices);
+
+/* Write the least recently used grids to the scratch file and release their memory until the
+ * resident size of the grids is within the given limit. Grids marked since the previous page
+ * out are kept.
+ * Returns the number of bytes which were released. */
+size_t BKE_subdiv_ccg_grids_page_out(SubdivCCG *subdiv_ccg, const size_t memory_limit);
+
 void BKE_subdiv_ccg_print_coord(const char *message, const SubdivCCGCoord *coord);
 bool BKE_subdiv_ccg_check_coord_valid(const SubdivCCG *subdiv_ccg, const SubdivCCGCoord *coord);
 
@@ -25,6 +25,7 @@
 #include "BLI_heap_simple.h"
 #include "BLI_math.h"
 #include "BLI_memarena.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_DerivedMesh.h"
@@ -748,6 +749,11 @@ typedef struct EdgeQueue {
 #endif
 } EdgeQueue;
 
+typedef struct {
+  BMEdge *e;
+  float priority;
+} EdgeQueueCandidate;
+
 typedef struct {
   EdgeQueue *q;
   BLI_mempool *pool;
@@ -755,6 +761,9 @@ typedef struct {
   int cd_vert_mask_offset;
   int cd_vert_node_offset;
   int cd_face_node_offset;
+  /* When set, edges are collected here instead of being inserted in the queue,
+   * see #edge_queue_create_from_nodes. */
+  BLI_Buffer *candidates;
 } EdgeQueueContext;
 
 /* only tag'd edges are in the queue */
@@ -835,6 +844,18 @@ static bool check_mask(EdgeQueueContext *eq_ctx, BMVert *v)
   return BM_ELEM_CD_GET_FLOAT(v, eq_ctx->cd_vert_mask_offset) < 1.0f;
 }
 
+static void edge_queue_heap_insert(EdgeQueueContext *eq_ctx, BMEdge *e, float priority)
+{
+  BMVert **pair = BLI_mempool_alloc(eq_ctx->pool);
+  pair[0] = e->v1;
+  pair[1] = e->v2;
+  BLI_heapsimple_insert(eq_ctx->q->heap, priority, pair);
+#ifdef USE_EDGEQUEUE_TAG
+  BLI_assert(EDGE_QUEUE_TEST(e) == false);
+  EDGE_QUEUE_ENABLE(e);
+#endif
+}
+
 static void edge_queue_insert(EdgeQueueContext *eq_ctx, BMEdge *e, float priority)
 {
   /* Don't let topology update affect fully masked vertices. This used to
@@ -847,14 +868,13 @@ static void edge_queue_insert(EdgeQueueContext *eq_ctx, BMEdge *e, float priorit
        (check_mask(eq_ctx, e->v1) || check_mask(eq_ctx, e->v2))) &&
       !(BM_elem_flag_test_bool(e->v1, BM_ELEM_HIDDEN) ||
         BM_elem_flag_test_bool(e->v2, BM_ELEM_HIDDEN))) {
-    BMVert **pair = BLI_mempool_alloc(eq_ctx->pool);
-    pair[0] = e->v1;
-    pair[1] = e->v2;
-    BLI_heapsimple_insert(eq_ctx->q->heap, priority, pair);
-#ifdef USE_EDGEQUEUE_TAG
-    BLI_assert(EDGE_QUEUE_TEST(e) == false);
-    EDGE_QUEUE_ENABLE(e);
-#endif
+    if (eq_ctx->candidates) {
+      EdgeQueueCandidate candidate = {e, priority};
+      BLI_buffer_append(eq_ctx->candidates, EdgeQueueCandidate, candidate);
+    }
+    else {
+      edge_queue_heap_insert(eq_ctx, e, priority);
+    }
   }
 }
 
@@ -992,6 +1012,86 @@ static void short_edge_queue_face_add(EdgeQueueContext *eq_ctx, BMFace *f)
   }
 }
 
+typedef struct EdgeQueueGatherData {
+  EdgeQueueContext *eq_ctx;
+  PBVHNode **nodes;
+  BLI_Buffer *node_candidates;
+  void (*face_add)(EdgeQueueContext *eq_ctx, BMFace *f);
+} EdgeQueueGatherData;
+
+static void edge_queue_gather_task_cb(void *__restrict userdata,
+                                      const int n,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  EdgeQueueGatherData *data = userdata;
+
+  /* Node local copy of the context, edges are only read here so nodes can be handled
+   * concurrently. Edge tags stay untouched until the candidates are merged. */
+  EdgeQueueContext eq_ctx = *data->eq_ctx;
+  eq_ctx.candidates = &data->node_candidates[n];
+
+  GSetIterator gs_iter;
+  GSET_ITER (gs_iter, data->nodes[n]->bm_faces) {
+    BMFace *f = BLI_gsetIterator_getKey(&gs_iter);
+    data->face_add(&eq_ctx, f);
+  }
+}
+
+/* Fill the queue from all leaf nodes marked for topology update.
+ *
+ * Each node gathers the edges of its own faces in parallel, the per-node candidates are then
+ * merged into the queue in node order, skipping edges shared with nodes merged before. */
+static void edge_queue_create_from_nodes(EdgeQueueContext *eq_ctx,
+                                         PBVH *pbvh,
+                                         void (*face_add)(EdgeQueueContext *eq_ctx, BMFace *f))
+{
+  PBVHNode **nodes = MEM_malloc_arrayN(pbvh->totnode, sizeof(*nodes), __func__);
+  int totnode = 0;
+
+  for (int n = 0; n < pbvh->totnode; n++) {
+    PBVHNode *node = &pbvh->nodes[n];
+
+    /* Check leaf nodes marked for topology update */
+    if ((node->flag & PBVH_Leaf) && (node->flag & PBVH_UpdateTopology) &&
+        !(node->flag & PBVH_FullyHidden)) {
+      nodes[totnode++] = node;
+    }
+  }
+
+  BLI_Buffer *node_candidates = MEM_malloc_arrayN(totnode, sizeof(BLI_Buffer), __func__);
+  for (int n = 0; n < totnode; n++) {
+    BLI_buffer_field_init(&node_candidates[n], EdgeQueueCandidate);
+  }
+
+  EdgeQueueGatherData data = {
+      .eq_ctx = eq_ctx,
+      .nodes = nodes,
+      .node_candidates = node_candidates,
+      .face_add = face_add,
+  };
+
+  TaskParallelSettings settings;
+  BKE_pbvh_parallel_range_settings(&settings, true, totnode);
+  BLI_task_parallel_range(0, totnode, &data, edge_queue_gather_task_cb, &settings);
+
+  for (int n = 0; n < totnode; n++) {
+    BLI_Buffer *candidates = &node_candidates[n];
+    for (int i = 0; i < candidates->count; i++) {
+      const EdgeQueueCandidate *candidate = &BLI_buffer_at(candidates, EdgeQueueCandidate, i);
+#ifdef USE_EDGEQUEUE_TAG
+      if (EDGE_QUEUE_TEST(candidate->e)) {
+        continue;
+      }
+#endif
+      edge_queue_heap_insert(eq_ctx, candidate->e, candidate->priority);
+    }
+    BLI_buffer_field_free(candidates);
+  }
+
+  MEM_freeN(node_candidates);
+  MEM_freeN(nodes);
+}
+
 /* Create a priority queue containing vertex pairs connected by a long
  * edge as defined by PBVH.bm_max_edge_len.
  *
@@ -1037,22 +1137,7 @@ static void long_edge_queue_create(EdgeQueueContext *eq_ctx,
   pbvh_bmesh_edge_tag_verify(pbvh);
 #endif
 
-  for (int n = 0; n < pbvh->totnode; n++) {
-    PBVHNode *node = &pbvh->nodes[n];
-
-    /* Check leaf nodes marked for topology update */
-    if ((node->flag & PBVH_Leaf) && (node->flag & PBVH_UpdateTopology) &&
-        !(node->flag & PBVH_FullyHidden)) {
-      GSetIterator gs_iter;
-
-      /* Check each face */
-      GSET_ITER (gs_iter, node->bm_faces) {
-        BMFace *f = BLI_gsetIterator_getKey(&gs_iter);
-
-        long_edge_queue_face_add(eq_ctx, f);
-      }
-    }
-  }
+  edge_queue_create_from_nodes(eq_ctx, pbvh, long_edge_queue_face_add);
 }
 
 /* Create a priority queue containing vertex pairs connected by a
@@ -1096,22 +1181,7 @@ static void short_edge_queue_create(EdgeQueueContext *eq_ctx,
     eq_ctx->q->edge_queue_tri_in_range = edge_queue_tri_in_sphere;
   }
 
-  for (int n = 0; n < pbvh->totnode; n++) {
-    PBVHNode *node = &pbvh->nodes[n];
-
-    /* Check leaf nodes marked for topology update */
-    if ((node->flag & PBVH_Leaf) && (node->flag & PBVH_UpdateTopology) &&
-        !(node->flag & PBVH_FullyHidden)) {
-      GSetIterator gs_iter;
-
-      /* Check each face */
-      GSET_ITER (gs_iter, node->bm_faces) {
-        BMFace *f = BLI_gsetIterator_getKey(&gs_iter);
-
-        short_edge_queue_face_add(eq_ctx, f);
-      }
-    }
-  }
+  edge_queue_create_from_nodes(eq_ctx, pbvh, short_edge_queue_face_add);
 }
 
 /*************************** Topology update **************************/
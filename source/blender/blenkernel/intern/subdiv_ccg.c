@@ -30,16 +30,27 @@
 
 #include "BLI_math_bits.h"
 #include "BLI_math_vector.h"
+#include "BLI_path_util.h"
 #include "BLI_task.h"
 
 #include "BKE_DerivedMesh.h"
+#include "BKE_appdir.h"
 #include "BKE_ccg.h"
 #include "BKE_mesh.h"
 #include "BKE_subdiv.h"
 #include "BKE_subdiv_eval.h"
 
+#include "opensubdiv_capi_type.h"
 #include "opensubdiv_topology_refiner_capi.h"
 
+#ifndef WIN32
+#  include <fcntl.h>
+#  include <stdio.h>
+#  include <stdlib.h>
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif
+
 /* -------------------------------------------------------------------- */
 /** \name Various forward declarations
  * \{ */
@@ -122,9 +133,56 @@ static int topology_refiner_count_face_corners(OpenSubdiv_TopologyRefiner *topol
   return num_corners;
 }
 
+/* Allocate grids storage as a shared mapping of an unlinked file in the session temporary
+ * directory. Returns false when this is not possible, the caller falls back to the heap. */
+static bool subdiv_ccg_scratch_storage_alloc(SubdivCCG *subdiv_ccg, const size_t size)
+{
+#ifndef WIN32
+  char filepath[FILE_MAX];
+  BLI_join_dirfile(filepath, sizeof(filepath), BKE_tempdir_session(), "subdiv_ccg_XXXXXX");
+  const int fd = mkstemp(filepath);
+  if (fd == -1) {
+    return false;
+  }
+  /* Nothing else is to access the file, it is removed once the descriptor is closed. */
+  unlink(filepath);
+  if (ftruncate(fd, (off_t)size) != 0) {
+    close(fd);
+    return false;
+  }
+  void *storage = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (storage == MAP_FAILED) {
+    close(fd);
+    return false;
+  }
+  subdiv_ccg->grids_storage = storage;
+  subdiv_ccg->scratch_fd = fd;
+  return true;
+#else
+  UNUSED_VARS(subdiv_ccg, size);
+  return false;
+#endif
+}
+
+static void subdiv_ccg_grids_storage_free(SubdivCCG *subdiv_ccg)
+{
+#ifndef WIN32
+  if (subdiv_ccg->scratch_fd != -1) {
+    munmap(subdiv_ccg->grids_storage, subdiv_ccg->grids_storage_size);
+    close(subdiv_ccg->scratch_fd);
+    subdiv_ccg->grids_storage = NULL;
+    subdiv_ccg->scratch_fd = -1;
+    return;
+  }
+#endif
+  MEM_SAFE_FREE(subdiv_ccg->grids_storage);
+}
+
 /* NOTE: Grid size and layer flags are to be filled in before calling this
  * function. */
-static void subdiv_ccg_alloc_elements(SubdivCCG *subdiv_ccg, Subdiv *subdiv)
+static void subdiv_ccg_alloc_elements(SubdivCCG *subdiv_ccg,
+                                      Subdiv *subdiv,
+                                      const SubdivToCCGSettings *settings)
 {
   OpenSubdiv_TopologyRefiner *topology_refiner = subdiv->topology_refiner;
   const int element_size = element_size_bytes_get(subdiv_ccg);
@@ -136,9 +194,16 @@ static void subdiv_ccg_alloc_elements(SubdivCCG *subdiv_ccg, Subdiv *subdiv)
   subdiv_ccg->grid_element_size = element_size;
   subdiv_ccg->num_grids = num_grids;
   subdiv_ccg->grids = MEM_calloc_arrayN(num_grids, sizeof(CCGElem *), "subdiv ccg grids");
-  subdiv_ccg->grids_storage = MEM_calloc_arrayN(
-      num_grids, ((size_t)grid_area) * element_size, "subdiv ccg grids storage");
   const size_t grid_size_in_bytes = (size_t)grid_area * element_size;
+  subdiv_ccg->grids_storage_size = grid_size_in_bytes * num_grids;
+  subdiv_ccg->scratch_fd = -1;
+  if (!(settings->use_scratch_storage && subdiv_ccg->grids_storage_size != 0 &&
+        subdiv_ccg_scratch_storage_alloc(subdiv_ccg, subdiv_ccg->grids_storage_size))) {
+    subdiv_ccg->grids_storage = MEM_calloc_arrayN(
+        num_grids, grid_size_in_bytes, "subdiv ccg grids storage");
+  }
+  subdiv_ccg->grid_use_stamps = MEM_calloc_arrayN(num_grids, sizeof(int), "ccg grid use stamps");
+  subdiv_ccg->grid_use_stamp = 1;
   for (int grid_index = 0; grid_index < num_grids; grid_index++) {
     const size_t grid_offset = grid_size_in_bytes * grid_index;
     subdiv_ccg->grids[grid_index] = (CCGElem *)&subdiv_ccg->grids_storage[grid_offset];
@@ -176,83 +241,107 @@ typedef struct CCGEvalGridsData {
   SubdivCCGMaterialFlagsEvaluator *material_flags_evaluator;
 } CCGEvalGridsData;
 
-static void subdiv_ccg_eval_grid_element_limit(CCGEvalGridsData *data,
-                                               const int ptex_face_index,
-                                               const float u,
-                                               const float v,
-                                               unsigned char *element)
-{
-  Subdiv *subdiv = data->subdiv;
-  SubdivCCG *subdiv_ccg = data->subdiv_ccg;
-  if (subdiv->displacement_evaluator != NULL) {
-    BKE_subdiv_eval_final_point(subdiv, ptex_face_index, u, v, (float *)element);
-  }
-  else if (subdiv_ccg->has_normal) {
-    BKE_subdiv_eval_limit_point_and_normal(subdiv,
-                                           ptex_face_index,
-                                           u,
-                                           v,
-                                           (float *)element,
-                                           (float *)(element + subdiv_ccg->normal_offset));
-  }
-  else {
-    BKE_subdiv_eval_limit_point(subdiv, ptex_face_index, u, v, (float *)element);
-  }
-}
+/* Per-thread buffers used to evaluate all elements of a grid in a single evaluator call.
+ * All grids are of the same size, so buffers are allocated once per thread and re-used. */
+typedef struct CCGEvalGridsTLSData {
+  OpenSubdiv_PatchCoord *patch_coords;
+  float (*P)[3];
+  float (*dPdu)[3];
+  float (*dPdv)[3];
+} CCGEvalGridsTLSData;
 
-static void subdiv_ccg_eval_grid_element_mask(CCGEvalGridsData *data,
-                                              const int ptex_face_index,
-                                              const float u,
-                                              const float v,
-                                              unsigned char *element)
+static void subdiv_ccg_eval_grids_tls_ensure(CCGEvalGridsData *data, CCGEvalGridsTLSData *tls)
 {
-  SubdivCCG *subdiv_ccg = data->subdiv_ccg;
-  if (!subdiv_ccg->has_mask) {
+  if (tls->patch_coords != NULL) {
     return;
   }
-  float *mask_value_ptr = (float *)(element + subdiv_ccg->mask_offset);
-  if (data->mask_evaluator != NULL) {
-    *mask_value_ptr = data->mask_evaluator->eval_mask(data->mask_evaluator, ptex_face_index, u, v);
-  }
-  else {
-    *mask_value_ptr = 0.0f;
-  }
+  const int grid_size = data->subdiv_ccg->grid_size;
+  const int grid_area = grid_size * grid_size;
+  tls->patch_coords = MEM_malloc_arrayN(
+      grid_area, sizeof(OpenSubdiv_PatchCoord), "CCG eval patch coords");
+  tls->P = MEM_malloc_arrayN(grid_area, sizeof(float[3]), "CCG eval P");
+  tls->dPdu = MEM_malloc_arrayN(grid_area, sizeof(float[3]), "CCG eval dPdu");
+  tls->dPdv = MEM_malloc_arrayN(grid_area, sizeof(float[3]), "CCG eval dPdv");
 }
 
-static void subdiv_ccg_eval_grid_element(CCGEvalGridsData *data,
-                                         const int ptex_face_index,
-                                         const float u,
-                                         const float v,
-                                         unsigned char *element)
+/* Evaluate all elements of the grid, assuming patch coordinates of all grid elements are stored
+ * in the thread local storage. */
+static void subdiv_ccg_eval_grid_elements(CCGEvalGridsData *data,
+                                          CCGEvalGridsTLSData *tls,
+                                          const int grid_index)
 {
-  subdiv_ccg_eval_grid_element_limit(data, ptex_face_index, u, v, element);
-  subdiv_ccg_eval_grid_element_mask(data, ptex_face_index, u, v, element);
+  Subdiv *subdiv = data->subdiv;
+  SubdivCCG *subdiv_ccg = data->subdiv_ccg;
+  const int grid_area = subdiv_ccg->grid_size * subdiv_ccg->grid_size;
+  const int element_size = element_size_bytes_get(subdiv_ccg);
+  const bool has_displacement = (subdiv->displacement_evaluator != NULL);
+  const bool need_derivatives = (has_displacement || subdiv_ccg->has_normal);
+  unsigned char *grid = (unsigned char *)subdiv_ccg->grids[grid_index];
+  BKE_subdiv_eval_limit_points_and_derivatives(subdiv,
+                                               tls->patch_coords,
+                                               grid_area,
+                                               tls->P,
+                                               need_derivatives ? tls->dPdu : NULL,
+                                               need_derivatives ? tls->dPdv : NULL);
+  for (int i = 0; i < grid_area; i++) {
+    const OpenSubdiv_PatchCoord *patch_coord = &tls->patch_coords[i];
+    unsigned char *element = &grid[(size_t)i * element_size];
+    float *co = (float *)element;
+    copy_v3_v3(co, tls->P[i]);
+    if (has_displacement) {
+      /* Normals are calculated after all final coordinates are known. */
+      float D[3];
+      BKE_subdiv_eval_displacement(subdiv,
+                                   patch_coord->ptex_face,
+                                   patch_coord->u,
+                                   patch_coord->v,
+                                   tls->dPdu[i],
+                                   tls->dPdv[i],
+                                   D);
+      add_v3_v3(co, D);
+    }
+    else if (subdiv_ccg->has_normal) {
+      float *no = (float *)(element + subdiv_ccg->normal_offset);
+      cross_v3_v3v3(no, tls->dPdu[i], tls->dPdv[i]);
+      normalize_v3(no);
+    }
+    if (subdiv_ccg->has_mask) {
+      float *mask_value_ptr = (float *)(element + subdiv_ccg->mask_offset);
+      if (data->mask_evaluator != NULL) {
+        *mask_value_ptr = data->mask_evaluator->eval_mask(
+            data->mask_evaluator, patch_coord->ptex_face, patch_coord->u, patch_coord->v);
+      }
+      else {
+        *mask_value_ptr = 0.0f;
+      }
+    }
+  }
 }
 
-static void subdiv_ccg_eval_regular_grid(CCGEvalGridsData *data, const int face_index)
+static void subdiv_ccg_eval_regular_grid(CCGEvalGridsData *data,
+                                         CCGEvalGridsTLSData *tls,
+                                         const int face_index)
 {
   SubdivCCG *subdiv_ccg = data->subdiv_ccg;
   const int ptex_face_index = data->face_ptex_offset[face_index];
   const int grid_size = subdiv_ccg->grid_size;
   const float grid_size_1_inv = 1.0f / (float)(grid_size - 1);
-  const int element_size = element_size_bytes_get(subdiv_ccg);
   SubdivCCGFace *faces = subdiv_ccg->faces;
   SubdivCCGFace **grid_faces = subdiv_ccg->grid_faces;
   const SubdivCCGFace *face = &faces[face_index];
   for (int corner = 0; corner < face->num_grids; corner++) {
     const int grid_index = face->start_grid_index + corner;
-    unsigned char *grid = (unsigned char *)subdiv_ccg->grids[grid_index];
     for (int y = 0; y < grid_size; y++) {
       const float grid_v = (float)y * grid_size_1_inv;
       for (int x = 0; x < grid_size; x++) {
         const float grid_u = (float)x * grid_size_1_inv;
-        float u, v;
-        BKE_subdiv_rotate_grid_to_quad(corner, grid_u, grid_v, &u, &v);
-        const size_t grid_element_index = (size_t)y * grid_size + x;
-        const size_t grid_element_offset = grid_element_index * element_size;
-        subdiv_ccg_eval_grid_element(data, ptex_face_index, u, v, &grid[grid_element_offset]);
+        OpenSubdiv_PatchCoord *patch_coord = &tls->patch_coords[y * grid_size + x];
+        patch_coord->ptex_face = ptex_face_index;
+        BKE_subdiv_rotate_grid_to_quad(
+            corner, grid_u, grid_v, &patch_coord->u, &patch_coord->v);
       }
     }
+    subdiv_ccg_eval_grid_elements(data, tls, grid_index);
     /* Assign grid's face. */
     grid_faces[grid_index] = &faces[face_index];
     /* Assign material flags. */
@@ -261,28 +350,30 @@ static void subdiv_ccg_eval_regular_grid(CCGEvalGridsData *data, const int face_
   }
 }
 
-static void subdiv_ccg_eval_special_grid(CCGEvalGridsData *data, const int face_index)
+static void subdiv_ccg_eval_special_grid(CCGEvalGridsData *data,
+                                         CCGEvalGridsTLSData *tls,
+                                         const int face_index)
 {
   SubdivCCG *subdiv_ccg = data->subdiv_ccg;
   const int grid_size = subdiv_ccg->grid_size;
   const float grid_size_1_inv = 1.0f / (float)(grid_size - 1);
-  const int element_size = element_size_bytes_get(subdiv_ccg);
   SubdivCCGFace *faces = subdiv_ccg->faces;
   SubdivCCGFace **grid_faces = subdiv_ccg->grid_faces;
   const SubdivCCGFace *face = &faces[face_index];
   for (int corner = 0; corner < face->num_grids; corner++) {
     const int grid_index = face->start_grid_index + corner;
     const int ptex_face_index = data->face_ptex_offset[face_index] + corner;
-    unsigned char *grid = (unsigned char *)subdiv_ccg->grids[grid_index];
     for (int y = 0; y < grid_size; y++) {
       const float u = 1.0f - ((float)y * grid_size_1_inv);
       for (int x = 0; x < grid_size; x++) {
         const float v = 1.0f - ((float)x * grid_size_1_inv);
-        const size_t grid_element_index = (size_t)y * grid_size + x;
-        const size_t grid_element_offset = grid_element_index * element_size;
-        subdiv_ccg_eval_grid_element(data, ptex_face_index, u, v, &grid[grid_element_offset]);
+        OpenSubdiv_PatchCoord *patch_coord = &tls->patch_coords[y * grid_size + x];
+        patch_coord->ptex_face = ptex_face_index;
+        patch_coord->u = u;
+        patch_coord->v = v;
       }
     }
+    subdiv_ccg_eval_grid_elements(data, tls, grid_index);
     /* Assign grid's face. */
     grid_faces[grid_index] = &faces[face_index];
     /* Assign material flags. */
@@ -293,19 +384,31 @@ static void subdiv_ccg_eval_special_grid(CCGEvalGridsData *data, const int face_
 
 static void subdiv_ccg_eval_grids_task(void *__restrict userdata_v,
                                        const int face_index,
-                                       const TaskParallelTLS *__restrict UNUSED(tls))
+                                       const TaskParallelTLS *__restrict tls_v)
 {
   CCGEvalGridsData *data = userdata_v;
+  CCGEvalGridsTLSData *tls = tls_v->userdata_chunk;
   SubdivCCG *subdiv_ccg = data->subdiv_ccg;
   SubdivCCGFace *face = &subdiv_ccg->faces[face_index];
+  subdiv_ccg_eval_grids_tls_ensure(data, tls);
   if (face->num_grids == 4) {
-    subdiv_ccg_eval_regular_grid(data, face_index);
+    subdiv_ccg_eval_regular_grid(data, tls, face_index);
   }
   else {
-    subdiv_ccg_eval_special_grid(data, face_index);
+    subdiv_ccg_eval_special_grid(data, tls, face_index);
   }
 }
 
+static void subdiv_ccg_eval_grids_free(const void *__restrict UNUSED(userdata),
+                                       void *__restrict tls_v)
+{
+  CCGEvalGridsTLSData *tls = tls_v;
+  MEM_SAFE_FREE(tls->patch_coords);
+  MEM_SAFE_FREE(tls->P);
+  MEM_SAFE_FREE(tls->dPdu);
+  MEM_SAFE_FREE(tls->dPdv);
+}
+
 static bool subdiv_ccg_evaluate_grids(SubdivCCG *subdiv_ccg,
                                       Subdiv *subdiv,
                                       SubdivCCGMaskEvaluator *mask_evaluator,
@@ -320,15 +423,23 @@ static bool subdiv_ccg_evaluate_grids(SubdivCCG *subdiv_ccg,
   data.face_ptex_offset = BKE_subdiv_face_ptex_offset_get(subdiv);
   data.mask_evaluator = mask_evaluator;
   data.material_flags_evaluator = material_flags_evaluator;
+  CCGEvalGridsTLSData tls_data = {NULL};
   /* Threaded grids evaluation. */
+  BKE_subdiv_stats_begin(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_CCG_ELEMENTS);
   TaskParallelSettings parallel_range_settings;
   BLI_parallel_range_settings_defaults(&parallel_range_settings);
+  parallel_range_settings.userdata_chunk = &tls_data;
+  parallel_range_settings.userdata_chunk_size = sizeof(tls_data);
+  parallel_range_settings.func_free = subdiv_ccg_eval_grids_free;
   BLI_task_parallel_range(
       0, num_faces, &data, subdiv_ccg_eval_grids_task, &parallel_range_settings);
+  BKE_subdiv_stats_end(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_CCG_ELEMENTS);
   /* If displacement is used, need to calculate normals after all final
    * coordinates are known. */
   if (subdiv->displacement_evaluator != NULL) {
+    BKE_subdiv_stats_begin(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_CCG_NORMALS);
     BKE_subdiv_ccg_recalc_normals(subdiv_ccg);
+    BKE_subdiv_stats_end(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_CCG_NORMALS);
   }
   return true;
 }
@@ -579,7 +690,7 @@ SubdivCCG *BKE_subdiv_to_ccg(Subdiv *subdiv,
   subdiv_ccg->level = bitscan_forward_i(settings->resolution - 1);
   subdiv_ccg->grid_size = BKE_subdiv_grid_size_from_level(subdiv_ccg->level);
   subdiv_ccg_init_layers(subdiv_ccg, settings);
-  subdiv_ccg_alloc_elements(subdiv_ccg, subdiv);
+  subdiv_ccg_alloc_elements(subdiv_ccg, subdiv, settings);
   subdiv_ccg_init_faces(subdiv_ccg);
   subdiv_ccg_init_faces_neighborhood(subdiv_ccg);
   if (!subdiv_ccg_evaluate_grids(subdiv_ccg, subdiv, mask_evaluator, material_flags_evaluator)) {
@@ -625,7 +736,8 @@ void BKE_subdiv_ccg_destroy(SubdivCCG *subdiv_ccg)
 {
   const int num_grids = subdiv_ccg->num_grids;
   MEM_SAFE_FREE(subdiv_ccg->grids);
-  MEM_SAFE_FREE(subdiv_ccg->grids_storage);
+  subdiv_ccg_grids_storage_free(subdiv_ccg);
+  MEM_SAFE_FREE(subdiv_ccg->grid_use_stamps);
   MEM_SAFE_FREE(subdiv_ccg->edges);
   MEM_SAFE_FREE(subdiv_ccg->vertices);
   MEM_SAFE_FREE(subdiv_ccg->grid_flag_mats);
@@ -1807,3 +1919,141 @@ int BKE_subdiv_ccg_grid_to_face_index(const SubdivCCG *subdiv_ccg, const int gri
 }
 
 /** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Out-of-core grids
+ * \{ */
+
+bool BKE_subdiv_ccg_use_scratch_storage(const SubdivCCG *subdiv_ccg)
+{
+  return subdiv_ccg->scratch_fd != -1;
+}
+
+void BKE_subdiv_ccg_grids_mark_used(SubdivCCG *subdiv_ccg,
+                                    const int *grid_indices,
+                                    const int num_grid_indices)
+{
+  const int stamp = subdiv_ccg->grid_use_stamp;
+  for (int i = 0; i < num_grid_indices; i++) {
+    subdiv_ccg->grid_use_stamps[grid_indices[i]] = stamp;
+  }
+}
+
+#ifndef WIN32
+typedef struct GridUseStamp {
+  int grid_index;
+  int stamp;
+} GridUseStamp;
+
+static int grid_use_stamp_cmp(const void *a_v, const void *b_v)
+{
+  const GridUseStamp *a = a_v;
+  const GridUseStamp *b = b_v;
+  if (a->stamp != b->stamp) {
+    return (a->stamp < b->stamp) ? -1 : 1;
+  }
+  return (a->grid_index < b->grid_index) ? -1 : (a->grid_index > b->grid_index);
+}
+
+/* Number of resident pages in [first_page, first_page + num_pages). */
+static size_t subdiv_ccg_scratch_resident_pages(const SubdivCCG *subdiv_ccg,
+                                                unsigned char *residency,
+                                                const size_t page_size,
+                                                const size_t first_page,
+                                                const size_t num_pages)
+{
+  if (num_pages == 0) {
+    return 0;
+  }
+#ifdef __linux__
+  if (mincore(subdiv_ccg->grids_storage + first_page * page_size,
+              num_pages * page_size,
+              residency) != 0) {
+    /* Unknown, assume everything is resident. */
+    return num_pages;
+  }
+  size_t num_resident = 0;
+  for (size_t i = 0; i < num_pages; i++) {
+    num_resident += residency[i] & 1;
+  }
+  return num_resident;
+#else
+  /* The type of the residency vector differs between platforms, assume everything is
+   * resident. */
+  UNUSED_VARS(subdiv_ccg, residency, page_size, first_page);
+  return num_pages;
+#endif
+}
+#endif
+
+size_t BKE_subdiv_ccg_grids_page_out(SubdivCCG *subdiv_ccg, const size_t memory_limit)
+{
+  /* Grids marked as used from now on are newer than the ones used so far. */
+  const int stamp = subdiv_ccg->grid_use_stamp++;
+#ifndef WIN32
+  if (!BKE_subdiv_ccg_use_scratch_storage(subdiv_ccg)) {
+    return 0;
+  }
+
+  const size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+  const size_t total_pages = (subdiv_ccg->grids_storage_size + page_size - 1) / page_size;
+  unsigned char *residency = MEM_malloc_arrayN(total_pages, 1, "ccg grids residency");
+  size_t resident_size = subdiv_ccg_scratch_resident_pages(
+                             subdiv_ccg, residency, page_size, 0, total_pages) *
+                         page_size;
+  if (resident_size <= memory_limit) {
+    MEM_freeN(residency);
+    return 0;
+  }
+
+  /* Least recently used grids first, grids used by the last stroke are kept. */
+  const int num_grids = subdiv_ccg->num_grids;
+  GridUseStamp *grids = MEM_malloc_arrayN(num_grids, sizeof(*grids), "ccg grid use stamps");
+  for (int grid_index = 0; grid_index < num_grids; grid_index++) {
+    grids[grid_index].grid_index = grid_index;
+    grids[grid_index].stamp = subdiv_ccg->grid_use_stamps[grid_index];
+  }
+  qsort(grids, num_grids, sizeof(*grids), grid_use_stamp_cmp);
+
+  const size_t grid_size_in_bytes = subdiv_ccg->grids_storage_size / num_grids;
+  size_t paged_out_size = 0;
+  for (int i = 0; i < num_grids && resident_size > memory_limit; i++) {
+    if (grids[i].stamp == stamp) {
+      break;
+    }
+    /* Only pages fully covered by the grid, the ones shared with neighbor grids stay. */
+    const size_t grid_begin = grid_size_in_bytes * grids[i].grid_index;
+    const size_t first_page = (grid_begin + page_size - 1) / page_size;
+    const size_t end_page = (grid_begin + grid_size_in_bytes) / page_size;
+    if (end_page <= first_page) {
+      continue;
+    }
+    const size_t num_pages = end_page - first_page;
+    const size_t num_resident = subdiv_ccg_scratch_resident_pages(
+        subdiv_ccg, residency, page_size, first_page, num_pages);
+    if (num_resident == 0) {
+      continue;
+    }
+    unsigned char *begin = subdiv_ccg->grids_storage + first_page * page_size;
+    const size_t size = num_pages * page_size;
+    /* Write back modified pages, then drop them from the process and the page cache. */
+    msync(begin, size, MS_SYNC);
+    madvise(begin, size, MADV_DONTNEED);
+#ifdef __linux__
+    posix_fadvise(subdiv_ccg->scratch_fd, (off_t)(first_page * page_size), size,
+                  POSIX_FADV_DONTNEED);
+#endif
+    resident_size -= num_resident * page_size;
+    paged_out_size += num_resident * page_size;
+  }
+
+  MEM_freeN(grids);
+  MEM_freeN(residency);
+  return paged_out_size;
+#else
+  UNUSED_VARS(stamp, memory_limit);
+  return 0;
+#endif
+}
+
+/** \} */
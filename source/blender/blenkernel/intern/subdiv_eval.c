@@ -207,6 +207,38 @@ void BKE_subdiv_eval_limit_point_and_derivatives(Subdiv *subdiv,
   }
 }
 
+void BKE_subdiv_eval_limit_points_and_derivatives(Subdiv *subdiv,
+                                                  const OpenSubdiv_PatchCoord *patch_coords,
+                                                  const int num_patch_coords,
+                                                  float (*r_P)[3],
+                                                  float (*r_dPdu)[3],
+                                                  float (*r_dPdv)[3])
+{
+  subdiv->evaluator->evaluatePatchesLimit(subdiv->evaluator,
+                                          patch_coords,
+                                          num_patch_coords,
+                                          (float *)r_P,
+                                          (float *)r_dPdu,
+                                          (float *)r_dPdv);
+  if (r_dPdu == NULL || r_dPdv == NULL) {
+    return;
+  }
+  /* Same workaround for zero derivatives as in the single point query above. Those are rare, so
+   * re-evaluating them one by one does not affect performance. */
+  for (int i = 0; i < num_patch_coords; i++) {
+    if (is_zero_v3(r_dPdu[i]) || is_zero_v3(r_dPdv[i])) {
+      const OpenSubdiv_PatchCoord *patch_coord = &patch_coords[i];
+      BKE_subdiv_eval_limit_point_and_derivatives(subdiv,
+                                                  patch_coord->ptex_face,
+                                                  patch_coord->u,
+                                                  patch_coord->v,
+                                                  r_P[i],
+                                                  r_dPdu[i],
+                                                  r_dPdv[i]);
+    }
+  }
+}
+
 void BKE_subdiv_eval_limit_point_and_normal(Subdiv *subdiv,
                                             const int ptex_face_index,
                                             const float u,
@@ -753,6 +753,31 @@ void BM_log_entry_drop(BMLogEntry *entry)
   BLI_freelinkN(&log->entries, entry);
 }
 
+/* Approximate memory used by the entry
+ *
+ * Counts the logged vertices and faces and the hash entries that
+ * reference them, hash bucket overhead is approximated per entry.
+ */
+size_t BM_log_entry_size(const BMLogEntry *entry)
+{
+  GHash *ghashes[] = {entry->deleted_verts,
+                      entry->deleted_faces,
+                      entry->added_verts,
+                      entry->added_faces,
+                      entry->modified_verts,
+                      entry->modified_faces};
+  size_t size = sizeof(*entry);
+
+  size += sizeof(BMLogVert) * (size_t)BLI_mempool_len(entry->pool_verts);
+  size += sizeof(BMLogFace) * (size_t)BLI_mempool_len(entry->pool_faces);
+  for (uint i = 0; i < ARRAY_SIZE(ghashes); i++) {
+    /* Key, value, next pointer and one bucket. */
+    size += sizeof(void *) * 4 * BLI_ghash_len(ghashes[i]);
+  }
+
+  return size;
+}
+
 /* Undo one BMLogEntry
  *
  * Has no effect if there's nothing left to undo */
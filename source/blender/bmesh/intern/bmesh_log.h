@@ -53,6 +53,9 @@ void BM_log_cleanup_entry(BMLogEntry *entry);
 /* Remove an entry from the log */
 void BM_log_entry_drop(BMLogEntry *entry);
 
+/* Approximate memory used by the entry */
+size_t BM_log_entry_size(const BMLogEntry *entry);
+
 /* Undo one BMLogEntry */
 void BM_log_undo(BMesh *bm, BMLog *log);
 
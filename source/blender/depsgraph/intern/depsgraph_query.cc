@@ -47,6 +47,12 @@
 #include "intern/eval/deg_eval_copy_on_write.h"
 #include "intern/node/deg_node_id.h"
 
+struct Main *DEG_get_bmain(const Depsgraph *graph)
+{
+  const DEG::Depsgraph *deg_graph = reinterpret_cast<const DEG::Depsgraph *>(graph);
+  return deg_graph->bmain;
+}
+
 struct Scene *DEG_get_input_scene(const Depsgraph *graph)
 {
   const DEG::Depsgraph *deg_graph = reinterpret_cast<const DEG::Depsgraph *>(graph);
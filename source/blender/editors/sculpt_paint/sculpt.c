@@ -5333,6 +5333,15 @@ static void do_brush_action(Sculpt *sd, Object *ob, Brush *brush, UnifiedPaintSe
     }
   }
 
+  /* Keep the grids under the brush resident when out-of-core grids are paged out. */
+  if (ss->subdiv_ccg && BKE_subdiv_ccg_use_scratch_storage(ss->subdiv_ccg)) {
+    for (int n = 0; n < totnode; n++) {
+      int *grid_indices, totgrid;
+      BKE_pbvh_node_get_grids(ss->pbvh, nodes[n], &grid_indices, &totgrid, NULL, NULL, NULL);
+      BKE_subdiv_ccg_grids_mark_used(ss->subdiv_ccg, grid_indices, totgrid);
+    }
+  }
+
   /* Only act if some verts are inside the brush area. */
   if (totnode) {
     float location[3];
@@ -7220,6 +7229,14 @@ static void sculpt_stroke_done(const bContext *C, struct PaintStroke *UNUSED(str
       SCULPT_flush_update_done(C, ob, SCULPT_UPDATE_COORDS);
     }
 
+    /* Undo and update are done with the grids, page out the ones not used recently. */
+    if (ss->subdiv_ccg && ss->multires.modifier &&
+        ss->multires.modifier->scratch_memory_limit > 0) {
+      const size_t memory_limit = (size_t)ss->multires.modifier->scratch_memory_limit * 1024 *
+                                  1024;
+      BKE_subdiv_ccg_grids_page_out(ss->subdiv_ccg, memory_limit);
+    }
+
     WM_event_add_notifier(C, NC_OBJECT | ND_DRAW, ob);
   }
 
@@ -499,6 +499,15 @@ typedef struct SculptUndoNode {
   /* Sculpt Face Sets */
   int *face_sets;
 
+  /* Compact storage of `co` or `mask` once the undo step is pushed: only the values of vertices
+   * the step changed are kept, in vertex order, as deflated XOR deltas against the PBVH. */
+  BLI_bitmap *changed_verts;
+  void *changed_values;
+  int totchanged;
+  /* Size in bytes of `changed_values`, uncompressed when deflate did not make it smaller. */
+  int changed_values_size;
+  bool is_compact;
+
   size_t undo_size;
 } SculptUndoNode;
 
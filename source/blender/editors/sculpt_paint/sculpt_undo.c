@@ -24,6 +24,8 @@
 
 #include <stddef.h>
 
+#include "zlib.h" /* Compact storage of changed values. */
+
 #include "MEM_guardedalloc.h"
 
 #include "BLI_ghash.h"
@@ -597,6 +599,345 @@ static int sculpt_undo_bmesh_restore(bContext *C,
   return false;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Compact Storage
+ *
+ * Strokes usually change only part of the vertices of the PBVH nodes they touch. Once a step is
+ * pushed, coordinates and masks are compared against the current PBVH state and only the values
+ * of changed vertices are kept. Unchanged vertices hold the same value before and after the
+ * step, so restoring them is a no-op and they are filled in from the PBVH when expanding.
+ *
+ * Changed values are stored as the XOR of their bits with the PBVH value at compaction. Small
+ * displacements leave the sign, exponent and high mantissa bits equal, so after splitting the
+ * words into byte planes the high planes are mostly zeros and deflate well. The PBVH holds the
+ * same state again whenever the node is expanded, which the unchanged vertices rely on already.
+ * \{ */
+
+static bool sculpt_undo_node_can_compact(const SculptSession *ss, const SculptUndoNode *unode)
+{
+  if (ss == NULL || ss->bm || ss->pbvh == NULL) {
+    return false;
+  }
+
+  /* Deformed and shape key coordinates are not restored directly from the PBVH. */
+  if (unode->orig_co || unode->shapeName[0] != '\0') {
+    return false;
+  }
+
+  if (unode->type == SCULPT_UNDO_COORDS) {
+    if (!unode->co) {
+      return false;
+    }
+  }
+  else if (unode->type == SCULPT_UNDO_MASK) {
+    if (!unode->mask) {
+      return false;
+    }
+  }
+  else {
+    return false;
+  }
+
+  if (unode->maxvert) {
+    if (ss->totvert != unode->maxvert || ss->mvert == NULL) {
+      return false;
+    }
+    return (unode->type != SCULPT_UNDO_MASK) || ss->vmask;
+  }
+  if (unode->maxgrid && ss->subdiv_ccg) {
+    const SubdivCCG *subdiv_ccg = ss->subdiv_ccg;
+    if ((subdiv_ccg->num_grids != unode->maxgrid) || (subdiv_ccg->grid_size != unode->gridsize)) {
+      return false;
+    }
+    return (unode->type != SCULPT_UNDO_MASK) || subdiv_ccg->has_mask;
+  }
+  return false;
+}
+
+/* Current PBVH value of the undo node vertex, three floats for coordinates and one for masks. */
+static float *sculpt_undo_node_value_get(SculptSession *ss,
+                                         const CCGKey *key,
+                                         const SculptUndoNode *unode,
+                                         const int i)
+{
+  if (unode->maxvert) {
+    const int index = unode->index[i];
+    return (unode->type == SCULPT_UNDO_COORDS) ? ss->mvert[index].co : &ss->vmask[index];
+  }
+
+  const int grid_area = unode->gridsize * unode->gridsize;
+  CCGElem *grid = ss->subdiv_ccg->grids[unode->grids[i / grid_area]];
+  return (unode->type == SCULPT_UNDO_COORDS) ? CCG_elem_offset_co(key, grid, i % grid_area) :
+                                               CCG_elem_offset_mask(key, grid, i % grid_area);
+}
+
+/* Writes the changed values XOR'd with the current PBVH values, one byte plane after another. */
+static void sculpt_undo_node_delta_encode(SculptSession *ss,
+                                          const CCGKey *key,
+                                          const SculptUndoNode *unode,
+                                          const float *values,
+                                          const int stride,
+                                          const BLI_bitmap *changed_verts,
+                                          const int totwords,
+                                          uchar *r_planes)
+{
+  int word = 0;
+  for (int i = 0; i < unode->totvert; i++) {
+    if (!BLI_BITMAP_TEST(changed_verts, i)) {
+      continue;
+    }
+    const float *value = sculpt_undo_node_value_get(ss, key, unode, i);
+    for (int j = 0; j < stride; j++, word++) {
+      uint a, b;
+      memcpy(&a, &values[i * stride + j], sizeof(uint));
+      memcpy(&b, &value[j], sizeof(uint));
+      const uint delta = a ^ b;
+      for (int plane = 0; plane < 4; plane++) {
+        r_planes[plane * totwords + word] = (uchar)(delta >> (plane * 8));
+      }
+    }
+  }
+}
+
+static void sculpt_undo_node_compact(SculptSession *ss, SculptUndoNode *unode)
+{
+  if (unode->is_compact || !sculpt_undo_node_can_compact(ss, unode)) {
+    return;
+  }
+
+  CCGKey key;
+  if (unode->maxgrid) {
+    BKE_subdiv_ccg_key_top_level(&key, ss->subdiv_ccg);
+  }
+
+  const bool is_coords = unode->type == SCULPT_UNDO_COORDS;
+  const int stride = is_coords ? 3 : 1;
+  float *values = is_coords ? (float *)unode->co : unode->mask;
+
+  BLI_bitmap *changed_verts = BLI_BITMAP_NEW(unode->totvert, "SculptUndoNode.changed_verts");
+  int totchanged = 0;
+  for (int i = 0; i < unode->totvert; i++) {
+    /* No need for float comparison here (memory is exactly equal or not). */
+    const float *value = sculpt_undo_node_value_get(ss, &key, unode, i);
+    if (memcmp(value, &values[i * stride], sizeof(float) * stride) != 0) {
+      BLI_BITMAP_ENABLE(changed_verts, i);
+      totchanged++;
+    }
+  }
+
+  const int totwords = totchanged * stride;
+  const uLong planes_size = sizeof(uint) * (uLong)totwords;
+  uchar *planes = MEM_mallocN(sizeof(uint) * max_ii(totwords, 1), "SculptUndoNode.changed_values");
+  sculpt_undo_node_delta_encode(ss, &key, unode, values, stride, changed_verts, totwords, planes);
+
+  /* Keep the planes uncompressed when deflate does not make them smaller. */
+  uLongf compressed_size = compressBound(planes_size);
+  uchar *compressed = MEM_mallocN(compressed_size, "SculptUndoNode.changed_values");
+  if (planes_size > 0 &&
+      compress2(compressed, &compressed_size, planes, planes_size, Z_BEST_SPEED) == Z_OK &&
+      compressed_size < planes_size) {
+    MEM_freeN(planes);
+    unode->changed_values = MEM_reallocN(compressed, compressed_size);
+    unode->changed_values_size = (int)compressed_size;
+  }
+  else {
+    MEM_freeN(compressed);
+    unode->changed_values = planes;
+    unode->changed_values_size = (int)planes_size;
+  }
+
+  if (is_coords) {
+    MEM_SAFE_FREE(unode->co);
+  }
+  else {
+    MEM_SAFE_FREE(unode->mask);
+  }
+  unode->changed_verts = changed_verts;
+  unode->totchanged = totchanged;
+  unode->is_compact = true;
+}
+
+static void sculpt_undo_node_expand(SculptSession *ss, SculptUndoNode *unode)
+{
+  if (!unode->is_compact) {
+    return;
+  }
+
+  /* Topology changed since the step was pushed, the node is skipped on restore. */
+  if (!sculpt_undo_node_can_compact(ss, unode)) {
+    return;
+  }
+
+  CCGKey key;
+  if (unode->maxgrid) {
+    BKE_subdiv_ccg_key_top_level(&key, ss->subdiv_ccg);
+  }
+
+  const bool is_coords = unode->type == SCULPT_UNDO_COORDS;
+  const int stride = is_coords ? 3 : 1;
+  const int totwords = unode->totchanged * stride;
+  const uLong planes_size = sizeof(uint) * (uLong)totwords;
+
+  uchar *planes = unode->changed_values;
+  if ((uLong)unode->changed_values_size != planes_size) {
+    uLongf uncompressed_size = planes_size;
+    planes = MEM_mallocN(planes_size, __func__);
+    const int result = uncompress(
+        planes, &uncompressed_size, unode->changed_values, (uLong)unode->changed_values_size);
+    if (result != Z_OK || uncompressed_size != planes_size) {
+      BLI_assert(!"Corrupted sculpt undo node data");
+      MEM_freeN(planes);
+      return;
+    }
+  }
+
+  float *values = MEM_mallocN(sizeof(float) * stride * unode->totvert,
+                              is_coords ? "SculptUndoNode.co" : "SculptUndoNode.mask");
+
+  int word = 0;
+  for (int i = 0; i < unode->totvert; i++) {
+    const float *value = sculpt_undo_node_value_get(ss, &key, unode, i);
+    if (!BLI_BITMAP_TEST(unode->changed_verts, i)) {
+      memcpy(&values[i * stride], value, sizeof(float) * stride);
+      continue;
+    }
+    for (int j = 0; j < stride; j++, word++) {
+      uint delta = 0, b;
+      for (int plane = 0; plane < 4; plane++) {
+        delta |= (uint)planes[plane * totwords + word] << (plane * 8);
+      }
+      memcpy(&b, &value[j], sizeof(uint));
+      b ^= delta;
+      memcpy(&values[i * stride + j], &b, sizeof(float));
+    }
+  }
+
+  if (planes != unode->changed_values) {
+    MEM_freeN(planes);
+  }
+
+  if (is_coords) {
+    unode->co = (float(*)[3])values;
+  }
+  else {
+    unode->mask = values;
+  }
+  MEM_SAFE_FREE(unode->changed_verts);
+  MEM_SAFE_FREE(unode->changed_values);
+  unode->changed_values_size = 0;
+  unode->totchanged = 0;
+  unode->is_compact = false;
+}
+
+typedef struct SculptUndoCompactData {
+  SculptUndoNode **unodes;
+  SculptSession **sessions;
+} SculptUndoCompactData;
+
+static void sculpt_undo_compact_task_cb(void *__restrict userdata,
+                                        const int i,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  SculptUndoCompactData *data = userdata;
+  sculpt_undo_node_compact(data->sessions[i], data->unodes[i]);
+}
+
+/* Compact all nodes of a pushed step, nodes are independent so this runs in parallel. */
+static void sculpt_undo_compact_list(Main *bmain, ListBase *lb)
+{
+  const int totnode = BLI_listbase_count(lb);
+  if (totnode == 0) {
+    return;
+  }
+
+  SculptUndoCompactData data = {
+      .unodes = MEM_malloc_arrayN(totnode, sizeof(*data.unodes), __func__),
+      .sessions = MEM_malloc_arrayN(totnode, sizeof(*data.sessions), __func__),
+  };
+  int totcompact = 0;
+  Object *ob = NULL;
+  LISTBASE_FOREACH (SculptUndoNode *, unode, lb) {
+    if (ob == NULL || !STREQ(unode->idname, ob->id.name)) {
+      ob = BLI_findstring(&bmain->objects, unode->idname, offsetof(ID, name));
+    }
+    if (ob && sculpt_undo_node_can_compact(ob->sculpt, unode)) {
+      data.unodes[totcompact] = unode;
+      data.sessions[totcompact] = ob->sculpt;
+      totcompact++;
+    }
+  }
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = totcompact > 1;
+  BLI_task_parallel_range(0, totcompact, &data, sculpt_undo_compact_task_cb, &settings);
+
+  MEM_freeN(data.unodes);
+  MEM_freeN(data.sessions);
+}
+
+static size_t sculpt_undo_customdata_size(const CustomData *data, const int totelem)
+{
+  size_t size = 0;
+  for (int i = 0; i < data->totlayer; i++) {
+    size += (size_t)CustomData_sizeof(data->layers[i].type) * (size_t)totelem;
+  }
+  return size;
+}
+
+static size_t sculpt_undo_geometry_size(const SculptUndoNodeGeometry *geometry)
+{
+  if (!geometry->is_initialized) {
+    return 0;
+  }
+  return sculpt_undo_customdata_size(&geometry->vdata, geometry->totvert) +
+         sculpt_undo_customdata_size(&geometry->edata, geometry->totedge) +
+         sculpt_undo_customdata_size(&geometry->ldata, geometry->totloop) +
+         sculpt_undo_customdata_size(&geometry->pdata, geometry->totpoly);
+}
+
+static size_t sculpt_undo_list_size(const ListBase *lb)
+{
+  size_t size = 0;
+  LISTBASE_FOREACH (const SculptUndoNode *, unode, lb) {
+    const void *arrays[] = {unode->co,
+                            unode->orig_co,
+                            unode->no,
+                            unode->mask,
+                            unode->index,
+                            unode->grids,
+                            unode->vert_hidden,
+                            unode->grid_hidden,
+                            unode->face_sets,
+                            unode->changed_verts,
+                            unode->changed_values};
+    size += sizeof(*unode);
+    for (int i = 0; i < ARRAY_SIZE(arrays); i++) {
+      if (arrays[i]) {
+        size += MEM_allocN_len(arrays[i]);
+      }
+    }
+    if (unode->grid_hidden) {
+      for (int i = 0; i < unode->totgrid; i++) {
+        if (unode->grid_hidden[i]) {
+          size += MEM_allocN_len(unode->grid_hidden[i]);
+        }
+      }
+    }
+
+    size += sculpt_undo_geometry_size(&unode->geometry_original);
+    size += sculpt_undo_geometry_size(&unode->geometry_modified);
+    size += sculpt_undo_geometry_size(&unode->geometry_bmesh_enter);
+
+    if (unode->bm_entry) {
+      size += BM_log_entry_size(unode->bm_entry);
+    }
+  }
+  return size;
+}
+
+/** \} */
+
 static void sculpt_undo_restore_list(bContext *C, Depsgraph *depsgraph, ListBase *lb)
 {
   Scene *scene = CTX_data_scene(C);
@@ -694,9 +1035,14 @@ static void sculpt_undo_restore_list(bContext *C, Depsgraph *depsgraph, ListBase
 
     switch (unode->type) {
       case SCULPT_UNDO_COORDS:
+        sculpt_undo_node_expand(ss, unode);
+        if (unode->is_compact) {
+          break;
+        }
         if (sculpt_undo_restore_coords(C, depsgraph, unode)) {
           update = true;
         }
+        sculpt_undo_node_compact(ss, unode);
         break;
       case SCULPT_UNDO_HIDDEN:
         if (sculpt_undo_restore_hidden(C, unode)) {
@@ -705,10 +1051,15 @@ static void sculpt_undo_restore_list(bContext *C, Depsgraph *depsgraph, ListBase
         }
         break;
       case SCULPT_UNDO_MASK:
+        sculpt_undo_node_expand(ss, unode);
+        if (unode->is_compact) {
+          break;
+        }
         if (sculpt_undo_restore_mask(C, unode)) {
           update = true;
           update_mask = true;
         }
+        sculpt_undo_node_compact(ss, unode);
         break;
       case SCULPT_UNDO_FACE_SETS:
         break;
@@ -852,6 +1203,12 @@ static void sculpt_undo_free_list(ListBase *lb)
     if (unode->face_sets) {
       MEM_freeN(unode->face_sets);
     }
+    if (unode->changed_verts) {
+      MEM_freeN(unode->changed_verts);
+    }
+    if (unode->changed_values) {
+      MEM_freeN(unode->changed_values);
+    }
 
     MEM_freeN(unode);
 
@@ -1359,9 +1716,11 @@ static bool sculpt_undosys_step_encode(struct bContext *UNUSED(C),
                                        struct Main *bmain,
                                        UndoStep *us_p)
 {
-  /* Dummy, encoding is done along the way by adding tiles
-   * to the current 'SculptUndoStep' added by encode_init. */
+  /* Encoding is done along the way by adding tiles to the current 'SculptUndoStep' added by
+   * encode_init, only unchanged data is dropped here. */
   SculptUndoStep *us = (SculptUndoStep *)us_p;
+  sculpt_undo_compact_list(bmain, &us->data.nodes);
+  us->data.undo_size = sculpt_undo_list_size(&us->data.nodes);
   us->step.data_size = us->data.undo_size;
 
   SculptUndoNode *unode = us->data.nodes.last;
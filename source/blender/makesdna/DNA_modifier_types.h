@@ -996,7 +996,8 @@ typedef struct MultiresModifierData {
   char simple, flags, _pad[2];
   short quality;
   short uv_smooth;
-  char _pad2[4];
+  /** Resident memory limit of out-of-core grids in megabytes, 0 for no limit. */
+  int scratch_memory_limit;
 } MultiresModifierData;
 
 typedef enum {
@@ -1004,6 +1005,7 @@ typedef enum {
   /* DEPRECATED, only used for versioning. */
   eMultiresModifierFlag_PlainUv_DEPRECATED = (1 << 1),
   eMultiresModifierFlag_UseCrease = (1 << 2),
+  eMultiresModifierFlag_UseScratchStorage = (1 << 3),
 } MultiresModifierFlag;
 
 /* DEPRECATED, only used for versioning. */
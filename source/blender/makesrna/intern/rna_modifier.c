@@ -594,7 +594,9 @@ const EnumPropertyItem rna_enum_axis_flag_xyz_items[] = {
 #  include "BKE_mesh_runtime.h"
 #  include "BKE_modifier.h"
 #  include "BKE_object.h"
+#  include "BKE_paint.h"
 #  include "BKE_particle.h"
+#  include "BKE_subdiv_ccg.h"
 
 #  include "BLI_sort_utils.h"
 
@@ -1123,6 +1125,21 @@ static int rna_MultiresModifier_filepath_length(PointerRNA *ptr)
   return strlen((external) ? external->filename : "");
 }
 
+static void rna_MultiresModifier_scratch_memory_limit_update(Main *UNUSED(bmain),
+                                                             Scene *UNUSED(scene),
+                                                             PointerRNA *ptr)
+{
+  Object *ob = (Object *)ptr->owner_id;
+  MultiresModifierData *mmd = (MultiresModifierData *)ptr->data;
+  SculptSession *ss = ob->sculpt;
+
+  /* The limit is otherwise only applied at the end of a stroke. */
+  if (ss && ss->subdiv_ccg && ss->multires.modifier == mmd && mmd->scratch_memory_limit > 0) {
+    const size_t memory_limit = (size_t)mmd->scratch_memory_limit * 1024 * 1024;
+    BKE_subdiv_ccg_grids_page_out(ss->subdiv_ccg, memory_limit);
+  }
+}
+
 static int rna_ShrinkwrapModifier_face_cull_get(PointerRNA *ptr)
 {
   ShrinkwrapModifierData *swm = (ShrinkwrapModifierData *)ptr->data;
@@ -1963,6 +1980,25 @@ static void rna_def_modifier_multires(BlenderRNA *brna)
       prop, "Use Creases", "Use mesh edge crease information to sharpen edges");
   RNA_def_property_update(prop, 0, "rna_Modifier_update");
 
+  prop = RNA_def_property(srna, "use_scratch_storage", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flags", eMultiresModifierFlag_UseScratchStorage);
+  RNA_def_property_ui_text(
+      prop,
+      "Out-of-Core Grids",
+      "Store subdivided grids in a temporary file, so grids which are not sculpted on can be "
+      "paged out of memory");
+  RNA_def_property_update(prop, 0, "rna_Modifier_update");
+
+  prop = RNA_def_property(srna, "scratch_memory_limit", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, NULL, "scratch_memory_limit");
+  RNA_def_property_range(prop, 0, INT_MAX);
+  RNA_def_property_ui_range(prop, 0, 65536, 256, -1);
+  RNA_def_property_ui_text(prop,
+                           "Memory Limit",
+                           "Memory in megabytes out-of-core grids may use after a stroke, least "
+                           "recently sculpted grids are paged out first (0 for no limit)");
+  RNA_def_property_update(prop, 0, "rna_MultiresModifier_scratch_memory_limit_update");
+
   RNA_define_lib_overridable(false);
 }
 
@@ -167,6 +167,7 @@ static void multires_ccg_settings_init(SubdivToCCGSettings *settings,
   settings->resolution = (1 << level) + 1;
   settings->need_normal = true;
   settings->need_mask = has_mask;
+  settings->use_scratch_storage = (mmd->flags & eMultiresModifierFlag_UseScratchStorage) != 0;
 }
 
 static Mesh *multires_as_ccg(MultiresModifierData *mmd,
@@ -409,6 +410,11 @@ static void advanced_panel_draw(const bContext *C, Panel *panel)
   col = uiLayoutColumn(layout, false);
   uiLayoutSetEnabled(col, !has_displacement);
   uiItemR(col, &ptr, "use_creases", 0, NULL, ICON_NONE);
+
+  uiItemR(layout, &ptr, "use_scratch_storage", 0, NULL, ICON_NONE);
+  col = uiLayoutColumn(layout, false);
+  uiLayoutSetActive(col, RNA_boolean_get(&ptr, "use_scratch_storage"));
+  uiItemR(col, &ptr, "scratch_memory_limit", 0, NULL, ICON_NONE);
 }
 
 static void panelRegister(ARegionType *region_type)
@@ -66,6 +66,7 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
@@ -95,6 +96,8 @@ typedef struct BakeDataZSpan {
   ZSpan *zspan;
   float du_dx, du_dy;
   float dv_dx, dv_dy;
+  /* Image row of the first row of the zspan, when rasterizing a band of the image. */
+  int y_offset;
 } BakeDataZSpan;
 
 /**
@@ -120,7 +123,7 @@ static void store_bake_pixel(void *handle, int x, int y, float u, float v)
 
   const int width = bd->bk_image->width;
   const size_t offset = bd->bk_image->offset;
-  const int i = offset + y * width + x;
+  const int i = offset + (y + bd->y_offset) * width + x;
 
   pixel = &bd->pixel_array[i];
   pixel->primitive_id = bd->primitive_id;
@@ -517,6 +520,103 @@ static TriTessFace *mesh_calc_tri_tessface(Mesh *me, bool tangent, Mesh *me_eval
   return triangles;
 }
 
+typedef struct BakeHighPolyRayData {
+  BakePixel *pixel_array_from;
+  BakePixel *pixel_array_to;
+  BakeHighPolyData *highpoly;
+  int tot_highpoly;
+  BVHTreeFromMesh *treeData;
+  TriTessFace *tris_low;
+  TriTessFace *tris_cage;
+  TriTessFace **tris_high;
+  bool is_cage;
+  bool is_custom_cage;
+  float cage_extrusion;
+  float max_ray_distance;
+  float (*mat_low)[4];
+  float (*imat_low)[4];
+  float (*mat_cage)[4];
+} BakeHighPolyRayData;
+
+static void bake_highpoly_ray_cast_cb(void *__restrict userdata,
+                                      const int i,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BakeHighPolyRayData *data = userdata;
+  BakePixel *pixel_array_from = data->pixel_array_from;
+  BakePixel *pixel_array_to = data->pixel_array_to;
+  float co[3];
+  float dir[3];
+  TriTessFace *tri_low;
+
+  const int primitive_id = pixel_array_from[i].primitive_id;
+
+  if (primitive_id == -1) {
+    pixel_array_to[i].primitive_id = -1;
+    return;
+  }
+
+  const float u = pixel_array_from[i].uv[0];
+  const float v = pixel_array_from[i].uv[1];
+
+  /* calculate from low poly mesh cage */
+  if (data->is_custom_cage) {
+    calc_point_from_barycentric_cage(data->tris_low,
+                                     data->tris_cage,
+                                     data->mat_low,
+                                     data->mat_cage,
+                                     primitive_id,
+                                     u,
+                                     v,
+                                     co,
+                                     dir);
+    tri_low = &data->tris_cage[primitive_id];
+  }
+  else if (data->is_cage) {
+    calc_point_from_barycentric_extrusion(data->tris_cage,
+                                          data->mat_low,
+                                          data->imat_low,
+                                          primitive_id,
+                                          u,
+                                          v,
+                                          data->cage_extrusion,
+                                          co,
+                                          dir,
+                                          true);
+    tri_low = &data->tris_cage[primitive_id];
+  }
+  else {
+    calc_point_from_barycentric_extrusion(data->tris_low,
+                                          data->mat_low,
+                                          data->imat_low,
+                                          primitive_id,
+                                          u,
+                                          v,
+                                          data->cage_extrusion,
+                                          co,
+                                          dir,
+                                          false);
+    tri_low = &data->tris_low[primitive_id];
+  }
+
+  /* cast ray */
+  if (!cast_ray_highpoly(data->treeData,
+                         tri_low,
+                         data->tris_high,
+                         pixel_array_from,
+                         pixel_array_to,
+                         data->mat_low,
+                         data->highpoly,
+                         co,
+                         dir,
+                         i,
+                         data->tot_highpoly,
+                         data->max_ray_distance)) {
+    /* if it fails mask out the original pixel array */
+    pixel_array_from[i].primitive_id = -1;
+  }
+}
+
 bool RE_bake_pixels_populate_from_objects(struct Mesh *me_low,
                                           BakePixel pixel_array_from[],
                                           BakePixel pixel_array_to[],
@@ -531,12 +631,13 @@ bool RE_bake_pixels_populate_from_objects(struct Mesh *me_low,
                                           struct Mesh *me_cage)
 {
   size_t i;
-  int primitive_id;
-  float u, v;
   float imat_low[4][4];
   bool is_cage = me_cage != NULL;
   bool result = true;
 
+  BakeHighPolyRayData data;
+  TaskParallelSettings settings;
+
   Mesh *me_eval_low = NULL;
   Mesh **me_highpoly;
   BVHTreeFromMesh *treeData;
@@ -586,55 +687,26 @@ bool RE_bake_pixels_populate_from_objects(struct Mesh *me_low,
     }
   }
 
-  for (i = 0; i < num_pixels; i++) {
-    float co[3];
-    float dir[3];
-    TriTessFace *tri_low;
-
-    primitive_id = pixel_array_from[i].primitive_id;
-
-    if (primitive_id == -1) {
-      pixel_array_to[i].primitive_id = -1;
-      continue;
-    }
-
-    u = pixel_array_from[i].uv[0];
-    v = pixel_array_from[i].uv[1];
-
-    /* calculate from low poly mesh cage */
-    if (is_custom_cage) {
-      calc_point_from_barycentric_cage(
-          tris_low, tris_cage, mat_low, mat_cage, primitive_id, u, v, co, dir);
-      tri_low = &tris_cage[primitive_id];
-    }
-    else if (is_cage) {
-      calc_point_from_barycentric_extrusion(
-          tris_cage, mat_low, imat_low, primitive_id, u, v, cage_extrusion, co, dir, true);
-      tri_low = &tris_cage[primitive_id];
-    }
-    else {
-      calc_point_from_barycentric_extrusion(
-          tris_low, mat_low, imat_low, primitive_id, u, v, cage_extrusion, co, dir, false);
-      tri_low = &tris_low[primitive_id];
-    }
-
-    /* cast ray */
-    if (!cast_ray_highpoly(treeData,
-                           tri_low,
-                           tris_high,
-                           pixel_array_from,
-                           pixel_array_to,
-                           mat_low,
-                           highpoly,
-                           co,
-                           dir,
-                           i,
-                           tot_highpoly,
-                           max_ray_distance)) {
-      /* if it fails mask out the original pixel array */
-      pixel_array_from[i].primitive_id = -1;
-    }
-  }
+  /* Pixels are independent, cast their rays in parallel. */
+  data.pixel_array_from = pixel_array_from;
+  data.pixel_array_to = pixel_array_to;
+  data.highpoly = highpoly;
+  data.tot_highpoly = tot_highpoly;
+  data.treeData = treeData;
+  data.tris_low = tris_low;
+  data.tris_cage = tris_cage;
+  data.tris_high = tris_high;
+  data.is_cage = is_cage;
+  data.is_custom_cage = is_custom_cage;
+  data.cage_extrusion = cage_extrusion;
+  data.max_ray_distance = max_ray_distance;
+  data.mat_low = mat_low;
+  data.imat_low = imat_low;
+  data.mat_cage = mat_cage;
+
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, (int)num_pixels, &data, bake_highpoly_ray_cast_cb, &settings);
 
   /* garbage collection */
 cleanup:
@@ -688,19 +760,85 @@ static void bake_differentials(BakeDataZSpan *bd,
   }
 }
 
+/* Height in pixels of the image bands that are rasterized in parallel. Each band rasterizes
+ * its own rows of all triangles overlapping it, in their original order, so overlapping UVs
+ * give the same result as rasterizing the whole image at once. */
+#define BAKE_RASTER_BAND_HEIGHT 64
+
+typedef struct BakeRasterTriangle {
+  float vec[3][2];
+  int image_id;
+  int primitive_id;
+  int miny, maxy;
+} BakeRasterTriangle;
+
+typedef struct BakeRasterBand {
+  int image_id;
+  int miny, maxy;
+} BakeRasterBand;
+
+typedef struct BakeRasterData {
+  BakePixel *pixel_array;
+  const BakeImages *bake_images;
+  const BakeRasterTriangle *triangles;
+  int tottri;
+  const BakeRasterBand *bands;
+} BakeRasterData;
+
+static void bake_rasterize_band_cb(void *__restrict userdata,
+                                   const int iter,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BakeRasterData *data = userdata;
+  const BakeRasterBand *band = &data->bands[iter];
+  BakeDataZSpan bd;
+  ZSpan zspan;
+  int i;
+
+  bd.pixel_array = data->pixel_array;
+  bd.bk_image = &data->bake_images->data[band->image_id];
+  bd.zspan = &zspan;
+  bd.y_offset = band->miny;
+
+  /* Only scan the rows of the band, triangles are moved so the band starts at row zero. */
+  zbuf_alloc_span(&zspan, bd.bk_image->width, band->maxy - band->miny);
+
+  for (i = 0; i < data->tottri; i++) {
+    const BakeRasterTriangle *tri = &data->triangles[i];
+    float vec[3][2];
+
+    if (tri->image_id != band->image_id || tri->maxy < band->miny || tri->miny >= band->maxy) {
+      continue;
+    }
+
+    copy_v2_fl2(vec[0], tri->vec[0][0], tri->vec[0][1] - (float)band->miny);
+    copy_v2_fl2(vec[1], tri->vec[1][0], tri->vec[1][1] - (float)band->miny);
+    copy_v2_fl2(vec[2], tri->vec[2][0], tri->vec[2][1] - (float)band->miny);
+    bd.primitive_id = tri->primitive_id;
+
+    bake_differentials(&bd, vec[0], vec[1], vec[2]);
+    zspan_scanconvert(&zspan, (void *)&bd, vec[0], vec[1], vec[2], store_bake_pixel);
+  }
+
+  zbuf_free_span(&zspan);
+}
+
 void RE_bake_pixels_populate(Mesh *me,
                              BakePixel pixel_array[],
                              const size_t num_pixels,
                              const BakeImages *bake_images,
                              const char *uv_layer)
 {
-  BakeDataZSpan bd;
   size_t i;
-  int a, p_id;
+  int a, p_id, tottri_image, num_bands;
 
   const MLoopUV *mloopuv;
   const int tottri = poly_to_tri_count(me->totpoly, me->totloop);
   MLoopTri *looptri;
+  BakeRasterTriangle *triangles;
+  BakeRasterBand *bands;
+  BakeRasterData data;
+  TaskParallelSettings settings;
 
   if ((uv_layer == NULL) || (uv_layer[0] == '\0')) {
     mloopuv = CustomData_get_layer(&me->ldata, CD_MLOOPUV);
@@ -714,37 +852,36 @@ void RE_bake_pixels_populate(Mesh *me,
     return;
   }
 
-  bd.pixel_array = pixel_array;
-  bd.zspan = MEM_callocN(sizeof(ZSpan) * bake_images->size, "bake zspan");
-
   /* initialize all pixel arrays so we know which ones are 'blank' */
   for (i = 0; i < num_pixels; i++) {
     pixel_array[i].primitive_id = -1;
     pixel_array[i].object_id = 0;
   }
 
-  for (i = 0; i < bake_images->size; i++) {
-    zbuf_alloc_span(&bd.zspan[i], bake_images->data[i].width, bake_images->data[i].height);
-  }
-
   looptri = MEM_mallocN(sizeof(*looptri) * tottri, __func__);
+  triangles = MEM_mallocN(sizeof(*triangles) * max_ii(tottri, 1), __func__);
 
   BKE_mesh_recalc_looptri(me->mloop, me->mpoly, me->mvert, me->totloop, me->totpoly, looptri);
 
+  /* Project triangles to image space, primitive ids follow the triangle order. */
   p_id = -1;
+  tottri_image = 0;
   for (i = 0; i < tottri; i++) {
     const MLoopTri *lt = &looptri[i];
     const MPoly *mp = &me->mpoly[lt->poly];
-    float vec[3][2];
+    BakeRasterTriangle *tri = &triangles[tottri_image];
+    const BakeImage *bk_image;
     int mat_nr = mp->mat_nr;
     int image_id = bake_images->lookup[mat_nr];
+    float miny = FLT_MAX, maxy = -FLT_MAX;
 
     if (image_id < 0) {
       continue;
     }
 
-    bd.bk_image = &bake_images->data[image_id];
-    bd.primitive_id = ++p_id;
+    bk_image = &bake_images->data[image_id];
+    tri->image_id = image_id;
+    tri->primitive_id = ++p_id;
 
     for (a = 0; a < 3; a++) {
       const float *uv = mloopuv[lt->tri[a]].uv;
@@ -753,20 +890,55 @@ void RE_bake_pixels_populate(Mesh *me,
        * intersection tests where a pixel gets in between 2 faces or the middle of a quad,
        * camera aligned quads also have this problem but they are less common.
        * Add a small offset to the UVs, fixes bug #18685 - Campbell */
-      vec[a][0] = uv[0] * (float)bd.bk_image->width - (0.5f + 0.001f);
-      vec[a][1] = uv[1] * (float)bd.bk_image->height - (0.5f + 0.002f);
+      tri->vec[a][0] = uv[0] * (float)bk_image->width - (0.5f + 0.001f);
+      tri->vec[a][1] = uv[1] * (float)bk_image->height - (0.5f + 0.002f);
+
+      miny = min_ff(miny, tri->vec[a][1]);
+      maxy = max_ff(maxy, tri->vec[a][1]);
     }
 
-    bake_differentials(&bd, vec[0], vec[1], vec[2]);
-    zspan_scanconvert(&bd.zspan[image_id], (void *)&bd, vec[0], vec[1], vec[2], store_bake_pixel);
+    /* Conservative range of rows, clamped to the image so it fits an int. */
+    tri->miny = (int)floorf(clamp_f(miny, -1.0f, (float)bk_image->height)) - 1;
+    tri->maxy = (int)ceilf(clamp_f(maxy, -1.0f, (float)bk_image->height)) + 1;
+
+    tottri_image++;
   }
 
+  MEM_freeN(looptri);
+
+  /* Split images into bands of rows. */
+  num_bands = 0;
   for (i = 0; i < bake_images->size; i++) {
-    zbuf_free_span(&bd.zspan[i]);
+    num_bands += divide_ceil_u(bake_images->data[i].height, BAKE_RASTER_BAND_HEIGHT);
   }
 
-  MEM_freeN(looptri);
-  MEM_freeN(bd.zspan);
+  bands = MEM_mallocN(sizeof(*bands) * max_ii(num_bands, 1), __func__);
+
+  num_bands = 0;
+  for (i = 0; i < bake_images->size; i++) {
+    const int height = bake_images->data[i].height;
+    int y;
+
+    for (y = 0; y < height; y += BAKE_RASTER_BAND_HEIGHT) {
+      bands[num_bands].image_id = i;
+      bands[num_bands].miny = y;
+      bands[num_bands].maxy = min_ii(y + BAKE_RASTER_BAND_HEIGHT, height);
+      num_bands++;
+    }
+  }
+
+  data.pixel_array = pixel_array;
+  data.bake_images = bake_images;
+  data.triangles = triangles;
+  data.tottri = tottri_image;
+  data.bands = bands;
+
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (num_bands > 1);
+  BLI_task_parallel_range(0, num_bands, &data, bake_rasterize_band_cb, &settings);
+
+  MEM_freeN(bands);
+  MEM_freeN(triangles);
 }
 
 /* ******************** NORMALS ************************ */
@@ -47,6 +47,7 @@
 #include "BKE_scene.h"
 
 #include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
 #include "DEG_depsgraph_debug.h"
 #include "DEG_depsgraph_query.h"
 
@@ -150,6 +151,11 @@ void RE_engine_free(RenderEngine *engine)
 
   BLI_mutex_end(&engine->update_render_passes_mutex);
 
+  /* Depsgraph kept alive for persistent data. */
+  if (engine->depsgraph) {
+    DEG_graph_free(engine->depsgraph);
+  }
+
   MEM_freeN(engine);
 }
 
@@ -591,13 +597,45 @@ RenderData *RE_engine_get_render_data(Render *re)
 }
 
 /* Depsgraph */
+static void engine_depsgraph_free(RenderEngine *engine)
+{
+  DEG_graph_free(engine->depsgraph);
+
+  engine->depsgraph = NULL;
+}
+
+/* With persistent data the depsgraph is kept between frames and view layers, so evaluated
+ * datablocks which did not change keep their pointers and engines can reuse their data. */
+static bool engine_keep_depsgraph(RenderEngine *engine)
+{
+  const Render *re = engine->re;
+  return (re->r.mode & R_PERSISTENT_DATA) && !(re->r.scemode & R_BUTS_PREVIEW);
+}
+
 static void engine_depsgraph_init(RenderEngine *engine, ViewLayer *view_layer)
 {
   Main *bmain = engine->re->main;
   Scene *scene = engine->re->scene;
 
-  engine->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
-  DEG_debug_name_set(engine->depsgraph, "RENDER");
+  /* Reuse depsgraph from persistent data if possible. */
+  if (engine->depsgraph) {
+    if (!engine_keep_depsgraph(engine) || DEG_get_bmain(engine->depsgraph) != bmain ||
+        DEG_get_input_scene(engine->depsgraph) != scene) {
+      /* If bmain or scene changed, a completely new graph is needed. */
+      engine_depsgraph_free(engine);
+    }
+    else if (DEG_get_input_view_layer(engine->depsgraph) != view_layer) {
+      /* Only the view layer changed, keep the graph so that datablocks shared between view
+       * layers are not evaluated again. */
+      DEG_graph_replace_owners(engine->depsgraph, bmain, scene, view_layer);
+      DEG_graph_tag_relations_update(engine->depsgraph);
+    }
+  }
+
+  if (engine->depsgraph == NULL) {
+    engine->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
+    DEG_debug_name_set(engine->depsgraph, "RENDER");
+  }
 
   if (engine->re->r.scemode & R_BUTS_PREVIEW) {
     Depsgraph *depsgraph = engine->depsgraph;
@@ -607,15 +645,26 @@ static void engine_depsgraph_init(RenderEngine *engine, ViewLayer *view_layer)
     DEG_ids_clear_recalc(bmain, depsgraph);
   }
   else {
-    BKE_scene_graph_update_for_newframe(engine->depsgraph, bmain);
+    /* Keep recalc flags of a persistent depsgraph, the engine uses them to find what changed
+     * since the previous frame. They are cleared in engine_depsgraph_exit(). */
+    BKE_scene_graph_update_for_newframe_ex(
+        engine->depsgraph, bmain, !engine_keep_depsgraph(engine));
   }
 }
 
-static void engine_depsgraph_free(RenderEngine *engine)
+static void engine_depsgraph_exit(RenderEngine *engine)
 {
-  DEG_graph_free(engine->depsgraph);
+  if (engine->depsgraph == NULL) {
+    return;
+  }
 
-  engine->depsgraph = NULL;
+  if (engine_keep_depsgraph(engine)) {
+    /* The engine has handled the updates of this frame by now. */
+    DEG_ids_clear_recalc(engine->re->main, engine->depsgraph);
+  }
+  else {
+    engine_depsgraph_free(engine);
+  }
 }
 
 void RE_engine_frame_set(RenderEngine *engine, int frame, float subframe)
@@ -699,6 +748,10 @@ bool RE_bake_engine(Render *re,
   BLI_rw_mutex_unlock(&re->partsmutex);
 
   if (type->bake) {
+    /* Baking uses the depsgraph of the caller, not one kept by a previous render. */
+    if (engine->depsgraph) {
+      engine_depsgraph_free(engine);
+    }
     engine->depsgraph = depsgraph;
 
     /* update is only called so we create the engine.session */
@@ -881,7 +934,7 @@ int RE_engine_render(Render *re, int do_all)
         DRW_render_gpencil(engine, engine->depsgraph);
       }
 
-      engine_depsgraph_free(engine);
+      engine_depsgraph_exit(engine);
 
       if (RE_engine_test_break(engine)) {
         break;
@@ -976,6 +1029,9 @@ void RE_engine_free_blender_memory(RenderEngine *engine)
   if (DRW_render_check_grease_pencil(engine->depsgraph)) {
     return;
   }
-  DEG_graph_free(engine->depsgraph);
-  engine->depsgraph = NULL;
+  /* Persistent data keeps the depsgraph for the next frame. */
+  if (engine_keep_depsgraph(engine)) {
+    return;
+  }
+  engine_depsgraph_free(engine);
 }